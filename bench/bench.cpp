@@ -0,0 +1,576 @@
+#include <Physics/PhysicsWorld.hpp>
+#include <Physics/WorldRunner.hpp>
+#include <Physics/Streaming.hpp>
+#include <Physics/Heightfield.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <random>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <benchmark/benchmark.h>
+
+// Counts every allocation made with new, on any thread
+static std::atomic<std::size_t> allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if(auto pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+    enum class SceneType {
+        // Spheres in a grid, falling onto a plane
+        FallingSpheres,
+        // Columns of overlapping cubes standing on a plane
+        CubeStacks,
+        // Spheres spread thinly through a large volume, without gravity or a plane
+        SparseUniform,
+        // Randomly placed cubes and spheres above a plane
+        Mixed,
+        // Cubes falling onto a level made of 40 times as many static boxes
+        StaticLevel,
+        // The same as Mixed, but the bodies are debris that doesn't collide with other debris
+        Debris,
+        // The same as StaticLevel, but the ground is one heightfield with a sample for each box
+        Terrain
+    };
+
+    class Scene {
+        std::vector<std::unique_ptr<Physics::Collider>> colliders;
+
+        template<typename T, typename... Args>
+        void Add(Args&&... args) {
+            colliders.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        }
+
+        void CreateFallingSpheres(int bodyCount) {
+            auto side = static_cast<int>(std::ceil(std::sqrt(bodyCount / 4.0)));
+
+            Add<Physics::SimplePlaneCollider>(0.0f);
+
+            // Layers of side * side spheres, with a gap between each sphere
+            for(int i = 0; i < bodyCount; i++) {
+                auto x = i % side;
+                auto z = (i / side) % side;
+                auto y = i / (side * side);
+
+                Add<Physics::SphereCollider>(glm::vec3{x * 1.5f, 2 + y * 1.5f, z * 1.5f}, 1.0f, glm::vec3{});
+            }
+        }
+
+        void CreateCubeStacks(int bodyCount) {
+            constexpr int stackHeight = 10;
+
+            auto stackCount = (bodyCount + stackHeight - 1) / stackHeight;
+            auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(stackCount))));
+
+            Add<Physics::SimplePlaneCollider>(0.0f);
+
+            // Neighbouring cubes overlap slightly, so every cube touches the ones around it
+            for(int i = 0; i < bodyCount; i++) {
+                auto stack = i / stackHeight;
+                auto x = stack % side;
+                auto z = stack / side;
+                auto y = i % stackHeight;
+
+                Add<Physics::SimpleCubeCollider>(glm::vec3{x * 0.95f, 0.45f + y * 0.95f, z * 0.95f}, 1.0f, glm::vec3{});
+            }
+        }
+
+        void CreateSparseUniform(int bodyCount, std::mt19937& rng) {
+            // About 1000 times the volume of the spheres
+            auto halfSize = std::cbrt(static_cast<float>(bodyCount)) * 5;
+
+            std::uniform_real_distribution<float> positionDist{-halfSize, halfSize};
+            std::uniform_real_distribution<float> velocityDist{-1, 1};
+
+            for(int i = 0; i < bodyCount; i++) {
+                glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+                glm::vec3 velocity{velocityDist(rng), velocityDist(rng), velocityDist(rng)};
+
+                Add<Physics::SphereCollider>(position, 1.0f, velocity);
+                colliders.back()->hasGravity = false;
+            }
+        }
+
+        void CreateMixed(int bodyCount, std::mt19937& rng) {
+            // Keeps the density the same as the body count changes
+            auto halfSize = std::cbrt(static_cast<float>(bodyCount)) * 2;
+
+            std::uniform_real_distribution<float> positionDist{-halfSize, halfSize};
+            std::uniform_real_distribution<float> sizeDist{0.5f, 1.5f};
+
+            Add<Physics::SimplePlaneCollider>(-halfSize);
+
+            for(int i = 0; i < bodyCount; i++) {
+                glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+                if(i % 2 == 0) {
+                    Add<Physics::SimpleCubeCollider>(position, sizeDist(rng), glm::vec3{});
+                } else {
+                    Add<Physics::SphereCollider>(position, sizeDist(rng), glm::vec3{});
+                }
+            }
+        }
+
+        void CreateStaticLevel(int bodyCount, std::mt19937& rng) {
+            auto staticCount = bodyCount * 40 / 41;
+            auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(staticCount))));
+
+            std::uniform_real_distribution<float> heightDist{0, 0.5f};
+
+            // Uneven ground, where neighbouring boxes overlap
+            for(int i = 0; i < staticCount; i++) {
+                auto x = i % side;
+                auto z = i / side;
+
+                Add<Physics::SimpleCubeCollider>(glm::vec3{x * 0.95f, heightDist(rng), z * 0.95f}, 1.0f, glm::vec3{});
+                colliders.back()->isStatic = true;
+            }
+
+            std::uniform_real_distribution<float> positionDist{0, side * 0.95f};
+
+            for(int i = staticCount; i < bodyCount; i++) {
+                Add<Physics::SimpleCubeCollider>(glm::vec3{positionDist(rng), 2 + heightDist(rng) * 20, positionDist(rng)}, 0.5f, glm::vec3{});
+            }
+        }
+
+        void CreateTerrain(int bodyCount, std::mt19937& rng) {
+            auto staticCount = bodyCount * 40 / 41;
+            auto side = std::max(2, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(staticCount)))));
+
+            std::uniform_real_distribution<float> heightDist{0, 0.5f};
+
+            // The tops of StaticLevel's boxes, drawn in the same order so the falling cubes are in the same places
+            std::vector<float> heights(static_cast<std::size_t>(side) * side, 0.5f);
+
+            for(int i = 0; i < staticCount; i++) {
+                heights[i] = heightDist(rng) + 0.5f;
+            }
+
+            auto heightfield = std::make_shared<Physics::Heightfield>(side, side, 0.95f, heights);
+            Add<Physics::HeightfieldCollider>(glm::vec3{}, heightfield);
+
+            std::uniform_real_distribution<float> positionDist{0, side * 0.95f};
+
+            for(int i = staticCount; i < bodyCount; i++) {
+                Add<Physics::SimpleCubeCollider>(glm::vec3{positionDist(rng), 2 + heightDist(rng) * 20, positionDist(rng)}, 0.5f, glm::vec3{});
+            }
+        }
+    public:
+        Physics::PhysicsWorld world;
+
+        Scene(SceneType type, int bodyCount) {
+            std::mt19937 rng{1234};
+
+            switch(type) {
+            case SceneType::FallingSpheres:
+                CreateFallingSpheres(bodyCount);
+                break;
+            case SceneType::CubeStacks:
+                CreateCubeStacks(bodyCount);
+                break;
+            case SceneType::SparseUniform:
+                CreateSparseUniform(bodyCount, rng);
+                break;
+            case SceneType::Mixed:
+                CreateMixed(bodyCount, rng);
+                break;
+            case SceneType::StaticLevel:
+                CreateStaticLevel(bodyCount, rng);
+                break;
+            case SceneType::Terrain:
+                CreateTerrain(bodyCount, rng);
+                break;
+            case SceneType::Debris:
+                CreateMixed(bodyCount, rng);
+
+                // Skips the plane
+                for(auto& collider : colliders | std::views::drop(1)) {
+                    collider->category = 2;
+                    collider->mask = ~2u;
+                }
+
+                break;
+            }
+
+            for(auto& collider : colliders) {
+                world.AddPhysicsObject(collider.get());
+            }
+
+            // The first tick sorts the broadphase from scratch
+            world.Tick();
+        }
+    };
+
+    // Runs ticks until the benchmark stops, and reports what was done per tick
+    void RunTicks(benchmark::State& state, Scene& scene) {
+        std::size_t pairCount = 0;
+        std::size_t filteredPairCount = 0;
+        std::size_t contactCount = 0;
+
+        auto firstAllocation = allocationCount.load(std::memory_order_relaxed);
+
+        for(auto _ : state) {
+            scene.world.Tick();
+
+            // Always 0 if PHYSICS_PROFILING is disabled, so those counters aren't reported then
+            pairCount += static_cast<std::size_t>(scene.world.GetStats()[Physics::ProfileCounter::CandidatePairs].last);
+            filteredPairCount += static_cast<std::size_t>(scene.world.GetStats()[Physics::ProfileCounter::FilteredPairs].last);
+            contactCount += scene.world.GetContacts().size();
+        }
+
+        auto allocations = allocationCount.load(std::memory_order_relaxed) - firstAllocation;
+
+        if constexpr(Physics::profilingEnabled) {
+            state.counters["pairs_per_second"] = benchmark::Counter(static_cast<double>(pairCount), benchmark::Counter::kIsRate);
+            state.counters["filtered_pairs_per_tick"] = benchmark::Counter(static_cast<double>(filteredPairCount), benchmark::Counter::kAvgIterations);
+        }
+
+        state.counters["contacts_per_tick"] = benchmark::Counter(static_cast<double>(contactCount), benchmark::Counter::kAvgIterations);
+        state.counters["allocations_per_tick"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    }
+}
+
+// The argument is the number of bodies, and the reported time is the time per tick
+template<SceneType type>
+static void BM_Tick(benchmark::State& state) {
+    Scene scene{type, static_cast<int>(state.range(0))};
+
+    RunTicks(state, scene);
+}
+
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::FallingSpheres)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::CubeStacks)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::SparseUniform)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::Mixed)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::Debris)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::StaticLevel)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Arg(20500)->Unit(benchmark::kNanosecond);
+BENCHMARK_TEMPLATE(BM_Tick, SceneType::Terrain)->ArgName("bodies")->RangeMultiplier(10)->Range(10, 100000)->Arg(20500)->Unit(benchmark::kNanosecond);
+
+// Arguments are the number of bodies and the number of threads
+static void BM_TickThreads(benchmark::State& state) {
+    Scene scene{SceneType::Mixed, static_cast<int>(state.range(0))};
+    scene.world.SetThreadCount(state.range(1));
+
+    RunTicks(state, scene);
+
+    state.counters["threads"] = static_cast<double>(scene.world.GetThreadCount());
+}
+
+BENCHMARK(BM_TickThreads)
+    ->ArgNames({"bodies", "threads"})
+    ->ArgsProduct({{10000, 100000}, {1, 2, 4, 8, 16}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Arguments are the number of bodies, and whether distant bodies use higher tick levels
+// The camera is at the origin, and each ring of 20m further away steps half as often, up to every 8th tick
+static void BM_MultiRate(benchmark::State& state) {
+    Scene scene{SceneType::SparseUniform, static_cast<int>(state.range(0))};
+
+    if(state.range(1)) {
+        scene.world.SetTickLevelFunction([](Physics::BodyHandle, glm::vec3 position) {
+            return static_cast<std::uint8_t>(std::min(glm::length(position) / 20, 3.0f));
+        });
+    }
+
+    std::size_t steppedCount = 0;
+
+    for(auto _ : state) {
+        scene.world.Tick();
+
+        steppedCount += scene.world.GetSteppedBodyCount();
+    }
+
+    state.counters["stepped_bodies_per_tick"] = benchmark::Counter(static_cast<double>(steppedCount), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_MultiRate)
+    ->ArgNames({"bodies", "levels"})
+    ->ArgsProduct({{10000, 100000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// The argument is the number of bodies in the whole world, which is a grid of static boxes with a sphere on every 10th one
+// The focus moves 1m per tick, and only the cells near it are in the world, so the time per tick should stay flat as the world grows
+static void BM_StreamingTick(benchmark::State& state) {
+    auto bodyCount = static_cast<int>(state.range(0));
+    auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(bodyCount))));
+    auto worldSize = side * 4.0f;
+
+    Physics::PhysicsWorld world;
+    world.CreatePlane(0);
+
+    Physics::CellStreamer streamer{world};
+
+    for(int i = 0; i < bodyCount; i++) {
+        glm::vec3 position{(i % side) * 4.0f, 0.5f, (i / side) * 4.0f};
+
+        if(i % 10 == 0) {
+            streamer.Add(Physics::SphereCollider{position + glm::vec3{0, 1.5f, 0}, 1.0f, {}});
+        } else {
+            Physics::SimpleCubeCollider box{position, 1.0f, {}};
+            box.isStatic = true;
+
+            streamer.Add(box);
+        }
+    }
+
+    glm::vec3 focus{worldSize / 2, 0, worldSize / 2};
+
+    // Loads the cells around the starting point before timing
+    for(int i = 0; i < 10; i++) {
+        streamer.Update({&focus, 1});
+        streamer.Flush();
+    }
+
+    std::size_t residentCount = 0;
+
+    for(auto _ : state) {
+        focus.x = std::fmod(focus.x + 1, worldSize);
+
+        streamer.Update({&focus, 1});
+        world.Tick();
+
+        residentCount += world.GetBodyCount();
+    }
+
+    state.counters["resident_bodies_per_tick"] = benchmark::Counter(static_cast<double>(residentCount), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_StreamingTick)->ArgName("bodies")->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+// The argument is the number of bodies, and the reported time is the time to run a batch of rays
+static void BM_RaycastBatch(benchmark::State& state) {
+    constexpr std::size_t rayCount = 4096;
+
+    Scene scene{SceneType::Mixed, static_cast<int>(state.range(0))};
+
+    std::mt19937 rng{5678};
+    std::uniform_real_distribution<float> dist{-1, 1};
+
+    auto halfSize = std::cbrt(static_cast<float>(state.range(0))) * 2;
+
+    std::vector<Physics::Ray> rays;
+
+    for(std::size_t i = 0; i < rayCount; i++) {
+        glm::vec3 origin{dist(rng) * halfSize, dist(rng) * halfSize, dist(rng) * halfSize};
+        glm::vec3 direction{dist(rng), dist(rng), dist(rng)};
+
+        rays.push_back({origin, glm::normalize(direction)});
+    }
+
+    std::vector<Physics::QueryHit> hits(rays.size());
+
+    // Builds the query tree outside of the timed loop
+    scene.world.Raycast(rays, hits);
+
+    for(auto _ : state) {
+        scene.world.Raycast(rays, hits);
+        benchmark::DoNotOptimize(hits.data());
+    }
+
+    state.counters["rays_per_second"] = benchmark::Counter(static_cast<double>(rayCount), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_RaycastBatch)->ArgName("bodies")->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// The argument is the number of bodies, and the reported time is the time to save one frame
+static void BM_RollbackSave(benchmark::State& state) {
+    std::vector<Physics::SphereCollider> spheres;
+
+    for(int i = 0; i < state.range(0); i++) {
+        spheres.emplace_back(glm::vec3{static_cast<float>(i), 0, 0}, 1.0f, glm::vec3{});
+    }
+
+    Physics::BodyStore bodies;
+
+    for(auto& sphere : spheres) {
+        bodies.Add(&sphere);
+    }
+
+    Physics::RollbackBuffer rollback;
+    rollback.SetCapacity(10);
+
+    std::uint64_t tick = 0;
+
+    for(auto _ : state) {
+        rollback.Save(bodies, {}, tick, 0, 0);
+        tick++;
+    }
+
+    // Summed from the saved arrays, so it follows RollbackFrame as arrays are added to it
+    auto frame = rollback.Find(tick - 1);
+
+    auto bytes = [](const auto&... arrays) {
+        return (std::size_t{0} + ... + (arrays.size() * sizeof(arrays[0])));
+    };
+
+    state.counters["bytes_per_frame"] = static_cast<double>(bytes(frame->positions, frame->previousPositions, frame->velocities, frame->awakeFlags, frame->sleepTimes, frame->tickLevels, frame->pendingTicks));
+}
+
+BENCHMARK(BM_RollbackSave)->ArgName("bodies")->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// The argument is the number of bodies, and the reported time is the time to rewind 8 ticks and run them again
+static void BM_RewindResimulate(benchmark::State& state) {
+    constexpr int rewoundTicks = 8;
+
+    Scene scene{SceneType::Mixed, static_cast<int>(state.range(0))};
+    scene.world.SetRollbackLength(10);
+
+    for(int i = 0; i < 10; i++) {
+        scene.world.Tick();
+    }
+
+    for(auto _ : state) {
+        scene.world.Rewind(scene.world.GetTick() - rewoundTicks);
+
+        for(int i = 0; i < rewoundTicks; i++) {
+            scene.world.Tick();
+        }
+    }
+}
+
+BENCHMARK(BM_RewindResimulate)->ArgName("bodies")->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// Arguments are the number of worlds and the number of threads
+// Each world is a small pile of spheres falling onto a plane, and the reported time is the time to step every world 10 ticks
+static void BM_StepAll(benchmark::State& state) {
+    constexpr int bodiesPerWorld = 20;
+    constexpr std::size_t ticksPerStep = 10;
+
+    Physics::WorldRunner runner{static_cast<std::size_t>(state.range(1))};
+
+    for(std::int64_t i = 0; i < state.range(0); i++) {
+        auto& world = runner.CreateWorld(bodiesPerWorld + 1);
+        world.CreatePlane(0);
+
+        for(int j = 0; j < bodiesPerWorld; j++) {
+            world.CreateSphere({j % 4 * 1.5f, 1 + j / 4 * 1.5f, static_cast<float>(i % 3)}, 1);
+        }
+    }
+
+    // Grows every world's buffers to the size they need, which takes longer than the first tick as the piles form
+    runner.StepAll(100);
+
+    auto allocations = allocationCount.load();
+
+    for(auto _ : state) {
+        runner.StepAll(ticksPerStep);
+    }
+
+    auto worldTicks = static_cast<double>(state.iterations()) * static_cast<double>(state.range(0)) * ticksPerStep;
+
+    state.counters["world_ticks_per_second"] = benchmark::Counter(worldTicks, benchmark::Counter::kIsRate);
+    state.counters["allocations_per_world_tick"] = static_cast<double>(allocationCount.load() - allocations) / worldTicks;
+    state.counters["threads"] = static_cast<double>(runner.GetThreadCount());
+}
+
+BENCHMARK(BM_StepAll)
+    ->ArgNames({"worlds", "threads"})
+    ->ArgsProduct({{100, 1000}, {1, 2, 4, 8, 16}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Arguments are the solver iterations, whether warm starting is enabled, and the tick rate
+// The reported time is the time to simulate a few seconds of separate stacks of cubes, which get cheaper once they fall asleep
+// top_sink is how far the top of each stack sank, and top_speed is how fast it was still moving at the end
+static void BM_StackStability(benchmark::State& state) {
+    constexpr int stackCount = 100;
+    constexpr int stackHeight = 10;
+    constexpr float simulatedTime = 4;
+
+    auto tickRate = static_cast<float>(state.range(2));
+    auto tickCount = static_cast<int>(simulatedTime * tickRate);
+
+    Physics::SolverSettings settings;
+    settings.iterations = static_cast<std::size_t>(state.range(0));
+    settings.warmStarting = state.range(1) != 0;
+
+    double sink = 0;
+    double speed = 0;
+
+    for(auto _ : state) {
+        state.PauseTiming();
+
+        Physics::PhysicsWorld world;
+        world.SetTickRate(tickRate);
+        world.SetSolverSettings(settings);
+        world.CreatePlane(0);
+
+        std::vector<Physics::BodyHandle> tops;
+
+        for(int stack = 0; stack < stackCount; stack++) {
+            for(int y = 0; y < stackHeight; y++) {
+                Physics::SimpleCubeCollider cube{glm::vec3{stack % 10 * 2.0f, 0.5f + y, stack / 10 * 2.0f}, 1.0f, glm::vec3{}};
+                cube.restitution = 0;
+
+                auto body = world.Create(cube);
+
+                if(y == stackHeight - 1) {
+                    tops.push_back(body);
+                }
+            }
+        }
+
+        state.ResumeTiming();
+
+        for(int i = 0; i < tickCount; i++) {
+            world.Tick();
+        }
+
+        state.PauseTiming();
+
+        for(auto top : tops) {
+            sink += (stackHeight - 0.5f) - world.GetPosition(top).y;
+            speed += glm::length(world.GetVelocity(top));
+        }
+
+        state.ResumeTiming();
+    }
+
+    state.counters["top_sink"] = benchmark::Counter(sink / stackCount, benchmark::Counter::kAvgIterations);
+    state.counters["top_speed"] = benchmark::Counter(speed / stackCount, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_StackStability)
+    ->ArgNames({"iterations", "warm", "rate"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 1}, {30, 60}})
+    ->Unit(benchmark::kMillisecond);
+
+// Pass --benchmark_out=<file> to also write the results as JSON, to compare them between versions
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::warn);
+
+    benchmark::Initialize(&argc, argv);
+
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "PhysicsWorld.hpp"
+#include "BoundedQueue.hpp"
+#include "TripleBuffer.hpp"
+#include "TransformSnapshot.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace Physics {
+    // A body created by a command, and the request number Create returned for it
+    struct CreatedBody {
+        std::uint64_t request;
+        BodyHandle body;
+    };
+
+    // The transforms published by an AsyncWorld
+    struct AsyncSnapshot : TransformSnapshot {
+        // The bodies created since the last snapshot the reader took, so none are missed when snapshots are overwritten
+        std::vector<CreatedBody> createdBodies;
+    };
+
+    // Runs a world's fixed rate loop on its own thread, so a slow tick doesn't delay the thread that renders it
+    // After each round of ticks, the transform of every body is published through a triple buffer, which the renderer reads without waiting
+    // Changes are sent through a lock free queue, and applied at the start of the next round of ticks, in the order they were sent
+    // While running, the world must only be changed through the AsyncWorld
+    class AsyncWorld {
+        template<typename T>
+        struct CreateCommand {
+            std::uint64_t request;
+            T collider;
+        };
+
+        struct DestroyCommand {
+            BodyHandle body;
+        };
+
+        struct ImpulseCommand {
+            BodyHandle body;
+            glm::vec3 impulse;
+        };
+
+        struct PositionCommand {
+            BodyHandle body;
+            glm::vec3 position;
+        };
+
+        struct VelocityCommand {
+            BodyHandle body;
+            glm::vec3 velocity;
+        };
+
+        // The first type is default constructible, so the queue's cells can be default constructed
+        using Command = std::variant<DestroyCommand, ImpulseCommand, PositionCommand, VelocityCommand,
+            CreateCommand<SimplePlaneCollider>, CreateCommand<SimpleCubeCollider>, CreateCommand<SphereCollider>, CreateCommand<HeightfieldCollider>>;
+
+        PhysicsWorld& world;
+
+        BoundedQueue<Command> commands;
+        std::atomic<std::uint64_t> nextRequest = 0;
+
+        TripleBuffer<AsyncSnapshot> snapshots;
+
+        // Bodies created since the last snapshot was published
+        std::vector<CreatedBody> createdBodies;
+
+        // Whether the back buffer holds a snapshot the reader never took
+        bool backUnread = false;
+
+        // The clock the world ticks towards while running
+        double elapsedTime = 0;
+        double deltaTime = 0;
+        TimeManagerShim timeManager{elapsedTime, deltaTime};
+        TimeManagerShim* previousTimeManager = nullptr;
+
+        std::jthread thread;
+        std::atomic<bool> running = false;
+        std::exception_ptr exception;
+
+        // Used to wait for the next tick, or until the thread is stopped
+        std::mutex waitMutex;
+        std::condition_variable_any waitCondition;
+
+        void Run(std::stop_token stopToken);
+
+        // Applies at most one queue's worth of commands, so commands sent while applying wait for the next round
+        // Returns the number of commands applied
+        std::size_t ApplyCommands();
+
+        void Publish();
+
+        template<typename T>
+        std::optional<std::uint64_t> PushCreate(const T& collider);
+    public:
+        // Commands that don't fit in the queue are rejected, so the capacity should cover the commands sent during the longest tick
+        explicit AsyncWorld(PhysicsWorld& world, std::size_t commandCapacity = 4096);
+
+        // Stops the thread
+        ~AsyncWorld();
+
+        AsyncWorld(const AsyncWorld&) = delete;
+        AsyncWorld& operator=(const AsyncWorld&) = delete;
+
+        // Starts ticking from the world's current simulation time, and publishes a snapshot before the first tick
+        // Does nothing if the thread is already running
+        void Start();
+
+        // Waits for the current round of ticks to finish, and applies the commands that are still queued
+        // If the thread stopped because of an exception, rethrows it
+        void Stop();
+
+        bool IsRunning() const noexcept;
+
+        // Any thread can send commands, which return false, or nullopt, if the queue is full
+        // Commands for bodies that no longer exist are ignored
+
+        // Returns a request number, which is reported with the new body's handle in AsyncSnapshot::createdBodies
+        // Each body is reported exactly once, but may only be reported in a later snapshot than the first one it is in
+        std::optional<std::uint64_t> Create(const SimplePlaneCollider& collider);
+        std::optional<std::uint64_t> Create(const SimpleCubeCollider& collider);
+        std::optional<std::uint64_t> Create(const SphereCollider& collider);
+        std::optional<std::uint64_t> Create(const HeightfieldCollider& collider);
+
+        bool Destroy(BodyHandle body);
+        bool ApplyImpulse(BodyHandle body, glm::vec3 impulse);
+        bool SetPosition(BodyHandle body, glm::vec3 position);
+        bool SetVelocity(BodyHandle body, glm::vec3 velocity);
+
+        // Only one thread may read snapshots
+        // The latest published snapshot, which stays valid and unchanged until the next call
+        const AsyncSnapshot& GetSnapshot() noexcept;
+    };
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Collider.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Physics {
+    // Batched versions of the collision tests in CollisionTest.cpp, which test 4 or 8 pairs at a time using SIMD
+    // Each batch stores one array per component, with one element per pair
+    // For finite inputs, the results are bit-for-bit identical to the scalar tests, as long as the compiler isn't allowed to contract a * b + c into a fused multiply-add
+    // Non-finite velocities may choose a different plane normal, since the scalar test multiplies them by 0
+
+    struct BatchVec3 {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        void Resize(std::size_t size);
+
+        void Set(std::size_t i, glm::vec3 v) noexcept {
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+
+        glm::vec3 Get(std::size_t i) const noexcept {
+            return {x[i], y[i], z[i]};
+        }
+    };
+
+    // Tested like CollidesImpl(const SphereCollider&, const SphereCollider&)
+    struct SpherePairBatch {
+        BatchVec3 position1;
+        std::vector<float> size1;
+
+        BatchVec3 position2;
+        std::vector<float> size2;
+
+        std::size_t Size() const noexcept {
+            return size1.size();
+        }
+
+        void Resize(std::size_t size);
+    };
+
+    // Tested like CollidesImpl(const SimpleCubeCollider&, const SimpleCubeCollider&)
+    struct CubePairBatch {
+        BatchVec3 position1;
+        BatchVec3 size1;
+
+        BatchVec3 position2;
+        BatchVec3 size2;
+
+        std::size_t Size() const noexcept {
+            return position1.x.size();
+        }
+
+        void Resize(std::size_t size);
+    };
+
+    // A plane and either a cube or a sphere
+    // Tested like CollidesImpl(const SimplePlaneCollider&, const SimpleCubeCollider&), which only uses the y axis
+    struct PlanePairBatch {
+        std::vector<float> planeHeight;
+
+        std::vector<float> height;
+        std::vector<float> size;
+        std::vector<float> velocity;
+
+        std::size_t Size() const noexcept {
+            return planeHeight.size();
+        }
+
+        void Resize(std::size_t size);
+    };
+
+    struct BatchResults {
+        std::vector<std::uint8_t> collides;
+        BatchVec3 normal;
+        std::vector<float> penetration;
+
+        void Resize(std::size_t size);
+
+        CollisionResult Get(std::size_t i) const noexcept {
+            CollisionResult result{collides[i] != 0};
+
+            result.normal = normal.Get(i);
+            result.penetration = penetration[i];
+
+            return result;
+        }
+    };
+
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // The best level supported by this CPU
+    SimdLevel GetSupportedSimdLevel() noexcept;
+
+    // Defaults to the supported level
+    SimdLevel GetSimdLevel() noexcept;
+
+    // Lower levels can be selected for testing
+    // Throws std::invalid_argument if the CPU doesn't support level
+    void SetSimdLevel(SimdLevel level);
+
+    // These resize results to the size of the batch
+    void SpheresCollideBatch(const SpherePairBatch& batch, BatchResults& results);
+    void CubesCollideBatch(const CubePairBatch& batch, BatchResults& results);
+    void PlanesCollideBatch(const PlanePairBatch& batch, BatchResults& results);
+}
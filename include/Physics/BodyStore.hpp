@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "HandleTable.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // Bodies at tick level n step every 2^n ticks, so the highest level steps every 128 ticks
+    constexpr std::uint8_t maxTickLevel = 7;
+
+    // Stores the state that is used every tick in separate contiguous arrays
+    // This keeps integration and resolution as linear scans, instead of chasing a pointer to each collider
+    // Each body keeps a pointer to its collider, which is used by the narrowphase and updated by WriteBack
+    class BodyStore {
+    public:
+        std::vector<glm::vec3> positions;
+        // The positions before the last tick, used for interpolation
+        std::vector<glm::vec3> previousPositions;
+        std::vector<glm::vec3> velocities;
+        // 0 for static bodies
+        std::vector<float> inverseMasses;
+        std::vector<float> restitutions;
+
+        // std::vector<bool> isn't used because it isn't contiguous
+        std::vector<std::uint8_t> gravityFlags;
+
+        // Sleeping bodies aren't integrated, and pairs without an awake body are skipped by the narrowphase
+        // Static bodies are never awake
+        std::vector<std::uint8_t> awakeFlags;
+
+        // How long each body's speed has been below the sleep threshold
+        std::vector<float> sleepTimes;
+
+        // Bodies step every 2^tickLevel ticks, and are integrated over every tick since their last step
+        std::vector<std::uint8_t> tickLevels;
+
+        // The ticks each awake body hasn't been integrated over yet
+        std::vector<std::uint32_t> pendingTicks;
+
+        // The number of ticks each body is integrated over during the current tick, or 0 if it doesn't step
+        // Only stepping bodies have moved, so pairs without a stepping body are skipped by the narrowphase
+        std::vector<float> stepScales;
+
+        // Bodies with continuous collision enabled
+        std::vector<std::uint8_t> continuousFlags;
+
+        // Each collider's category, mask and group, checked for each pair before the narrowphase
+        std::vector<std::uint32_t> categories;
+        std::vector<std::uint32_t> masks;
+        std::vector<std::int32_t> groups;
+
+        // Half the size of each body's AABB
+        std::vector<glm::vec3> extents;
+
+        // Used by the narrowphase
+        std::vector<glm::vec3> sizes;
+        std::vector<ColliderTypeIndex> typeIndices;
+
+        std::vector<Collider*> colliders;
+
+        // The handle slot of each body, so its handle can be updated when it is moved
+        std::vector<std::uint32_t> handleSlots;
+
+        // Copies the collider's current state, and returns the new body's index
+        std::uint32_t Add(Collider* collider, std::uint32_t handleSlot = BodyHandle::invalidIndex);
+
+        // Moves the last body into index, so the arrays stay contiguous
+        // Returns the index the moved body used to have, which is index if it was the last body
+        std::uint32_t Remove(std::uint32_t index) noexcept;
+
+        std::size_t Size() const noexcept {
+            return positions.size();
+        }
+
+        void Reserve(std::size_t count);
+
+        // Removes every body, but keeps the arrays' capacity
+        void Clear() noexcept;
+
+        bool IsStatic(std::uint32_t index) const noexcept {
+            return inverseMasses[index] == 0;
+        }
+
+        bool IsAwake(std::uint32_t index) const noexcept {
+            return awakeFlags[index];
+        }
+
+        bool IsStepping(std::uint32_t index) const noexcept {
+            return stepScales[index] != 0;
+        }
+
+        // Adds the current tick to the pending ticks of each awake body in [begin, end), and sets their step scales
+        // Bodies step when the next tick is a multiple of 2^tickLevel, so bodies at every level line up at the end of their steps
+        void SelectSteppingBodies(std::uint64_t tick, std::size_t begin, std::size_t end) noexcept;
+
+        // Makes an awake body that isn't stepping during the current tick step over its pending ticks
+        // Returns false if the body is asleep or already stepping
+        bool StartStep(std::uint32_t index) noexcept;
+
+        // Checks the colliders' category, mask and group, without branches
+        bool ShouldCollide(std::uint32_t index1, std::uint32_t index2) const noexcept {
+            auto group = groups[index1];
+
+            bool sameGroup = group != 0 && group == groups[index2];
+            bool masksMatch = (categories[index1] & masks[index2]) != 0 && (categories[index2] & masks[index1]) != 0;
+
+            return sameGroup ? group > 0 : masksMatch;
+        }
+
+        // Does nothing for static bodies and bodies that are already awake
+        void Wake(std::uint32_t index) noexcept;
+
+        // Stops the body and puts it to sleep, dropping its pending ticks
+        void Sleep(std::uint32_t index) noexcept;
+
+        void CalculateBounds(std::vector<AABB>& bounds) const;
+
+        // The bounds of bodies with continuous collision cover their whole movement during the last tick
+        // Only calculates the bounds of the bodies in [begin, end)
+        // bounds must already have an element for each body
+        void CalculateBounds(std::span<AABB> bounds, std::size_t begin, std::size_t end) const noexcept;
+
+        // Copies a body's position and velocity to its collider
+        void WriteBack(std::uint32_t index) const noexcept;
+
+        // Copies every body's position and velocity to its collider
+        void WriteBack() const noexcept;
+
+        // Copies the position and velocity of the bodies in [begin, end) to their colliders
+        void WriteBack(std::size_t begin, std::size_t end) const noexcept;
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace Physics {
+    // A fixed size queue that any number of threads can push to and pop from without locks
+    // Each cell has a sequence number, which tells a thread whether the cell is ready for it, so threads only contend on the two positions
+    // T must be default constructible and movable
+    template<typename T>
+    class BoundedQueue {
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        std::size_t mask;
+
+        // On separate cache lines, so pushing and popping threads don't share one
+        alignas(64) std::atomic<std::size_t> pushPosition = 0;
+        alignas(64) std::atomic<std::size_t> popPosition = 0;
+    public:
+        // The capacity is rounded up to a power of 2
+        explicit BoundedQueue(std::size_t capacity) : cells{std::make_unique<Cell[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))}, mask{std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1} {
+            for(std::size_t i = 0; i <= mask; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        std::size_t GetCapacity() const noexcept {
+            return mask + 1;
+        }
+
+        // Returns false if the queue is full, in which case value isn't moved from
+        bool TryPush(T&& value) {
+            auto position = pushPosition.load(std::memory_order_relaxed);
+
+            while(true) {
+                auto& cell = cells[position & mask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                if(difference == 0) {
+                    // The cell is free, so claim it if no other thread did first
+                    if(pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                } else if(difference < 0) {
+                    // The cell still holds a value from one lap earlier
+                    return false;
+                } else {
+                    position = pushPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Returns false if the queue is empty
+        bool TryPop(T& value) {
+            auto position = popPosition.load(std::memory_order_relaxed);
+
+            while(true) {
+                auto& cell = cells[position & mask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+                if(difference == 0) {
+                    if(popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        value = std::move(cell.value);
+
+                        // Frees the cell for the push one lap later
+                        cell.sequence.store(position + mask + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                } else if(difference < 0) {
+                    return false;
+                } else {
+                    position = popPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+}
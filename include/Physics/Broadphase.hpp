@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "JobSystem.hpp"
+
+#include <cstdint>
+#include <compare>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // A pair of indices into the bounds passed to Broadphase::CalculatePairs
+    // first is always less than second
+    struct IndexPair {
+        std::uint32_t first;
+        std::uint32_t second;
+
+        constexpr auto operator<=>(const IndexPair&) const = default;
+    };
+
+    // Finds pairs of bodies that might collide, so that only those pairs reach the narrowphase
+    class Broadphase {
+    public:
+        // Appends candidate pairs to pairs, sorted in ascending order
+        // If jobSystem isn't null, it may be used to find pairs in parallel
+        virtual void CalculatePairs(std::span<const AABB> bounds, std::vector<IndexPair>& pairs, JobSystem* jobSystem = nullptr) = 0;
+
+        // Used by Remap for bodies that were removed
+        static constexpr auto removedIndex = std::numeric_limits<std::uint32_t>::max();
+
+        // Discards any state kept between calls
+        // Must be called when bodies are reordered, unless Remap is called instead
+        virtual void Reset() noexcept {}
+
+        // Must be called before the next CalculatePairs when bodies are removed
+        // newIndices has an element for each body passed to the last CalculatePairs, with its new index or removedIndex
+        // Bodies that were added since then don't need to be in newIndices
+        virtual void Remap(std::span<const std::uint32_t> newIndices) {
+            static_cast<void>(newIndices);
+            Reset();
+        }
+
+        virtual ~Broadphase() = default;
+    };
+
+    // Reports every pair without looking at the bounds
+    // This is O(n²), and is only meant to be used as a reference for the other broadphases
+    class BruteForceBroadphase final : public Broadphase {
+    public:
+        void CalculatePairs(std::span<const AABB> bounds, std::vector<IndexPair>& pairs, JobSystem* jobSystem = nullptr) override;
+    };
+
+    // Sorts the bounds along the x axis and sweeps over them, only testing bounds whose x ranges overlap
+    // The order is kept between calls, so the sort is close to linear when bodies only move a little each tick
+    class SweepAndPruneBroadphase final : public Broadphase {
+        struct Entry {
+            float min;
+            float max;
+            std::uint32_t index;
+        };
+
+        std::vector<Entry> entries;
+
+        // Marks the bodies that already have an entry when bodies are added
+        std::vector<std::uint8_t> hasEntry;
+
+        // The sweep is split into ranges of entries, and each range finds its pairs separately
+        std::vector<std::vector<IndexPair>> rangePairs;
+    public:
+        void CalculatePairs(std::span<const AABB> bounds, std::vector<IndexPair>& pairs, JobSystem* jobSystem = nullptr) override;
+
+        void Reset() noexcept override;
+
+        // Keeps the entries sorted, so removing bodies doesn't need a full sort
+        void Remap(std::span<const std::uint32_t> newIndices) override;
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Collider.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // A bounding volume hierarchy over a set of boxes, used to find the boxes near a point, ray or box without testing all of them
+    // Built from scratch by splitting the boxes at the median of their centers along the longest axis
+    // Boxes that are infinite along an axis, like the bounds of SimplePlaneCollider, can't be split, so they are kept in a separate list
+    class Bvh {
+        struct Node {
+            AABB bounds;
+
+            // For leaves, the first of count items in items
+            // For other nodes, the index of the first child, which is followed by the second child
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<std::uint32_t> items;
+        std::vector<std::uint32_t> unboundedItems;
+
+        // The center of each box, used while building
+        std::vector<glm::vec3> centers;
+
+        void Split(std::uint32_t nodeIndex, std::span<const AABB> bounds);
+    public:
+        // Leaves have at most this many items
+        static constexpr std::uint32_t leafSize = 4;
+
+        // The items are the indices of the boxes in bounds
+        void Build(std::span<const AABB> bounds);
+
+        // Items that aren't in the tree
+        std::span<const std::uint32_t> GetUnboundedItems() const noexcept {
+            return unboundedItems;
+        }
+
+        // Calls visit(item) for every item in the tree whose node passes overlaps(nodeBounds), including the unbounded ones
+        // overlaps is called again for each node, so it can depend on what visit has found so far, like the closest hit of a ray
+        template<typename Overlaps, typename Visit>
+        void Query(Overlaps&& overlaps, Visit&& visit) const {
+            for(auto item : unboundedItems) {
+                visit(item);
+            }
+
+            if(nodes.empty()) return;
+
+            // Splitting at the median keeps the depth at about log2(n / leafSize)
+            std::array<std::uint32_t, 64> stack;
+            std::size_t stackSize = 0;
+
+            stack[stackSize++] = 0;
+
+            while(stackSize > 0) {
+                auto& node = nodes[stack[--stackSize]];
+
+                if(!overlaps(node.bounds)) continue;
+
+                if(node.count > 0) {
+                    for(auto i = node.first; i < node.first + node.count; i++) {
+                        visit(items[i]);
+                    }
+                } else {
+                    stack[stackSize++] = node.first + 1;
+                    stack[stackSize++] = node.first;
+                }
+            }
+        }
+    };
+
+    // Returns true if a ray starts in the box or enters it within maxDistance
+    // inverseDirection is 1 / direction, with infinities for axes the ray is parallel to
+    bool RayIntersectsAABB(const AABB& box, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance) noexcept;
+}
@@ -6,6 +6,10 @@
 #include <utility>
 #include <type_traits>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 
 #include <concepts>
 
@@ -15,6 +19,9 @@ struct TimeManagerShim {
 };
 
 namespace Physics {
+    // A mask with every layer
+    constexpr std::uint32_t allLayers = std::numeric_limits<std::uint32_t>::max();
+
     struct CollisionResult {
         bool collides = false;
 
@@ -22,7 +29,7 @@ namespace Physics {
         //Collider* collider2;
 
         glm::vec3 normal = {};
-        float penetration;
+        float penetration = 0;
 
         constexpr CollisionResult(bool b) noexcept : collides{b} {}
 
@@ -31,77 +38,63 @@ namespace Physics {
         }
     };
 
+    // Axis aligned bounding box
+    struct AABB {
+        glm::vec3 min;
+        glm::vec3 max;
+
+        // Touching boxes don't overlap, matching the collision tests
+        constexpr bool Overlaps(const AABB& other) const noexcept {
+            return min.x < other.max.x && max.x > other.min.x &&
+                   min.y < other.max.y && max.y > other.min.y &&
+                   min.z < other.max.z && max.z > other.min.z;
+        }
+    };
+
     // Forward declare classes
     class Collider;
     class SimplePlaneCollider;
     class SimpleCubeCollider;
     class SphereCollider;
+    class HeightfieldCollider;
+    class Heightfield;
 
-    // Forward declare function templates
-    template<std::derived_from<Collider> T, std::derived_from<Collider> U>
-    CollisionResult Collides(const T& t, const U& u);
-
-    // Returns true if collision checking between the types is implemented
-    template<std::derived_from<Collider> T, std::derived_from<Collider> U>
-    bool SupportsCollision() noexcept;
-
-    class NotImplementedException : public std::runtime_error {
-        static std::string CreateExceptionText(const Collider& collider1, const Collider& collider2);
-    public:
-        NotImplementedException(const Collider& collider1, const Collider& collider2) : runtime_error{CreateExceptionText(collider1, collider2)} {}
+    template<typename... Types>
+    struct TypeList {
+        static constexpr std::size_t size = sizeof...(Types);
     };
 
-    class CollisionDispatcher {
-    protected:
-        ~CollisionDispatcher() = default;
-    public:
-        CollisionDispatcher(const char* colliderTypeName) : colliderTypeName{colliderTypeName} {}
+    template<typename T, typename... Types>
+    constexpr std::size_t IndexOf(TypeList<Types...>) noexcept {
+        std::size_t index = 0;
 
-        virtual CollisionResult DispatchCollides(const SimplePlaneCollider&) const = 0;
-        virtual CollisionResult DispatchCollides(const SimpleCubeCollider&) const = 0;
-        virtual CollisionResult DispatchCollides(const SphereCollider&) const = 0;
+        // Stops incrementing after the first match
+        static_cast<void>(((std::is_same_v<T, Types> ? true : (index++, false)) || ...));
 
-        virtual bool DispatchCanCollide(const SimplePlaneCollider&) const noexcept = 0;
-        virtual bool DispatchCanCollide(const SimpleCubeCollider&) const noexcept = 0;
-        virtual bool DispatchCanCollide(const SphereCollider&) const noexcept = 0;
+        return index;
+    }
 
-        const char* colliderTypeName;
-    };
+    // Adding a collider type only requires adding it to this list, and adding its collision tests to CollidesImpl
+    using ColliderTypes = TypeList<SimplePlaneCollider, SimpleCubeCollider, SphereCollider, HeightfieldCollider>;
 
-    template<typename ColliderType>
-    class DispatcherCreator : public CollisionDispatcher {
-        ColliderType* thisCollider;
-    public:
-        DispatcherCreator(ColliderType* thisCollider) : CollisionDispatcher{ColliderType::colliderTypeName}, thisCollider{thisCollider} {}
+    using ColliderTypeIndex = std::uint8_t;
 
-        CollisionResult DispatchCollides(const SimplePlaneCollider& other) const final {
-            return Collides(*thisCollider, other);
-        }
-        CollisionResult DispatchCollides(const SimpleCubeCollider& other) const final {
-            return Collides(*thisCollider, other);
-        }
-        CollisionResult DispatchCollides(const SphereCollider& other) const final {
-            return Collides(*thisCollider, other);
-        }
+    constexpr std::size_t colliderTypeCount = ColliderTypes::size;
 
-        bool DispatchCanCollide(const SimplePlaneCollider& other) const noexcept final {
-            using OtherType = std::remove_cvref_t<decltype(other)>;
-            return SupportsCollision<ColliderType, OtherType>();
-        }
-        bool DispatchCanCollide(const SimpleCubeCollider& other) const noexcept final {
-            using OtherType = std::remove_cvref_t<decltype(other)>;
-            return SupportsCollision<ColliderType, OtherType>();
-        }
-        bool DispatchCanCollide(const SphereCollider& other) const noexcept final {
-            using OtherType = std::remove_cvref_t<decltype(other)>;
-            return SupportsCollision<ColliderType, OtherType>();
-        }
+    template<typename T>
+    constexpr ColliderTypeIndex colliderTypeIndex = static_cast<ColliderTypeIndex>(IndexOf<T>(ColliderTypes{}));
+
+    class NotImplementedException : public std::runtime_error {
+        static std::string CreateExceptionText(const Collider& collider1, const Collider& collider2);
+    public:
+        NotImplementedException(const Collider& collider1, const Collider& collider2) : runtime_error{CreateExceptionText(collider1, collider2)} {}
     };
 
     class Collider {
+        ColliderTypeIndex typeIndex;
     protected:
-        virtual const CollisionDispatcher& GetCollisionDispatcher() const noexcept = 0;
-        virtual CollisionDispatcher& GetCollisionDispatcher() noexcept = 0;
+        Collider(ColliderTypeIndex typeIndex, glm::vec3 position, glm::vec3 size, glm::vec3 velocity);
+        Collider(ColliderTypeIndex typeIndex, glm::vec3 position, float size, glm::vec3 velocity);
     public:
         glm::vec3 position = {};
         glm::vec3 size = {1, 1, 1};
@@ -112,55 +105,74 @@ namespace Physics {
         float restitution = 1;
         float mass = 1;
 
-        Collider(glm::vec3 position, glm::vec3 size, glm::vec3 velocity);
-        Collider(glm::vec3 position, float size, glm::vec3 velocity);
+        // Static colliders aren't affected by gravity or collisions, as if their mass was infinite
+        // Contacts with static colliders don't join their bodies into one island
+        bool isStatic = false;
+
+        // Sweeps the collider's movement each tick, so it can't pass through other colliders when it moves fast
+        // This costs more than the discrete tests, so it should only be enabled for fast moving colliders
+        bool continuousCollision = false;
+
+        // The layers the collider is in, as a bitmask
+        // Queries only find colliders in one of the layers in their mask
+        std::uint32_t category = 1;
+
+        // The layers the collider collides with
+        // Two colliders only collide if each one's category shares a bit with the other's mask
+        std::uint32_t mask = allLayers;
+
+        // Colliders in the same positive group always collide, and colliders in the same negative group never do, whatever their masks
+        // 0 is no group
+        std::int32_t group = 0;
+
+        // 0 for static colliders
+        float CalculateInverseMass() const noexcept;
 
         std::pair<glm::vec3, glm::vec3> CalculatePositionAndVelocity(glm::vec3 gravityVector, float deltaTime) const noexcept;
 
-        // Returns true if collision checking between this type and other's type is implemented
-        virtual bool SupportsCollisionWith(const Collider& other) const noexcept = 0;
+        // Returns half the size of the box returned by CalculateAABB
+        virtual glm::vec3 CalculateExtents() const noexcept;
 
-        virtual CollisionResult CollidesWith(const Collider&) const = 0;
+        // Returns a box containing everything this collider can collide with
+        AABB CalculateAABB() const noexcept;
 
-        const char* GetColliderTypeName() const {
-            return GetCollisionDispatcher().colliderTypeName;
+        // The index of this collider's type in ColliderTypes
+        ColliderTypeIndex GetTypeIndex() const noexcept {
+            return typeIndex;
         }
 
+        // Returns true if collision checking between this type and other's type is implemented
+        bool SupportsCollisionWith(const Collider& other) const noexcept;
+
+        // The normal points from this collider towards other
+        CollisionResult CollidesWith(const Collider& other) const;
+
+        const char* GetColliderTypeName() const noexcept;
+
         virtual ~Collider() = default;
     };
 
     template<typename T>
     class ColliderCreator : public Collider {
-        class Dispatcher final : public DispatcherCreator<T> {
-        public:
-            using DispatcherCreator<T>::DispatcherCreator;
-        };
-
-        Dispatcher dispatcher{static_cast<T*>(this)};
-
-        const CollisionDispatcher& GetCollisionDispatcher() const noexcept final {
-            return dispatcher;
-        }
-        CollisionDispatcher& GetCollisionDispatcher() noexcept final {
-            return dispatcher;
-        }
     public:
-        using Collider::Collider;
-
-        bool SupportsCollisionWith(const Collider& other) const noexcept final {
-            return static_cast<const ColliderCreator&>(other).GetCollisionDispatcher().DispatchCanCollide(*static_cast<const T*>(this));
-        }
-
-        CollisionResult CollidesWith(const Collider& other) const final {
-            return static_cast<const ColliderCreator&>(other).GetCollisionDispatcher().DispatchCollides(*static_cast<const T*>(this));
-        }
+        ColliderCreator(glm::vec3 position, glm::vec3 size, glm::vec3 velocity) :
+            Collider{colliderTypeIndex<T>, position, size, velocity} {}
+        ColliderCreator(glm::vec3 position, float size, glm::vec3 velocity) :
+            Collider{colliderTypeIndex<T>, position, size, velocity} {}
     };
 
     class SimplePlaneCollider final : public ColliderCreator<SimplePlaneCollider> {
     public:
         static constexpr const char* colliderTypeName = "SimplePlane";
 
-        SimplePlaneCollider(float height) : ColliderCreator{{0, height, 0}, 1, {}} {}
+        // Planes are static
+        SimplePlaneCollider(float height) : ColliderCreator{{0, height, 0}, 1, {}} {
+            isStatic = true;
+            hasGravity = false;
+        }
+
+        // The plane is infinite along the x and z axes
+        glm::vec3 CalculateExtents() const noexcept override;
     };
 
     class SimpleCubeCollider final : public ColliderCreator<SimpleCubeCollider> {
@@ -180,6 +192,25 @@ namespace Physics {
         SphereCollider(glm::vec3 position, glm::vec3 size, glm::vec3 velocity) = delete;
     };
 
+    // Terrain, which is cheaper than building it out of cubes since it is one body, and only the cells under a body are tested
+    // The heightfield is shared, so copies of the collider don't copy the heights
+    class HeightfieldCollider final : public ColliderCreator<HeightfieldCollider> {
+        std::shared_ptr<const Heightfield> heightfield;
+    public:
+        static constexpr const char* colliderTypeName = "Heightfield";
+
+        // Heightfields are static
+        // origin is where the heightfield's first sample would be if its height was 0, and position is the center of the heightfield's bounds
+        // Throws std::invalid_argument if heightfield is null
+        HeightfieldCollider(glm::vec3 origin, std::shared_ptr<const Heightfield> heightfield);
+
+        const Heightfield& GetHeightfield() const noexcept {
+            return *heightfield;
+        }
+
+        glm::vec3 GetOrigin() const noexcept;
+    };
+
     constexpr float earthGravity = 9.81f;
     constexpr glm::vec3 earthGravityVector = {0, -earthGravity, 0};
 }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Collider.hpp"
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace Physics {
+    // Contiguous storage for colliders of one type, owned by a PhysicsWorld
+    // Removing a collider moves the last one into its place, so adding and removing are O(1) and there are never gaps
+    // Pointers to the colliders change when they are moved or when the storage grows
+    template<typename T>
+    class ColliderPool {
+        std::vector<T> colliders;
+
+        // The handle slot of each collider's body
+        std::vector<std::uint32_t> handleSlots;
+    public:
+        // Returns the collider's index
+        std::uint32_t Add(const T& collider, std::uint32_t handleSlot) {
+            colliders.push_back(collider);
+            handleSlots.push_back(handleSlot);
+
+            return static_cast<std::uint32_t>(colliders.size() - 1);
+        }
+
+        // Moves the last collider into index
+        // Returns the index the moved collider used to have, which is index if it was the last collider
+        std::uint32_t Remove(std::uint32_t index) noexcept {
+            auto last = static_cast<std::uint32_t>(colliders.size() - 1);
+
+            colliders[index] = colliders[last];
+            handleSlots[index] = handleSlots[last];
+
+            colliders.pop_back();
+            handleSlots.pop_back();
+
+            return last;
+        }
+
+        std::size_t Size() const noexcept {
+            return colliders.size();
+        }
+
+        void Reserve(std::size_t count) {
+            colliders.reserve(count);
+            handleSlots.reserve(count);
+        }
+
+        void Clear() noexcept {
+            colliders.clear();
+            handleSlots.clear();
+        }
+
+        T& operator[](std::uint32_t index) noexcept {
+            return colliders[index];
+        }
+
+        std::uint32_t GetHandleSlot(std::uint32_t index) const noexcept {
+            return handleSlots[index];
+        }
+    };
+
+    template<typename Types>
+    struct ColliderPoolsFor;
+
+    template<typename... Types>
+    struct ColliderPoolsFor<TypeList<Types...>> {
+        using type = std::tuple<ColliderPool<Types>...>;
+    };
+
+    // A pool for each collider type, in the same order as ColliderTypes
+    using ColliderPools = ColliderPoolsFor<ColliderTypes>::type;
+}
@@ -2,10 +2,55 @@
 
 #include "Collider.hpp"
 #include "CollisionTest.hpp"
+#include "Broadphase.hpp"
+#include "BodyStore.hpp"
 
 #include <span>
+#include <vector>
 
 namespace Physics {
+    struct Contact {
+        Collider* collider1;
+        Collider* collider2;
+
+        // The indices of the colliders in the span the contact was calculated from
+        // In a PhysicsWorld, these are the indices of the bodies
+        std::uint32_t index1;
+        std::uint32_t index2;
+
+        // Points from collider1 towards collider2
+        glm::vec3 normal;
+        float penetration;
+
+        // The total impulse the solver applied along the normal, which warm starts the bodies' next contact
+        float impulse = 0;
+    };
+
+    // Runs the narrowphase once for each pair reported by broadphase, and appends a contact for each colliding pair
+    void CalculateContacts(std::span<Collider*> colliders, Broadphase& broadphase, std::vector<Contact>& contacts);
+
+    // Runs the narrowphase once for each pair of indices into colliders
+    void CalculateContacts(std::span<Collider* const> colliders, std::span<const IndexPair> pairs, std::vector<Contact>& contacts);
+
+    // Applies an impulse to the colliders in each contact
+    void ResolveContacts(std::span<const Contact> contacts);
+
+    // Applies an impulse to the bodies in each contact
+    void ResolveContacts(BodyStore& bodies, std::span<const Contact> contacts);
+
+    // Only pairs reported by broadphase are passed to the narrowphase
+    void ResolveCollisions(std::span<Collider*> colliders, Broadphase& broadphase);
+
+    // Tests every pair of colliders
     void ResolveCollisions(std::span<Collider*> colliders);
     void ApplyVelocity(std::span<Collider*> colliders, glm::vec3 gravityVector, float deltaTime);
+    void ApplyVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime);
+
+    // Sleeping and static bodies aren't moved
+    // Only moves the bodies in [begin, end), so ranges can be integrated in parallel
+    void ApplyVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime, std::size_t begin, std::size_t end);
+
+    // Integrates each body in [begin, end) over its step scale times deltaTime, so bodies that aren't stepping aren't moved
+    // A step scale of 1 gives exactly the same result as ApplyVelocity
+    void ApplyScaledVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime, std::size_t begin, std::size_t end);
 }
@@ -2,43 +2,29 @@
 
 #include "Collider.hpp"
 
+#include <array>
 #include <type_traits>
 #include <concepts>
 
 namespace Physics {
     // Making this a struct with operator() allows us to use std::is_invocable
+    // Collision between two types is supported if there is an overload for them, in either order
     struct CollidesImpl {
-        CollisionResult operator()(const SimplePlaneCollider&, const SimplePlaneCollider&);
         CollisionResult operator()(const SimplePlaneCollider&, const SimpleCubeCollider&);
         CollisionResult operator()(const SimplePlaneCollider&, const SphereCollider&);
 
         CollisionResult operator()(const SimpleCubeCollider&, const SimpleCubeCollider&);
-        CollisionResult operator()(const SimpleCubeCollider&, const SphereCollider&);
 
         CollisionResult operator()(const SphereCollider&, const SphereCollider&);
-    };
-
-    namespace {
-        template<typename T, typename U>
-        struct SupportsCollisionImpl;
 
-        namespace detail {
-            template<typename T, typename U, typename = void>
-            struct IsDefined : std::false_type {};
-
-            template<typename T, typename U>
-            struct IsDefined<T, U, std::void_t<decltype(SupportsCollisionImpl<T, U>::value)>> : std::true_type {};
-        }
-    }
+        CollisionResult operator()(const HeightfieldCollider&, const SimpleCubeCollider&);
+        CollisionResult operator()(const HeightfieldCollider&, const SphereCollider&);
+    };
 
+    // Returns true if collision checking between the types is implemented
     template<std::derived_from<Collider> T, std::derived_from<Collider> U>
-    bool SupportsCollision() noexcept {
-        if constexpr(detail::IsDefined<T, U>::value) {
-            return SupportsCollisionImpl<T, U>::value;
-        }
-        else {
-            return SupportsCollisionImpl<U, T>::value;
-        }
+    constexpr bool SupportsCollision() noexcept {
+        return std::is_invocable_v<CollidesImpl, const T&, const U&> || std::is_invocable_v<CollidesImpl, const U&, const T&>;
     }
 
     // Collision testing is symmetric
@@ -64,34 +50,42 @@ namespace Physics {
         }
     }
 
-// TODO: Find a better solution than these ugly macros
-
-#define SPECIALIZE_SUPPORTS_COLLISION_IMPL(Type1, Type2, Value) \
-    namespace { \
-        template<> struct SupportsCollisionImpl<Type1, Type2> { static constexpr bool value = Value; };\
-    }
-
-#define IMPLEMENT(Type1, Type2) \
-    SPECIALIZE_SUPPORTS_COLLISION_IMPL(Type1, Type2, true)
-
-#define NOTIMPLEMENTED(Type1, Type2) \
-    SPECIALIZE_SUPPORTS_COLLISION_IMPL(Type1, Type2, false)
-
+    namespace detail {
+        using CollidesFunction = CollisionResult (*)(const Collider&, const Collider&);
 
-    NOTIMPLEMENTED(SimplePlaneCollider, SimplePlaneCollider);
-
-    IMPLEMENT(SimplePlaneCollider, SimpleCubeCollider);
+        template<typename T, typename U>
+        CollisionResult CollidesEntry(const Collider& t, const Collider& u) {
+            if constexpr(SupportsCollision<T, U>()) {
+                return Collides(static_cast<const T&>(t), static_cast<const U&>(u));
+            }
+            else {
+                throw NotImplementedException{t, u};
+            }
+        }
 
-    IMPLEMENT(SimplePlaneCollider, SphereCollider);
+        template<typename T, typename... Types>
+        constexpr std::array<CollidesFunction, sizeof...(Types)> MakeCollidesRow(TypeList<Types...>) noexcept {
+            return {&CollidesEntry<T, Types>...};
+        }
 
-    IMPLEMENT(SimpleCubeCollider, SimpleCubeCollider);
+        template<typename... Types>
+        constexpr auto MakeCollidesTable(TypeList<Types...> types) noexcept {
+            return std::array{MakeCollidesRow<Types>(types)...};
+        }
 
-    NOTIMPLEMENTED(SimpleCubeCollider, SphereCollider);
+        template<typename T, typename... Types>
+        constexpr std::array<bool, sizeof...(Types)> MakeSupportsCollisionRow(TypeList<Types...>) noexcept {
+            return {SupportsCollision<T, Types>()...};
+        }
 
-    IMPLEMENT(SphereCollider, SphereCollider);
+        template<typename... Types>
+        constexpr auto MakeSupportsCollisionTable(TypeList<Types...> types) noexcept {
+            return std::array{MakeSupportsCollisionRow<Types>(types)...};
+        }
+    }
 
+    // Both tables are indexed by the type indices of the two colliders
+    // collidesTable[i][j](t, u) calls Collides with t and u cast to their types, or throws NotImplementedException
+    inline constexpr auto collidesTable = detail::MakeCollidesTable(ColliderTypes{});
+    inline constexpr auto supportsCollisionTable = detail::MakeSupportsCollisionTable(ColliderTypes{});
 }
-
-#undef SPECIALIZE_SUPPORTS_COLLISION_IMPL
-#undef IMPLEMENT
-#undef NOTIMPLEMENTED
\ No newline at end of file
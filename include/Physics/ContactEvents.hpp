@@ -0,0 +1,110 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "Collision.hpp"
+#include "HandleTable.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace Physics {
+    enum class ContactEventType : std::uint8_t {
+        // The bodies started touching during the tick
+        Begin,
+        // The bodies were already touching, and still are
+        Persist,
+        // The bodies stopped touching, or one of them was destroyed
+        End
+    };
+
+    // A pair of bodies that were touching at the end of a tick
+    // body1.index is always less than body2.index, so the same bodies are always in the same order
+    struct TouchingPair {
+        BodyHandle body1;
+        BodyHandle body2;
+
+        // Points from body1 towards body2
+        glm::vec3 normal;
+        float penetration;
+
+        // The total impulse the solver applied along the normal during the tick
+        float impulse;
+    };
+
+    // End events have the normal, penetration and impulse of the last tick the bodies were touching
+    // The handles of End events may no longer be valid, if a body was destroyed
+    struct ContactEvent {
+        ContactEventType type;
+        TouchingPair pair;
+    };
+
+    // Finds contact events by comparing the contacts of each tick to the pairs that were touching after the previous tick
+    // Pairs are kept in open addressing hash tables keyed by the bodies' handles, which are reused between ticks
+    // The pairs also keep the solver's impulses, which warm start the next tick
+    // Nothing is allocated once the tables and the event buffer are big enough
+    class ContactTracker {
+        struct PairTable {
+            std::vector<TouchingPair> pairs;
+
+            // Indices into pairs, or emptySlot
+            std::vector<std::uint32_t> slots;
+
+            // Returns emptySlot if the pair isn't in the table
+            std::uint32_t Find(BodyHandle body1, BodyHandle body2) const noexcept;
+
+            // The pair must not already be in the table, and slots must have room for it
+            void Insert(const TouchingPair& pair) noexcept;
+
+            // Removes every pair, and makes room for up to count pairs
+            void Reset(std::size_t count);
+        };
+
+        static constexpr auto emptySlot = BodyHandle::invalidIndex;
+
+        // The pairs touching after the last tick, and the pairs found during the current one
+        PairTable previous;
+        PairTable current;
+
+        // Whether each pair in previous was found again
+        std::vector<std::uint8_t> found;
+
+        std::vector<ContactEvent> events;
+
+        // The Begin or Persist event of the first contact of the last update
+        std::size_t firstContactEvent = 0;
+    public:
+        // Appends the events of one tick, and sets the impulse of each contact that was touching after the previous tick
+        // Pairs without a stepping body aren't passed to the narrowphase, so their contacts are kept without events until a body wakes
+        // Must run before contacts wake the bodies they touch
+        // contacts must not have two contacts for the same pair
+        void Update(std::span<Contact> contacts, const BodyStore& bodies, const HandleTable& handles);
+
+        // Keeps the solved impulses of the contacts passed to the last update, for the next tick and for that update's events
+        void StoreImpulses(std::span<const Contact> contacts) noexcept;
+
+        // The events appended since the last call to ClearEvents, in the order their ticks ran
+        // Within a tick, Begin and Persist events are in the order of the contacts, followed by End events
+        std::span<const ContactEvent> GetEvents() const noexcept {
+            return events;
+        }
+
+        // Keeps the buffer's capacity
+        void ClearEvents() noexcept {
+            events.clear();
+        }
+
+        // The pairs touching after the last tick, which rollback saves with each frame
+        std::span<const TouchingPair> GetTouchingPairs() const noexcept {
+            return previous.pairs;
+        }
+
+        // Replaces the touching pairs, so the next tick only reports changes since then
+        void Restore(std::span<const TouchingPair> pairs);
+
+        // Forgets every touching pair, so every contact in the next tick begins
+        void Clear() noexcept;
+    };
+}
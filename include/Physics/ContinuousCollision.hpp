@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "Collision.hpp"
+#include "BodyStore.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // The first time during a movement that two shapes touch
+    struct SweepResult {
+        bool hits = false;
+
+        // The fraction of the displacement at which the shapes touch, from 0 to 1
+        float time = 1;
+
+        // Points from the first shape towards the second, or from the plane towards the moving shape
+        glm::vec3 normal = {};
+    };
+
+    // Each shape moves from its start position by its displacement
+    // Shapes that already overlap at the start aren't reported, since the discrete tests handle them
+    // Planes are horizontal and don't move, like SimplePlaneCollider
+
+    SweepResult SweepSpherePlane(glm::vec3 start, glm::vec3 displacement, float radius, float planeHeight) noexcept;
+
+    SweepResult SweepSpheres(glm::vec3 start1, glm::vec3 displacement1, float radius1,
+                             glm::vec3 start2, glm::vec3 displacement2, float radius2) noexcept;
+
+    SweepResult SweepAABBs(const AABB& box1, glm::vec3 displacement1, const AABB& box2, glm::vec3 displacement2) noexcept;
+
+    SweepResult SweepAABBPlane(const AABB& box, glm::vec3 displacement, float planeHeight) noexcept;
+
+    // Finds collisions that happened during the last tick but that the discrete tests missed, because a body moved through another
+    // Only pairs with a body that has continuous collision enabled are swept
+    class ContinuousCollision {
+        // The earliest time of impact of each body, as a fraction of the tick
+        std::vector<float> impactTimes;
+        std::vector<std::uint32_t> hitBodies;
+
+        SweepResult Sweep(const BodyStore& bodies, IndexPair pair) const noexcept;
+    public:
+        // contacts must only contain the contacts found by the narrowphase for pairs, in the same order
+        // Appends a contact for each pair that touched during the tick, and moves the bodies with continuous collision back to their first impact
+        void CalculateContacts(BodyStore& bodies, std::span<const IndexPair> pairs, std::vector<Contact>& contacts);
+    };
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <compare>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // Refers to a body in a PhysicsWorld
+    // A handle stops being valid when its body is destroyed, even if its slot is reused by another body
+    struct BodyHandle {
+        static constexpr auto invalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+        // The index of the handle's slot, not of the body's data
+        std::uint32_t index = invalidIndex;
+
+        // Incremented each time the slot is freed
+        std::uint32_t generation = 0;
+
+        constexpr bool IsValid() const noexcept {
+            return index != invalidIndex;
+        }
+
+        constexpr auto operator<=>(const BodyHandle&) const = default;
+    };
+
+    // Maps handles to the indices of their bodies, which change when other bodies are removed
+    // Freed slots are kept in a free list and reused, so creating and destroying handles is O(1)
+    class HandleTable {
+    public:
+        struct Slot {
+            std::uint32_t generation = 0;
+
+            // The body's index, or the next free slot if this slot is free
+            std::uint32_t index;
+
+            bool used;
+        };
+    private:
+        std::vector<Slot> slots;
+        std::uint32_t firstFreeSlot = BodyHandle::invalidIndex;
+    public:
+        BodyHandle Create(std::uint32_t index);
+
+        // The handle's slot can be reused by the next call to Create, with a different generation
+        void Destroy(BodyHandle handle) noexcept;
+
+        bool Contains(BodyHandle handle) const noexcept {
+            return handle.index < slots.size() && slots[handle.index].used && slots[handle.index].generation == handle.generation;
+        }
+
+        // handle must be valid
+        std::uint32_t GetIndex(BodyHandle handle) const noexcept {
+            return slots[handle.index].index;
+        }
+
+        // Used when a body is moved to a different index
+        void SetIndex(std::uint32_t slot, std::uint32_t index) noexcept {
+            slots[slot].index = index;
+        }
+
+        BodyHandle GetHandle(std::uint32_t slot) const noexcept {
+            return {slot, slots[slot].generation};
+        }
+
+        // Used to save and restore the table
+        std::span<const Slot> GetSlots() const noexcept {
+            return slots;
+        }
+
+        std::uint32_t GetFirstFreeSlot() const noexcept {
+            return firstFreeSlot;
+        }
+
+        // Replaces every slot, which makes every existing handle refer to the restored slots instead
+        void Restore(std::span<const Slot> newSlots, std::uint32_t newFirstFreeSlot);
+    };
+}
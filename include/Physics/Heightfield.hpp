@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "MappedFile.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace Physics {
+    // A heightfield file is a HeightfieldHeader followed by the heights in the same tiled order as in memory
+    // Every field is little endian, so the file can be mapped into memory and read in place
+
+    constexpr std::array<char, 4> heightfieldMagic = {'P', 'H', 'H', 'F'};
+
+    // Incremented whenever the layout of a heightfield file changes
+    constexpr std::uint32_t heightfieldVersion = 1;
+
+    static_assert(std::endian::native == std::endian::little, "Heightfield files are only supported on little endian platforms");
+
+    struct HeightfieldHeader {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+
+        std::uint32_t countX;
+        std::uint32_t countZ;
+
+        // Checked when loading, in case it changes
+        std::uint32_t tileSize;
+
+        float spacing;
+        float minHeight;
+        float maxHeight;
+    };
+
+    static_assert(std::is_trivially_copyable_v<HeightfieldHeader> && sizeof(HeightfieldHeader) == 32);
+
+    // A regular grid of countX by countZ heights, spacing apart along x and z
+    // Heights are stored in square tiles of tileSize by tileSize samples, so the samples under a body are in a few cache lines instead of one per row
+    // Each cell between four samples is split into two triangles, along the diagonal from its corner with the lowest x and z
+    // Positions are relative to the first sample, at height 0
+    class Heightfield {
+        std::uint32_t countX = 0;
+        std::uint32_t countZ = 0;
+        std::uint32_t tileCountX = 0;
+        float spacing = 1;
+        float minHeight = 0;
+        float maxHeight = 0;
+
+        // Either points into ownedHeights, or into the mapped file
+        const float* heights = nullptr;
+        std::vector<float> ownedHeights;
+        std::unique_ptr<MappedFile> file;
+
+        std::size_t GetTiledIndex(std::uint32_t x, std::uint32_t z) const noexcept {
+            auto tile = static_cast<std::size_t>(z / tileSize) * tileCountX + x / tileSize;
+
+            return tile * tileSize * tileSize + (z % tileSize) * tileSize + x % tileSize;
+        }
+
+        // The number of heights stored, including the padding of the last row and column of tiles
+        std::size_t GetStoredCount() const noexcept;
+
+        // The first and last cells overlapping [min, max] along an axis with count samples, or first > last if there aren't any
+        std::pair<std::uint32_t, std::uint32_t> GetCellRange(float min, float max, std::uint32_t count) const noexcept;
+    public:
+        static constexpr std::uint32_t tileSize = 8;
+
+        // The most samples along each axis, so the number of stored heights can't overflow
+        static constexpr std::uint32_t maxCount = 1 << 24;
+
+        // rowHeights has countX * countZ samples, in rows along x
+        // Throws std::invalid_argument if there are fewer than 2 or more than maxCount samples along either axis, the spacing isn't positive, or rowHeights has the wrong size
+        Heightfield(std::uint32_t countX, std::uint32_t countZ, float spacing, std::span<const float> rowHeights);
+
+        // Maps a file written by Save into memory, so only the tiles that are used are read from disk
+        // Throws std::runtime_error if the file can't be mapped or isn't a valid heightfield
+        explicit Heightfield(const std::filesystem::path& path);
+
+        // Throws std::runtime_error if writing fails
+        void Save(const std::filesystem::path& path) const;
+
+        std::uint32_t GetCountX() const noexcept {
+            return countX;
+        }
+
+        std::uint32_t GetCountZ() const noexcept {
+            return countZ;
+        }
+
+        float GetSpacing() const noexcept {
+            return spacing;
+        }
+
+        float GetMinHeight() const noexcept {
+            return minHeight;
+        }
+
+        float GetMaxHeight() const noexcept {
+            return maxHeight;
+        }
+
+        // The size of the heightfield's bounds
+        glm::vec3 GetSize() const noexcept;
+
+        float GetHeight(std::uint32_t x, std::uint32_t z) const noexcept {
+            return heights[GetTiledIndex(x, z)];
+        }
+
+        // The height of the surface above x and z, which are clamped to the heightfield
+        float GetSurfaceHeight(float x, float z) const noexcept;
+
+        // The upward normal of the triangle above x and z, which are clamped to the heightfield
+        glm::vec3 GetSurfaceNormal(float x, float z) const noexcept;
+
+        // The highest point of the surface over the rectangle from min to max on the xz plane
+        // Only the part of the rectangle over the heightfield is checked, and -infinity is returned if that is empty
+        float GetHighestPoint(float minX, float minZ, float maxX, float maxZ) const noexcept;
+
+        // Tests a sphere against the triangles under its bounds
+        // The normal points from the heightfield towards the sphere
+        CollisionResult CollideSphere(glm::vec3 center, float radius) const noexcept;
+
+        // The distance along the ray to where it first hits the top of the surface, or infinity if it doesn't hit it within maxDistance
+        // Walks the cells under the ray in order, so only the triangles of those cells are tested
+        // Rays starting below the surface don't hit it
+        float Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const noexcept;
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "Collision.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // A group of awake bodies connected by contacts
+    // Contacts with static bodies don't connect islands, so each pile resting on a plane is its own island
+    // Every awake body is in exactly one island, even if it has no contacts
+    struct Island {
+        // Offsets into IslandBuilder's body and contact lists
+        std::uint32_t firstBody;
+        std::uint32_t bodyCount;
+
+        std::uint32_t firstContact;
+        std::uint32_t contactCount;
+    };
+
+    // Splits the bodies and contacts of a tick into islands, using a union-find over the contacts
+    // Islands don't share any awake bodies, so they can be resolved in parallel
+    class IslandBuilder {
+        // Union-find forest over the bodies, where the root of each tree is its smallest body index
+        std::vector<std::uint32_t> parents;
+
+        std::vector<std::uint32_t> bodyIslands;
+
+        std::vector<Island> islands;
+        std::vector<std::uint32_t> islandBodies;
+        std::vector<Contact> islandContacts;
+        // The index of each island contact in the contacts the islands were built from
+        std::vector<std::uint32_t> islandContactIndices;
+
+        std::uint32_t Find(std::uint32_t body) noexcept;
+        void Union(std::uint32_t body1, std::uint32_t body2) noexcept;
+    public:
+        // Islands are ordered by their smallest body index, bodies in ascending order, and contacts in their original order
+        // This only depends on the bodies and contacts, so islands can be resolved in any order with the same result
+        // Contacts must not be between an awake body and a sleeping body
+        // Contacts without an awake body aren't in any island
+        void Build(const BodyStore& bodies, std::span<const Contact> contacts);
+
+        std::span<const Island> GetIslands() const noexcept {
+            return islands;
+        }
+
+        std::span<const std::uint32_t> GetBodies(const Island& island) const noexcept {
+            return std::span{islandBodies}.subspan(island.firstBody, island.bodyCount);
+        }
+
+        std::span<const Contact> GetContacts(const Island& island) const noexcept {
+            return std::span{islandContacts}.subspan(island.firstContact, island.contactCount);
+        }
+
+        // Islands don't share contacts, so each island's contacts can be solved in place in parallel
+        std::span<Contact> GetContacts(const Island& island) noexcept {
+            return std::span{islandContacts}.subspan(island.firstContact, island.contactCount);
+        }
+
+        std::span<const std::uint32_t> GetContactIndices(const Island& island) const noexcept {
+            return std::span{islandContactIndices}.subspan(island.firstContact, island.contactCount);
+        }
+    };
+}
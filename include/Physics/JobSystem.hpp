@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Physics {
+    // A pool of worker threads, each with its own queue of jobs
+    // Workers take jobs from the back of their own queue, and steal from the front of other queues when theirs is empty
+    // A JobSystem can be shared by several PhysicsWorlds
+    class JobSystem {
+        using RangeFunction = std::function<void(std::size_t, std::size_t)>;
+
+        // Shared by all the jobs created by one call to ParallelFor
+        struct JobGroup {
+            const RangeFunction* function;
+            std::atomic<std::size_t> remaining;
+
+            std::mutex exceptionMutex;
+            std::exception_ptr exception;
+        };
+
+        struct Job {
+            JobGroup* group;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        // Queue 0 is used by threads that aren't workers
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::atomic<std::size_t> queuedJobs = 0;
+
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        // If onlyGroup isn't null, only runs a job from that group
+        bool TryRunJob(std::size_t threadIndex, const JobGroup* onlyGroup = nullptr);
+        void WorkerLoop(std::size_t threadIndex);
+    public:
+        // threadCount includes the thread calling ParallelFor, so 1 runs every job on the calling thread
+        // 0 uses one thread per hardware thread
+        explicit JobSystem(std::size_t threadCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        std::size_t GetThreadCount() const noexcept {
+            return queues.size();
+        }
+
+        // Returns a number from 0 to GetThreadCount() - 1 that is unique to each worker thread
+        // Threads that aren't workers of this JobSystem all return 0
+        // While they wait in ParallelFor, they only run jobs from their own call, so each caller's data for index 0 is only used by its own jobs
+        // That lets several threads that aren't workers, such as threads ticking different worlds, share one JobSystem
+        std::size_t GetThreadIndex() const noexcept;
+
+        // Calls function(begin, end) for consecutive ranges covering [0, count), each at most grainSize long
+        // The ranges only depend on count and grainSize, never on the number of threads
+        // The calling thread runs jobs until every range is done, so this can be called from inside a job
+        // If a job throws, the first exception is rethrown after every job has finished
+        void ParallelFor(std::size_t count, std::size_t grainSize, const RangeFunction& function);
+    };
+
+    // Runs on the calling thread if jobSystem is null, without wrapping function in a std::function
+    template<typename Function>
+    void ParallelFor(JobSystem* jobSystem, std::size_t count, std::size_t grainSize, Function&& function) {
+        if(jobSystem) {
+            jobSystem->ParallelFor(count, grainSize, function);
+            return;
+        }
+
+        grainSize = std::max<std::size_t>(grainSize, 1);
+
+        for(std::size_t begin = 0; begin < count; begin += grainSize) {
+            function(begin, std::min(begin + grainSize, count));
+        }
+    }
+}
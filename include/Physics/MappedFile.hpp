@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Physics {
+    // A read only view of a whole file, mapped into memory instead of being read
+    // Pages are only loaded when they are accessed, so large files can be opened without reading them first
+    class MappedFile {
+        const std::byte* data = nullptr;
+        std::size_t size = 0;
+
+#ifdef _WIN32
+        void* file = nullptr;
+        void* mapping = nullptr;
+#endif
+    public:
+        // Throws std::runtime_error if the file can't be opened or mapped
+        explicit MappedFile(const std::filesystem::path& path);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        // Empty for empty files
+        std::span<const std::byte> GetData() const noexcept {
+            return {data, size};
+        }
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "BatchCollisionTest.hpp"
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "JobSystem.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // Runs the narrowphase for the bodies in a BodyStore
+    // Pairs are sorted into buckets by the types of their colliders, and each bucket is tested by a loop specialized for those types
+    // Buckets with batched collision tests are gathered into batches and tested together
+    // Other buckets call Collides directly, so the colliders must be up to date
+    // The buffers are kept between calls to avoid reallocating
+    class Narrowphase {
+        static constexpr std::size_t bucketCount = colliderTypeCount * colliderTypeCount;
+
+        // Indices into pairs, sorted by bucket
+        std::vector<std::uint32_t> sortedPairs;
+        std::array<std::uint32_t, bucketCount + 1> bucketOffsets;
+
+        struct BatchBuffers {
+            SpherePairBatch spheres;
+            CubePairBatch cubes;
+            PlanePairBatch planes;
+
+            BatchResults results;
+        };
+
+        // One for each thread
+        std::vector<BatchBuffers> batchBuffers;
+
+        // One for each pair, so contacts can be added in the same order as the pairs
+        std::vector<CollisionResult> results;
+
+        template<typename T, typename U>
+        void TestBucket(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers);
+
+        void TestSpheres(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers);
+        void TestCubes(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers);
+        void TestPlanes(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers, bool planeFirst);
+
+        using BucketFunction = void (Narrowphase::*)(const BodyStore&, std::span<const IndexPair>, std::span<const std::uint32_t>, BatchBuffers&);
+
+        using BucketTable = std::array<std::array<BucketFunction, colliderTypeCount>, colliderTypeCount>;
+
+        template<typename T, typename... Types>
+        static constexpr std::array<BucketFunction, colliderTypeCount> MakeBucketRow(TypeList<Types...>) noexcept;
+
+        template<typename... Types>
+        static constexpr BucketTable MakeBucketTable(TypeList<Types...> types) noexcept;
+    public:
+        // Appends the contacts in the same order as pairs
+        // If jobSystem isn't null, the pairs are tested in parallel, with the same results
+        void CalculateContacts(const BodyStore& bodies, std::span<const IndexPair> pairs, std::vector<Contact>& contacts, JobSystem* jobSystem = nullptr);
+    };
+}
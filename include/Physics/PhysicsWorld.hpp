@@ -1,26 +1,395 @@
 #pragma once
 
 #include "Collider.hpp"
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "BodyStore.hpp"
+#include "HandleTable.hpp"
+#include "ColliderPool.hpp"
+#include "Narrowphase.hpp"
+#include "ContactEvents.hpp"
+#include "Solver.hpp"
+#include "ContinuousCollision.hpp"
+#include "JobSystem.hpp"
+#include "Island.hpp"
+#include "Profiling.hpp"
+#include "Snapshot.hpp"
+#include "Rollback.hpp"
+#include "Bvh.hpp"
+#include "Queries.hpp"
+#include "TransformSnapshot.hpp"
 
 #include <vector>
+#include <memory>
+#include <functional>
+#include <span>
+#include <filesystem>
+#include <iosfwd>
 
 namespace Physics {
 
+// What TickUntil does when it reaches its substep limit before catching up to the clock
+enum class OverrunPolicy {
+    // Discards the time that wasn't simulated, so the simulation stays behind the clock from then on
+    Drop,
+    // Keeps the backlog, and catches up over the next calls, so the simulation runs slower than the clock until then
+    Slow
+};
+
+// Chooses the tick level of a body from its position, e.g. by its distance to the camera
+using TickLevelFunction = std::function<std::uint8_t(BodyHandle body, glm::vec3 position)>;
+
 class PhysicsWorld {
-    std::vector<Collider*> physicsObjects;
+    BodyStore bodies;
+    HandleTable handles;
+
+    // Colliders created by the world
+    ColliderPools pools;
+
+    // The index of each handle slot's collider in its pool, or BodyHandle::invalidIndex if it isn't owned by the world
+    std::vector<std::uint32_t> poolIndices;
+
+    // Body indices as the broadphase last saw them, mapped to the current ones, while bodies are being removed
+    std::vector<std::uint32_t> broadphaseRemap;
+    // The inverse of broadphaseRemap, with Broadphase::removedIndex for bodies the broadphase hasn't seen
+    std::vector<std::uint32_t> broadphaseIndices;
+    std::size_t broadphaseBodyCount = 0;
+    bool bodiesRemoved = false;
+
+    // Static bodies aren't in the broadphase, which only sees the dynamic bodies, by their index in dynamicBodies
+    // Instead, the bounds of each awake dynamic body are checked against staticTree, which is only rebuilt when static bodies change
+    std::vector<std::uint32_t> dynamicBodies;
+    // The index of each body in dynamicBodies, or Broadphase::removedIndex for static bodies
+    std::vector<std::uint32_t> dynamicIndices;
+    std::vector<AABB> dynamicBounds;
+    std::vector<IndexPair> dynamicPairs;
+    // Maps the dynamic indices the broadphase last saw to the current ones, like broadphaseRemap
+    std::vector<std::uint32_t> dynamicRemap;
+    bool bodyListsDirty = true;
+
+    std::vector<std::uint32_t> staticBodies;
+    std::vector<AABB> staticBounds;
+    Bvh staticTree;
+    bool staticTreeDirty = true;
+    // Incremented whenever a static body is added, removed or moved
+    std::uint64_t staticChanges = 0;
+
+    // The pairs with a static body found by each range of dynamic bodies
+    std::vector<std::vector<IndexPair>> rangeStaticPairs;
+
+    // Splits the bodies into dynamic and static bodies after bodies are added or removed, and remaps the broadphase
+    void UpdateBodyLists();
+
+    // Finds the pairs of dynamic bodies using the broadphase, and the pairs of awake dynamic bodies and static bodies using staticTree
+    void CalculatePairs();
+
+    void AddBody(Collider* collider, BodyHandle handle, std::uint32_t poolIndex);
+
+    template<typename T>
+    BodyHandle CreateInPool(const T& collider);
+
+    // Updates the colliders pointers of every body using a collider from the pool
+    template<typename T>
+    void UpdateColliderPointers(ColliderPool<T>& pool) noexcept;
+
+    template<typename T>
+    void RemoveFromPool(std::uint32_t poolIndex) noexcept;
+
+    // The pool must already have room for the collider
+    template<typename T>
+    void RestoreBody(const BodySnapshot& body);
+
+    BodySnapshot SaveBody(std::uint32_t index) const noexcept;
+
+    // Restores the state that isn't kept by the collider
+    void RestoreBodyState(std::uint32_t index, const BodySnapshot& body) noexcept;
+
+    std::unique_ptr<Broadphase> broadphase = std::make_unique<SweepAndPruneBroadphase>();
+    Narrowphase narrowphase;
+    ContinuousCollision continuousCollision;
+    IslandBuilder islands;
+    ContactTracker contactTracker;
+    ContactSolver solver;
+    SolverSettings solverSettings;
+
+    // Null runs the whole tick on the calling thread
+    std::unique_ptr<JobSystem> ownedJobSystem;
+    JobSystem* jobSystem = nullptr;
+
+    // Reused between ticks to avoid reallocating
+    std::vector<AABB> bounds;
+    std::vector<IndexPair> candidates;
+    std::vector<Contact> contacts;
+
+    // Bodies slower than sleepVelocity for sleepTime seconds are put to sleep, together with the rest of their island
+    bool sleepingEnabled = true;
+    float sleepVelocity = 0.05f;
+    float sleepTime = 0.5f;
+
+    std::size_t awakeBodyCount = 0;
+    std::size_t sleepingBodyCount = 0;
+    std::size_t steppedBodyCount = 0;
 
-    float lastUpdate = 0;
+    // Called for each body after it steps, to choose its tick level from then on
+    TickLevelFunction tickLevelFunction;
+
+    Profiler profiler;
+
+    // Runs one tick, and appends its contact events to the ones from earlier ticks
+    void RunTick();
+
+    // Runs one tick without profiling it as a whole
+    void Step(float deltaTime);
+
+    void UpdateSleep(const Island& island, float deltaTime) noexcept;
+
+    // Steps the bodies that aren't stepping during this tick but have a pair with one that is, so both are at the same time when their contact is solved
+    void CatchUpBodies(float deltaTime) noexcept;
+
+    // Counts the awake, sleeping and stepped bodies
+    void CountBodies() noexcept;
+
+    RollbackBuffer rollback;
+
+    // Built over the bodies' bounds by the first query after they change
+    Bvh queryTree;
+    bool queryTreeDirty = true;
+
+    void UpdateQueryTree();
+
+    // Rays are sphere casts with a radius of 0
+    QueryHit CastClosest(glm::vec3 origin, float radius, glm::vec3 direction, float maxDistance, std::uint32_t layerMask) const noexcept;
+    void CastAll(const Ray& ray, std::vector<QueryHit>& hits) const;
+
+    template<typename Shape>
+    void FindOverlaps(const Shape& shape, std::uint32_t layerMask, std::vector<BodyHandle>& found) const;
+
+    // The results of each range of queries that find several bodies, before they are joined
+    std::vector<std::vector<QueryHit>> rangeHits;
+    std::vector<std::vector<BodyHandle>> rangeBodies;
+
+    // The number of ticks run so far
+    std::uint64_t currentTick = 0;
+
+    // Simulated time, in seconds
+    // Double precision, so it keeps up with the clock in long sessions
+    double lastUpdate = 0;
     float tickRate = 60;
 
+    // Clock time that was discarded by OverrunPolicy::Drop
+    double droppedTime = 0;
+
+    std::size_t maxSubsteps = 8;
+    OverrunPolicy overrunPolicy = OverrunPolicy::Drop;
+
+    double interpolationAlpha = 0;
+
     glm::vec3 gravityVector = {0, -Physics::earthGravity, 0};
 public:
     TimeManagerShim* timeManager;
 
     void Tick();
 
-    void TickUntil();
+    // Ticks per second
+    // Lower rates cost less, but fast bodies need continuous collision to not pass through other bodies
+    void SetTickRate(float rate) noexcept;
+    float GetTickRate() const noexcept;
+
+    // Runs ticks until the next tick would pass timeManager->elapsedTime, up to the substep limit
+    // Returns the number of ticks that were run
+    std::size_t TickUntil();
+
+    // Limits the number of ticks in one call to TickUntil, so a long frame can't cause even longer frames
+    void SetMaxSubsteps(std::size_t substeps) noexcept;
+    void SetOverrunPolicy(OverrunPolicy policy) noexcept;
+
+    // The simulated time, not including time discarded by OverrunPolicy::Drop
+    double GetSimulationTime() const noexcept;
+
+    // The clock time discarded by OverrunPolicy::Drop, so timeManager->elapsedTime - GetDroppedTime() is the time the simulation is catching up to
+    double GetDroppedTime() const noexcept;
+
+    // How far the clock is between the last tick and the next one, from 0 to 1
+    // Renderers can use this to interpolate between the previous and current position of each body
+    double GetInterpolationAlpha() const noexcept;
+
+    // The world copies the collider's state, but collider must outlive the body
+    // The collider's position and velocity are updated after each tick, but changes made to it are not read back
+    // Use the functions below to change a body's state
+    BodyHandle AddPhysicsObject(Collider* collider);
+
+    // Creates a body with a collider owned by the world
+    // Colliders are stored contiguously for each type, so creating and destroying bodies doesn't allocate each time
+    BodyHandle CreateSphere(glm::vec3 position, float size, glm::vec3 velocity = {});
+    BodyHandle CreateCube(glm::vec3 position, glm::vec3 size, glm::vec3 velocity = {});
+    BodyHandle CreatePlane(float height);
+
+    // Copies a collider, which lets other properties like mass be set first
+    BodyHandle Create(const SimplePlaneCollider& collider);
+    BodyHandle Create(const SimpleCubeCollider& collider);
+    BodyHandle Create(const SphereCollider& collider);
+    BodyHandle Create(const HeightfieldCollider& collider);
+
+    // Creates a body from its snapshot, with a new handle and a collider owned by the world
+    // Throws std::invalid_argument if the body's collider type isn't valid, or is a heightfield
+    BodyHandle Create(const BodySnapshot& body);
+
+    // Removes the body in O(1), and frees its collider if it is owned by the world
+    // Colliders added with AddPhysicsObject aren't freed
+    // Throws std::invalid_argument if body isn't valid
+    void Destroy(BodyHandle body);
+
+    // False once the body is destroyed
+    bool IsValid(BodyHandle body) const noexcept;
+
+    // Functions taking a BodyHandle require it to be valid
+
+    const Collider& GetCollider(BodyHandle body) const noexcept;
+
+    glm::vec3 GetPosition(BodyHandle body) const noexcept;
+
+    // Also sets the previous position, so the body isn't interpolated from where it was
+    void SetPosition(BodyHandle body, glm::vec3 position) noexcept;
+
+    // The body's state in the format used by snapshots, so it can be stored outside of the world and created again later
+    BodySnapshot GetBodySnapshot(BodyHandle body) const noexcept;
+
+    // The position before the last tick
+    glm::vec3 GetPreviousPosition(BodyHandle body) const noexcept;
+
+    // Interpolates between the previous and current position using GetInterpolationAlpha
+    glm::vec3 GetInterpolatedPosition(BodyHandle body) const noexcept;
+
+    glm::vec3 GetVelocity(BodyHandle body) const noexcept;
+    void SetVelocity(BodyHandle body, glm::vec3 velocity) noexcept;
+
+    // Changes the body's velocity by impulse / mass, and wakes it
+    // Does nothing to static bodies
+    void ApplyImpulse(BodyHandle body, glm::vec3 impulse) noexcept;
+
+    std::size_t GetBodyCount() const noexcept;
+
+    // Makes room for bodyCount bodies in the body arrays and the buffers used during a tick, so adding them and ticking doesn't reallocate
+    // Collider pools still grow as colliders are created
+    void Reserve(std::size_t bodyCount);
+
+    bool IsAwake(BodyHandle body) const noexcept;
+
+    // Bodies are also woken by SetPosition, SetVelocity, and contacts with awake bodies
+    void Wake(BodyHandle body) noexcept;
+
+    // Disabling sleeping wakes every body
+    void SetSleepingEnabled(bool enabled) noexcept;
+    void SetSleepThreshold(float velocity, float time) noexcept;
+
+    // Counted at the end of each tick, not including static bodies
+    std::size_t GetAwakeBodyCount() const noexcept;
+    std::size_t GetSleepingBodyCount() const noexcept;
+
+    // The bodies that were integrated during the last tick, including bodies caught up by a contact
+    std::size_t GetSteppedBodyCount() const noexcept;
+
+    // Bodies at tick level n are only integrated every 2^n ticks, over every tick since they were last integrated, up to maxTickLevel
+    // Distant bodies can use a higher level, so large worlds cost less per tick
+    // A body that might touch a faster body is caught up to the current tick first, so contacts between levels are solved at the same time
+    // Every body starts at level 0, which steps every tick
+    void SetTickLevel(BodyHandle body, std::uint8_t level) noexcept;
+    std::uint8_t GetTickLevel(BodyHandle body) const noexcept;
+
+    // Replaces the level of each body after it steps, so levels follow the bodies as they move
+    // An empty function keeps the levels set with SetTickLevel
+    void SetTickLevelFunction(TickLevelFunction function);
+
+    // Contacts are solved with sequential impulses, warm started from the impulses of the previous tick
+    // Stacks need more iterations the taller they are, but warm starting lets them stay stable with fewer iterations and at lower tick rates
+    void SetSolverSettings(const SolverSettings& settings) noexcept;
+    const SolverSettings& GetSolverSettings() const noexcept;
+
+    // Saves the state at the start of each of the last ticks ticks, so the world can be rewound to any of them
+    // 0 disables rollback, which is the default
+    void SetRollbackLength(std::size_t ticks);
+    std::size_t GetRollbackLength() const noexcept;
+
+    // The number of ticks run so far, which is also the tick that runs next
+    std::uint64_t GetTick() const noexcept;
+
+    // Restores the state from the start of tick, so the ticks from then on can be run again, usually with different input
+    // The broadphase keeps its state, so running the ticks again doesn't rebuild it
+    // Returns false if tick isn't saved, which happens once it is too old, after bodies are created or destroyed, and after a snapshot is restored
+    bool Rewind(std::uint64_t tick);
+
+    // Queries use a tree over the bodies' bounds, which is rebuilt by the first query after bodies move, so they aren't const
+    // Bodies that a ray or sphere cast starts inside of aren't hit
+    // Everything under a heightfield's surface is inside it, and sphere casts only test the lowest point of the sphere against it
+
+    // The closest hit, or a hit with an invalid body if nothing was hit
+    QueryHit Raycast(const Ray& ray);
+    QueryHit CastSphere(const SphereCast& cast);
+
+    // Batches of queries run in parallel on the world's job system
+    // hits must have an element for each query, which is set to its closest hit
+    void Raycast(std::span<const Ray> rays, std::span<QueryHit> hits);
+    void CastSphere(std::span<const SphereCast> casts, std::span<QueryHit> hits);
+
+    // Finds every hit of each ray, sorted by distance
+    // The hits of rays[i] are from hits[offsets[i]] up to hits[offsets[i + 1]], and offsets has one more element than rays
+    void RaycastAll(std::span<const Ray> rays, std::vector<QueryHit>& hits, std::vector<std::size_t>& offsets);
+
+    // Finds every body overlapping each shape, in the same layout as RaycastAll
+    // Bodies that only touch the shape don't overlap it
+    void Overlap(std::span<const SphereOverlap> spheres, std::vector<BodyHandle>& found, std::vector<std::size_t>& offsets);
+    void Overlap(std::span<const BoxOverlap> boxes, std::vector<BodyHandle>& found, std::vector<std::size_t>& offsets);
+
+    // Writes every body and the world's settings in the format described in Snapshot.hpp
+    // Bodies are written in small chunks, so the snapshot is never held in memory as a whole
+    // Throws std::runtime_error if writing fails, or if the world has a heightfield, since snapshots don't store heights
+    void WriteSnapshot(std::ostream& stream) const;
+    void SaveSnapshot(const std::filesystem::path& path) const;
+
+    // Replaces every body and the world's settings with the ones in the snapshot, and keeps the handles they had
+    // Every restored collider is owned by the world, including ones that were added with AddPhysicsObject
+    // Throws std::runtime_error if data isn't a valid snapshot, in which case the world isn't changed
+    // The touching pairs and their impulses are saved, so the ticks after restoring run and report events like the original
+    // Pairs with a body destroyed since the last tick aren't saved, so their End events aren't reported again
+    void RestoreSnapshot(std::span<const std::byte> data);
+
+    // Maps the file into memory instead of reading it
+    void LoadSnapshot(const std::filesystem::path& path);
+
+    // The broadphase only sees dynamic bodies, since static bodies are kept in a separate tree
+    // Use BruteForceBroadphase to test every pair of dynamic bodies
+    void SetBroadphase(std::unique_ptr<Broadphase> newBroadphase);
+
+    // Runs ticks on threadCount threads, including the one calling Tick
+    // 1 runs ticks on the calling thread only, and 0 uses one thread per hardware thread
+    // The results are the same for any number of threads
+    void SetThreadCount(std::size_t threadCount);
+
+    // Uses a JobSystem that is owned elsewhere, so several worlds can share one pool of threads
+    // jobSystem must outlive the world, and null runs ticks on the calling thread only
+    void SetJobSystem(JobSystem* newJobSystem) noexcept;
+
+    std::size_t GetThreadCount() const noexcept;
+
+    // The contacts found during the last tick
+    // Only valid until the next tick, or until a body is destroyed
+    std::span<const Contact> GetContacts() const noexcept;
+
+    // Copies the position of every body, reusing the snapshot's storage
+    void CopyTransforms(TransformSnapshot& snapshot) const;
+
+    // The contacts that began, persisted and ended during the ticks run by the last call to Tick or TickUntil, in one buffer
+    // Bodies are referred to by handle, so events stay meaningful after bodies are destroyed
+    // Only valid until the next tick, or until Rewind is called
+    std::span<const ContactEvent> GetContactEvents() const noexcept;
+
+    // The islands built during the last tick, with the number of bodies and contacts in each
+    // Only valid until the next tick
+    std::span<const Island> GetIslands() const noexcept;
 
-    void AddPhysicsObject(Collider* collider);
+    // Timers and counters of the last tick, and their min, average and max over the last profileWindowSize ticks
+    // Always 0 if PHYSICS_PROFILING is disabled
+    const PhysicsStats& GetStats() const noexcept;
 };
 
 }
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Physics/config.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Physics {
+    // Set with the PHYSICS_PROFILING CMake option
+    // When disabled, timers and counters compile to nothing and every stat stays at 0
+    constexpr bool profilingEnabled = PHYSICS_PROFILING;
+
+    enum class ProfileTimer : std::uint8_t {
+        Integrate,
+        Broadphase,
+        Narrowphase,
+        Resolve,
+        // The whole tick
+        Tick
+    };
+
+    enum class ProfileCounter : std::uint8_t {
+        Bodies,
+        // Pairs reported by the broadphase
+        CandidatePairs,
+        // Candidate pairs skipped because of their colliders' category, mask and group
+        FilteredPairs,
+        // Pairs passed to the narrowphase, after skipping pairs without a stepping body
+        NarrowphaseCalls,
+        Contacts,
+        // Bodies integrated during the tick, which is fewer than the awake bodies when tick levels are used
+        SteppedBodies
+    };
+
+    constexpr std::size_t profileTimerCount = 5;
+    constexpr std::size_t profileCounterCount = 6;
+
+    // Stats are calculated over this many ticks
+    constexpr std::size_t profileWindowSize = 120;
+
+    const char* GetName(ProfileTimer timer) noexcept;
+    const char* GetName(ProfileCounter counter) noexcept;
+
+    struct RollingStat {
+        double last = 0;
+        double min = 0;
+        double average = 0;
+        double max = 0;
+    };
+
+    // Timers are in seconds
+    struct PhysicsStats {
+        std::array<RollingStat, profileTimerCount> timers;
+        std::array<RollingStat, profileCounterCount> counters;
+
+        // The number of ticks the stats are calculated from, up to profileWindowSize
+        std::size_t tickCount = 0;
+
+        const RollingStat& operator[](ProfileTimer timer) const noexcept {
+            return timers[static_cast<std::size_t>(timer)];
+        }
+
+        const RollingStat& operator[](ProfileCounter counter) const noexcept {
+            return counters[static_cast<std::size_t>(counter)];
+        }
+    };
+
+    // Collects the timers and counters of the current tick, and keeps stats over the last profileWindowSize ticks
+    class Profiler {
+        struct Sample {
+            std::array<double, profileTimerCount> timers{};
+            std::array<double, profileCounterCount> counters{};
+        };
+
+        Sample current;
+
+        // Ring buffer of the last ticks
+        std::vector<Sample> history;
+        std::size_t nextSample = 0;
+
+        PhysicsStats stats;
+
+        void CalculateStats() noexcept;
+    public:
+        void AddTime(ProfileTimer timer, double seconds) noexcept {
+            if constexpr(profilingEnabled) {
+                current.timers[static_cast<std::size_t>(timer)] += seconds;
+            }
+        }
+
+        void SetCounter(ProfileCounter counter, std::size_t value) noexcept {
+            if constexpr(profilingEnabled) {
+                current.counters[static_cast<std::size_t>(counter)] = static_cast<double>(value);
+            }
+        }
+
+        // Adds the current tick to the stats, and starts the next one
+        void EndTick();
+
+        const PhysicsStats& GetStats() const noexcept {
+            return stats;
+        }
+    };
+
+    // Adds the time until the end of the scope to a timer
+    class ScopedTimer {
+#if PHYSICS_PROFILING
+        Profiler& profiler;
+        ProfileTimer timer;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    public:
+        ScopedTimer(Profiler& profiler, ProfileTimer timer) noexcept : profiler{profiler}, timer{timer} {}
+
+        ~ScopedTimer() {
+            profiler.AddTime(timer, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+#else
+    public:
+        ScopedTimer(Profiler&, ProfileTimer) noexcept {}
+#endif
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+}
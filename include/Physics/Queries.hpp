@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "HandleTable.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace Physics {
+    // Queries only find bodies whose collider's category shares a bit with the query's layer mask
+
+    struct Ray {
+        glm::vec3 origin;
+        // Must be normalized
+        glm::vec3 direction;
+        float maxDistance = std::numeric_limits<float>::infinity();
+
+        std::uint32_t layerMask = allLayers;
+    };
+
+    // Moves a sphere along a ray, and finds what it touches first
+    struct SphereCast {
+        glm::vec3 origin;
+        float radius;
+        // Must be normalized
+        glm::vec3 direction;
+        float maxDistance = std::numeric_limits<float>::infinity();
+
+        std::uint32_t layerMask = allLayers;
+    };
+
+    struct SphereOverlap {
+        glm::vec3 center;
+        float radius;
+
+        std::uint32_t layerMask = allLayers;
+    };
+
+    struct BoxOverlap {
+        AABB bounds;
+
+        std::uint32_t layerMask = allLayers;
+    };
+
+    struct QueryHit {
+        // Invalid if nothing was hit
+        BodyHandle body;
+
+        // Along the ray, from its origin
+        float distance = 0;
+
+        // The point on the body's surface that was hit
+        glm::vec3 point = {};
+
+        // Points away from the body
+        glm::vec3 normal = {};
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "ContactEvents.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace Physics {
+    // The state of every body at the start of one tick
+    // Only the arrays that change during a tick are copied, which is 46 bytes per body, and colliders aren't touched
+    struct RollbackFrame {
+        std::uint64_t tick = 0;
+        double lastUpdate = 0;
+
+        // The world's count of changes to static bodies, so rewinding only rebuilds the static tree if a static body moved since
+        std::uint64_t staticChanges = 0;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> previousPositions;
+        std::vector<glm::vec3> velocities;
+        std::vector<std::uint8_t> awakeFlags;
+        std::vector<float> sleepTimes;
+        std::vector<std::uint8_t> tickLevels;
+        std::vector<std::uint32_t> pendingTicks;
+
+        // So running the tick again reports the same contact events
+        std::vector<TouchingPair> touchingPairs;
+    };
+
+    // A ring buffer of the frames of the last few ticks
+    // Frames are reused when the buffer wraps around, so saving doesn't allocate once every frame has been used
+    // Performance targets for release builds, measured by BM_RollbackSave and BM_RewindResimulate:
+    // Saving a frame is a few memcpys, and should stay under 5µs at 1k bodies and 50µs at 10k bodies
+    // Rewinding 8 ticks and running them again should cost no more than running 8 ticks, since the broadphase isn't rebuilt
+    class RollbackBuffer {
+        std::vector<RollbackFrame> frames;
+
+        // The frame that is written next
+        std::size_t nextFrame = 0;
+        std::size_t frameCount = 0;
+    public:
+        // Discards every frame
+        void SetCapacity(std::size_t capacity);
+
+        std::size_t GetCapacity() const noexcept {
+            return frames.size();
+        }
+
+        // Replaces the oldest frame if the buffer is full
+        void Save(const BodyStore& bodies, std::span<const TouchingPair> touchingPairs, std::uint64_t tick, double lastUpdate, std::uint64_t staticChanges);
+
+        // Null if there isn't a frame for tick
+        const RollbackFrame* Find(std::uint64_t tick) const noexcept;
+
+        // Discards frames for tick and the ticks after it
+        void DiscardFrom(std::uint64_t tick) noexcept;
+
+        void Clear() noexcept;
+
+        // bodies must have the same bodies as when frame was saved
+        static void Restore(BodyStore& bodies, const RollbackFrame& frame);
+    };
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Collider.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/vec3.hpp>
+
+namespace Physics {
+    // A snapshot is a SnapshotHeader, followed by a BodySnapshot for each body at bodiesOffset, a HandleSlotSnapshot for each handle slot at slotsOffset,
+    // and a ContactSnapshot for each pair of bodies touching after the last tick at contactsOffset
+    // Every field is little endian, and there is no padding that isn't an explicit field, so a snapshot can be mapped into memory and read in place
+    // Bodies are stored in the order the world stores them, so a restored world runs the same ticks as the original
+
+    constexpr std::array<char, 4> snapshotMagic = {'P', 'H', 'S', 'N'};
+
+    // Incremented whenever the layout of a snapshot changes
+    constexpr std::uint32_t snapshotVersion = 7;
+
+    static_assert(std::endian::native == std::endian::little, "Snapshots are only supported on little endian platforms");
+
+    struct SnapshotHeader {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+
+        // Checked when restoring, in case the version wasn't incremented
+        std::uint32_t headerSize;
+        std::uint32_t bodySize;
+        std::uint32_t slotSize;
+        std::uint32_t contactSize;
+
+        std::uint64_t bodyCount;
+        std::uint64_t slotCount;
+        std::uint64_t contactCount;
+
+        // Byte offsets from the start of the snapshot
+        std::uint64_t bodiesOffset;
+        std::uint64_t slotsOffset;
+        std::uint64_t contactsOffset;
+
+        std::uint64_t tick;
+        double lastUpdate;
+        double droppedTime;
+
+        glm::vec3 gravity;
+        float tickRate;
+
+        float sleepVelocity;
+        float sleepTime;
+        std::uint32_t sleepingEnabled;
+
+        std::uint32_t solverIterations;
+        std::uint32_t warmStarting;
+        float correctionFactor;
+        float allowedPenetration;
+
+        std::uint32_t firstFreeSlot;
+    };
+
+    // Colliders' names aren't stored
+    struct BodySnapshot {
+        enum Flags : std::uint8_t {
+            HasGravity = 1 << 0,
+            IsStatic = 1 << 1,
+            ContinuousCollision = 1 << 2,
+            Awake = 1 << 3
+        };
+
+        glm::vec3 position;
+        glm::vec3 previousPosition;
+        glm::vec3 velocity;
+        glm::vec3 size;
+
+        float mass;
+        float restitution;
+        float sleepTime;
+
+        std::uint32_t handleSlot;
+        std::uint32_t category;
+        std::uint32_t mask;
+        std::int32_t group;
+
+        std::uint32_t pendingTicks;
+
+        ColliderTypeIndex typeIndex;
+        // Flags
+        std::uint8_t flags;
+        std::uint8_t tickLevel;
+        std::uint8_t padding;
+    };
+
+    struct HandleSlotSnapshot {
+        std::uint32_t generation;
+        // The body's index, or the next free slot
+        std::uint32_t index;
+        std::uint32_t used;
+    };
+
+    // A pair of touching bodies, which keeps the solver's impulse so the first tick after restoring is warm started like the original
+    struct ContactSnapshot {
+        // The handle slots of the bodies, with body1Slot less than body2Slot
+        std::uint32_t body1Slot;
+        std::uint32_t body2Slot;
+
+        glm::vec3 normal;
+        float penetration;
+        float impulse;
+    };
+
+    // The snapshot of a body that hasn't been added to a world, with an invalid handle slot
+    BodySnapshot SnapshotCollider(const Collider& collider) noexcept;
+
+    static_assert(std::is_trivially_copyable_v<SnapshotHeader> && sizeof(SnapshotHeader) == 144);
+    static_assert(std::is_trivially_copyable_v<BodySnapshot> && sizeof(BodySnapshot) == 84);
+    static_assert(std::is_trivially_copyable_v<HandleSlotSnapshot> && sizeof(HandleSlotSnapshot) == 12);
+    static_assert(std::is_trivially_copyable_v<ContactSnapshot> && sizeof(ContactSnapshot) == 28);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "Collision.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    struct SolverSettings {
+        // Each iteration applies an impulse to every contact of an island in turn
+        // More iterations make stacks stiffer, at the cost of one pass over the contacts each
+        std::size_t iterations = 8;
+
+        // Starts each contact from the impulse it needed during the previous tick, so stacks converge in fewer iterations
+        bool warmStarting = true;
+
+        // The fraction of each contact's penetration that is removed by moving the bodies apart after the velocities are solved
+        float correctionFactor = 0.4f;
+
+        // Penetration that isn't corrected, so resting bodies keep touching and their contacts stay warm
+        float allowedPenetration = 0.01f;
+    };
+
+    // A sequential impulse solver over the contacts of one island at a time
+    // Each contact's accumulated impulse is kept in Contact::impulse, and never becomes negative, so contacts only push bodies apart
+    // The buffers are kept between calls to avoid reallocating
+    class ContactSolver {
+        struct Buffers {
+            // The relative normal velocity each contact is solved towards, which includes its restitution
+            std::vector<float> targetVelocities;
+
+            // 1 / (inverseMass1 + inverseMass2), or 0 if both bodies are static
+            std::vector<float> normalMasses;
+        };
+
+        // One for each thread
+        std::vector<Buffers> buffers;
+    public:
+        void SetThreadCount(std::size_t threadCount);
+
+        // Changes the velocities and positions of the bodies in contacts, but never of static bodies
+        // Islands that don't share awake bodies can be solved in parallel, with a different threadIndex for each thread
+        void Solve(BodyStore& bodies, std::span<Contact> contacts, const SolverSettings& settings, std::size_t threadIndex = 0);
+    };
+}
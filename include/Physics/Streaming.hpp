@@ -0,0 +1,212 @@
+#pragma once
+
+#include "PhysicsWorld.hpp"
+#include "Snapshot.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace Physics {
+    // A column of the world on the xz plane, cellSize wide along both axes
+    struct CellCoord {
+        std::int32_t x = 0;
+        std::int32_t z = 0;
+
+        bool operator==(const CellCoord&) const noexcept = default;
+    };
+
+    struct CellCoordHash {
+        std::size_t operator()(CellCoord cell) const noexcept;
+    };
+
+    // A stored cell is a CellHeader followed by a BodySnapshot for each body, with the same layout as in a snapshot
+    constexpr std::array<char, 4> cellMagic = {'P', 'H', 'C', 'L'};
+
+    struct CellHeader {
+        std::array<char, 4> magic;
+        // The snapshot version, since the bodies have the same layout
+        std::uint32_t version;
+        std::uint32_t bodySize;
+        std::uint32_t padding;
+    };
+
+    static_assert(std::is_trivially_copyable_v<CellHeader> && sizeof(CellHeader) == 16);
+
+    struct StreamingSettings {
+        float cellSize = 64;
+
+        // Cells closer than this to a focus point are loaded
+        float activationRadius = 128;
+
+        // Cells further than this from every focus point are unloaded
+        // Larger than activationRadius, so a focus point moving back and forth over a cell's edge doesn't keep loading and unloading it
+        float deactivationRadius = 160;
+
+        // The most bodies each call to Update creates, so loading a dense cell is spread over several calls
+        // Unloading isn't limited, since it only copies each body and destroys it, so a cell's bodies are all removed in the Update that unloads it
+        std::size_t maxCreatedPerUpdate = 4096;
+
+        // Inactive cells are written to a file each in this directory, or kept in memory if it is empty
+        std::filesystem::path directory;
+    };
+
+    enum class CellState : std::uint8_t {
+        // The cell's bodies are stored, and aren't in the world
+        Inactive,
+        // The cell is being read, or its bodies are being created
+        Loading,
+        // The cell's bodies are in the world
+        Active
+    };
+
+    // Splits a world that is too big to simulate at once into cells, and only keeps the cells near the focus points in the world
+    // Inactive cells are stored as BodySnapshot records, so they only cost memory when kept in memory, and nothing when written to disk
+    // Cells are read and written on a background thread, so Update only copies bodies in and out of the world, up to a limit per call
+    // Bodies belong to the cell containing their position when their cell is unloaded, so bodies that moved are stored with the cell they moved to
+    // Only bodies added through the streamer are streamed, so planes and other bodies created in the world directly always stay in it
+    class CellStreamer {
+        struct Cell {
+            CellState state = CellState::Inactive;
+
+            // The cell's bodies in the world, while it is loading or active
+            std::vector<BodyHandle> bodies;
+
+            // The number of bodies stored, or being stored, so empty cells aren't read
+            std::size_t storedCount = 0;
+        };
+
+        enum class JobType : std::uint8_t {
+            // Appends the job's bodies to the cell
+            Store,
+            // Reads the cell, and removes it from storage
+            Load
+        };
+
+        struct Job {
+            JobType type;
+            CellCoord cell;
+            std::vector<BodySnapshot> bodies;
+        };
+
+        struct LoadedCell {
+            CellCoord cell;
+            std::vector<BodySnapshot> bodies;
+
+            // The bodies that have been created so far
+            std::size_t createdCount = 0;
+        };
+
+        PhysicsWorld& world;
+        StreamingSettings settings;
+
+        std::unordered_map<CellCoord, Cell, CellCoordHash> cells;
+
+        // The loading and active cells, so Update doesn't visit every stored cell
+        std::vector<CellCoord> residentCells;
+
+        // Bodies to store in inactive cells, which are sent to the background thread together at the end of Update
+        std::unordered_map<CellCoord, std::vector<BodySnapshot>, CellCoordHash> pendingStores;
+
+        // Cells that were read, whose bodies are still being created
+        std::deque<LoadedCell> creating;
+
+        // Reused by Update
+        std::vector<CellCoord> unloading;
+
+        // Stored cells, when settings.directory is empty
+        // Only used by the background thread
+        std::unordered_map<CellCoord, std::vector<BodySnapshot>, CellCoordHash> memoryCells;
+
+        // Guards the members below, which are shared with the background thread
+        std::mutex mutex;
+        std::condition_variable_any jobAdded;
+        std::condition_variable_any jobsFinished;
+
+        // Run in order, so a cell is always stored before it is loaded again
+        std::deque<Job> jobs;
+        std::deque<LoadedCell> loaded;
+        bool running = false;
+
+        // Thrown from the next call to Update or Flush
+        std::exception_ptr exception;
+
+        // Declared last, so it is joined before the members it uses are destroyed
+        std::jthread thread;
+
+        void Run(std::stop_token stopToken);
+
+        void StoreCell(CellCoord cell, std::span<const BodySnapshot> bodies);
+        std::vector<BodySnapshot> LoadCell(CellCoord cell);
+
+        std::filesystem::path GetCellPath(CellCoord cell) const;
+
+        // Counts the bodies of the cells already stored in settings.directory
+        void IndexStoredCells();
+
+        template<typename T>
+        BodyHandle AddCollider(const T& collider);
+
+        // The distance on the xz plane from point to the closest point of the cell
+        float GetDistance(CellCoord cell, glm::vec3 point) const noexcept;
+
+        void Activate(CellCoord cell);
+        void Deactivate(CellCoord cell);
+
+        // Sends pendingStores to the background thread
+        void SubmitStores();
+
+        void CreateLoadedBodies();
+
+        void RethrowException();
+    public:
+        // world must outlive the streamer
+        // Cells stored in settings.directory by an earlier streamer are loaded like the cells this one stores
+        // Throws std::invalid_argument if the settings aren't valid, and std::runtime_error if a stored cell isn't supported
+        explicit CellStreamer(PhysicsWorld& world, const StreamingSettings& settings = {});
+
+        CellStreamer(const CellStreamer&) = delete;
+        CellStreamer& operator=(const CellStreamer&) = delete;
+
+        // Finishes storing the cells that were unloaded, but leaves the bodies of active cells in the world
+        // The bodies of cells that were still loading and haven't been created are stored again
+        ~CellStreamer();
+
+        CellCoord GetCell(glm::vec3 position) const noexcept;
+
+        // Adds a body to the cell containing its position, and creates it in the world if the cell is loading or active
+        // Otherwise the body is only stored, and an invalid handle is returned
+        // Bodies get a new handle each time their cell is loaded
+        BodyHandle Add(const SphereCollider& collider);
+        BodyHandle Add(const SimpleCubeCollider& collider);
+
+        // Loads the cells near any of the focus points and unloads the cells far from all of them
+        // Also creates the bodies of cells that finished loading, up to settings.maxCreatedPerUpdate
+        // Every body of the cells that are unloaded is removed in the same call, so its cost grows with the number of bodies leaving the world
+        // Must be called between ticks, on the thread that ticks the world
+        // Rethrows the first exception thrown while storing or loading a cell
+        void Update(std::span<const glm::vec3> focusPoints);
+
+        // Waits until every cell sent to the background thread has been stored or loaded, so the next Update can create their bodies
+        void Flush();
+
+        CellState GetState(CellCoord cell) const noexcept;
+
+        std::size_t GetActiveCellCount() const noexcept;
+
+        // The bodies of loading and active cells that are in the world
+        std::size_t GetActiveBodyCount() const noexcept;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "HandleTable.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+
+namespace Physics {
+    // Bodies don't rotate yet, so a transform is only a position
+    struct BodyTransform {
+        BodyHandle body;
+
+        glm::vec3 position;
+        // The position before the last tick
+        glm::vec3 previousPosition;
+
+        // alpha is from 0 at previousPosition to 1 at position
+        glm::vec3 Interpolate(float alpha) const noexcept {
+            return glm::mix(previousPosition, position, alpha);
+        }
+    };
+
+    // The transform of every body after one tick, which can be read without touching the world
+    struct TransformSnapshot {
+        using Clock = std::chrono::steady_clock;
+
+        // The number of ticks that had run
+        std::uint64_t tick = 0;
+
+        // When the snapshot was taken, and the length of a tick, so renderers can interpolate towards the next one
+        Clock::time_point time;
+        double tickLength = 0;
+
+        // In the order the world stores its bodies
+        std::vector<BodyTransform> bodies;
+
+        // The index in bodies of each handle slot's body, or BodyHandle::invalidIndex for free slots
+        std::vector<std::uint32_t> slotIndices;
+
+        // Null if the body doesn't exist in the snapshot
+        const BodyTransform* Find(BodyHandle body) const noexcept {
+            if(body.index >= slotIndices.size() || slotIndices[body.index] == BodyHandle::invalidIndex) return nullptr;
+
+            auto& transform = bodies[slotIndices[body.index]];
+
+            return transform.body == body ? &transform : nullptr;
+        }
+
+        // How far now is from time towards the next tick, from 0 to 1
+        float GetInterpolationAlpha(Clock::time_point now) const noexcept {
+            if(tickLength <= 0) return 1;
+
+            auto elapsed = std::chrono::duration<double>(now - time).count();
+
+            return static_cast<float>(std::clamp(elapsed / tickLength, 0.0, 1.0));
+        }
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Physics {
+    // Passes the latest value from one writer thread to one reader thread, without either of them ever waiting
+    // The writer fills the back buffer and swaps it with the middle one, and the reader swaps the middle buffer with the front one when it is newer
+    // Values the reader didn't take in time are overwritten, so the reader only ever sees the latest one
+    template<typename T>
+    class TripleBuffer {
+        static constexpr std::uint8_t indexMask = 0b11;
+
+        // Set in middle when the middle buffer was published after the reader last took it
+        static constexpr std::uint8_t newBit = 0b100;
+
+        std::array<T, 3> buffers;
+
+        // The only state shared by both threads
+        std::atomic<std::uint8_t> middle = 1;
+
+        // Only used by the writer
+        std::uint8_t back = 0;
+
+        // Only used by the reader
+        std::uint8_t front = 2;
+    public:
+        // Only the writer may call these
+
+        // The buffer to fill before calling Publish, which still has the contents of an older value
+        T& GetBack() noexcept {
+            return buffers[back];
+        }
+
+        // Makes the back buffer the latest value
+        // Returns true if the new back buffer holds a value the reader never took
+        bool Publish() noexcept {
+            auto old = middle.exchange(static_cast<std::uint8_t>(back | newBit), std::memory_order_acq_rel);
+
+            back = old & indexMask;
+
+            return (old & newBit) != 0;
+        }
+
+        // Only the reader may call these
+
+        // Takes the latest value if there is a new one, and returns whether there was
+        bool Update() noexcept {
+            if((middle.load(std::memory_order_relaxed) & newBit) == 0) return false;
+
+            front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+
+            return true;
+        }
+
+        // The value taken by the last call to Update
+        const T& GetFront() const noexcept {
+            return buffers[front];
+        }
+    };
+}
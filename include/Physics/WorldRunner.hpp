@@ -0,0 +1,58 @@
+#pragma once
+
+#include "PhysicsWorld.hpp"
+#include "JobSystem.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Physics {
+    // Ticks many independent worlds in parallel on one JobSystem
+    // Each world is ticked on a single thread, so small worlds don't pay for splitting their ticks into jobs
+    // Worlds keep their storage between ticks, so stepping doesn't allocate once each world has reached its largest size
+    class WorldRunner {
+        std::vector<std::unique_ptr<PhysicsWorld>> worlds;
+
+        // How long each world took during the last call to StepAll, in seconds
+        std::vector<double> stepTimes;
+
+        std::unique_ptr<JobSystem> ownedJobSystem;
+        JobSystem* jobSystem = nullptr;
+    public:
+        // threadCount works like PhysicsWorld::SetThreadCount
+        explicit WorldRunner(std::size_t threadCount = 0);
+
+        // Uses a JobSystem that is owned elsewhere, which must outlive the runner
+        explicit WorldRunner(JobSystem* jobSystem) noexcept;
+
+        // Created worlds don't have a JobSystem of their own, so each one runs on the thread that ticks it
+        // Reserves room for bodyCount bodies, so creating them doesn't reallocate
+        PhysicsWorld& CreateWorld(std::size_t bodyCount = 0);
+
+        // Moves the last world into index, like destroying a body
+        void DestroyWorld(std::size_t index) noexcept;
+
+        PhysicsWorld& GetWorld(std::size_t index) noexcept {
+            return *worlds[index];
+        }
+
+        std::size_t GetWorldCount() const noexcept {
+            return worlds.size();
+        }
+
+        std::size_t GetThreadCount() const noexcept;
+
+        // Runs ticks ticks of every world, with fixed steps instead of TickUntil
+        // Worlds are independent, so the results are the same for any number of threads
+        // If a world throws, the first exception is rethrown once every world has stopped
+        void StepAll(std::size_t ticks);
+
+        // How long each world took to run the ticks of the last call to StepAll, in seconds
+        // Each world's own stats are available from PhysicsWorld::GetStats
+        std::span<const double> GetStepTimes() const noexcept {
+            return stepTimes;
+        }
+    };
+}
@@ -0,0 +1,187 @@
+#include "AsyncWorld.hpp"
+
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+namespace Physics {
+    AsyncWorld::AsyncWorld(PhysicsWorld& world, std::size_t commandCapacity) : world{world}, commands{commandCapacity} {}
+
+    AsyncWorld::~AsyncWorld() {
+        if(!thread.joinable()) return;
+
+        thread.request_stop();
+        thread.join();
+
+        world.timeManager = previousTimeManager;
+    }
+
+    void AsyncWorld::Start() {
+        if(thread.joinable()) return;
+
+        previousTimeManager = world.timeManager;
+        world.timeManager = &timeManager;
+
+        running = true;
+
+        thread = std::jthread{[this](std::stop_token stopToken) {
+            Run(stopToken);
+        }};
+    }
+
+    void AsyncWorld::Stop() {
+        if(!thread.joinable()) return;
+
+        thread.request_stop();
+        thread.join();
+
+        // The thread has finished, so this thread can apply and publish in its place
+        ApplyCommands();
+        Publish();
+
+        world.timeManager = previousTimeManager;
+
+        if(exception) {
+            std::rethrow_exception(std::exchange(exception, nullptr));
+        }
+    }
+
+    bool AsyncWorld::IsRunning() const noexcept {
+        return running;
+    }
+
+    void AsyncWorld::Run(std::stop_token stopToken) {
+        using Clock = std::chrono::steady_clock;
+
+        try {
+            auto start = Clock::now();
+
+            // The clock starts where the simulation is, so time that passed before starting isn't caught up on
+            auto startTime = world.GetSimulationTime() + world.GetDroppedTime();
+
+            elapsedTime = startTime;
+
+            ApplyCommands();
+            Publish();
+
+            while(!stopToken.stop_requested()) {
+                auto previousTime = elapsedTime;
+
+                elapsedTime = startTime + std::chrono::duration<double>(Clock::now() - start).count();
+                deltaTime = elapsedTime - previousTime;
+
+                auto commandCount = ApplyCommands();
+                auto tickCount = world.TickUntil();
+
+                if(commandCount != 0 || tickCount != 0) {
+                    Publish();
+                }
+
+                auto nextTick = world.GetSimulationTime() + world.GetDroppedTime() + 1.0 / world.GetTickRate();
+                auto wakeTime = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(nextTick - startTime));
+
+                // Returns early if the thread is stopped
+                std::unique_lock lock{waitMutex};
+                waitCondition.wait_until(lock, stopToken, wakeTime, [] { return false; });
+            }
+        } catch(...) {
+            exception = std::current_exception();
+        }
+
+        running = false;
+    }
+
+    std::size_t AsyncWorld::ApplyCommands() {
+        Command command;
+        std::size_t count = 0;
+
+        for(; count < commands.GetCapacity() && commands.TryPop(command); count++) {
+            std::visit([&]<typename T>(T& value) {
+                if constexpr(std::is_same_v<T, DestroyCommand>) {
+                    if(world.IsValid(value.body)) {
+                        world.Destroy(value.body);
+                    }
+                } else if constexpr(std::is_same_v<T, ImpulseCommand>) {
+                    if(world.IsValid(value.body)) {
+                        world.ApplyImpulse(value.body, value.impulse);
+                    }
+                } else if constexpr(std::is_same_v<T, PositionCommand>) {
+                    if(world.IsValid(value.body)) {
+                        world.SetPosition(value.body, value.position);
+                    }
+                } else if constexpr(std::is_same_v<T, VelocityCommand>) {
+                    if(world.IsValid(value.body)) {
+                        world.SetVelocity(value.body, value.velocity);
+                    }
+                } else {
+                    createdBodies.push_back({value.request, world.Create(value.collider)});
+                }
+            }, command);
+        }
+
+        return count;
+    }
+
+    void AsyncWorld::Publish() {
+        auto& snapshot = snapshots.GetBack();
+
+        world.CopyTransforms(snapshot);
+
+        // The reader never took the snapshot that was in the back buffer, so the bodies created in it are kept for this one
+        if(!backUnread) {
+            snapshot.createdBodies.clear();
+        }
+
+        snapshot.createdBodies.insert(snapshot.createdBodies.end(), createdBodies.begin(), createdBodies.end());
+        createdBodies.clear();
+
+        backUnread = snapshots.Publish();
+    }
+
+    template<typename T>
+    std::optional<std::uint64_t> AsyncWorld::PushCreate(const T& collider) {
+        auto request = nextRequest.fetch_add(1, std::memory_order_relaxed);
+
+        if(!commands.TryPush(CreateCommand<T>{request, collider})) return std::nullopt;
+
+        return request;
+    }
+
+    std::optional<std::uint64_t> AsyncWorld::Create(const SimplePlaneCollider& collider) {
+        return PushCreate(collider);
+    }
+
+    std::optional<std::uint64_t> AsyncWorld::Create(const SimpleCubeCollider& collider) {
+        return PushCreate(collider);
+    }
+
+    std::optional<std::uint64_t> AsyncWorld::Create(const SphereCollider& collider) {
+        return PushCreate(collider);
+    }
+
+    std::optional<std::uint64_t> AsyncWorld::Create(const HeightfieldCollider& collider) {
+        return PushCreate(collider);
+    }
+
+    bool AsyncWorld::Destroy(BodyHandle body) {
+        return commands.TryPush(DestroyCommand{body});
+    }
+
+    bool AsyncWorld::ApplyImpulse(BodyHandle body, glm::vec3 impulse) {
+        return commands.TryPush(ImpulseCommand{body, impulse});
+    }
+
+    bool AsyncWorld::SetPosition(BodyHandle body, glm::vec3 position) {
+        return commands.TryPush(PositionCommand{body, position});
+    }
+
+    bool AsyncWorld::SetVelocity(BodyHandle body, glm::vec3 velocity) {
+        return commands.TryPush(VelocityCommand{body, velocity});
+    }
+
+    const AsyncSnapshot& AsyncWorld::GetSnapshot() noexcept {
+        snapshots.Update();
+
+        return snapshots.GetFront();
+    }
+}
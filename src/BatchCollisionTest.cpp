@@ -0,0 +1,455 @@
+#include "BatchCollisionTest.hpp"
+
+#include "BatchKernels.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PHYSICS_X86_64
+#include <emmintrin.h>
+#endif
+
+#if defined(PHYSICS_AVX2_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace Physics {
+    void BatchVec3::Resize(std::size_t size) {
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+    }
+
+    void SpherePairBatch::Resize(std::size_t size) {
+        position1.Resize(size);
+        size1.resize(size);
+        position2.Resize(size);
+        size2.resize(size);
+    }
+
+    void CubePairBatch::Resize(std::size_t size) {
+        position1.Resize(size);
+        size1.Resize(size);
+        position2.Resize(size);
+        size2.Resize(size);
+    }
+
+    void PlanePairBatch::Resize(std::size_t size) {
+        planeHeight.resize(size);
+        height.resize(size);
+        this->size.resize(size);
+        velocity.resize(size);
+    }
+
+    void BatchResults::Resize(std::size_t size) {
+        collides.resize(size);
+        normal.Resize(size);
+        penetration.resize(size);
+    }
+
+    static bool CpuSupportsAvx2() noexcept {
+#if !defined(PHYSICS_AVX2_KERNELS)
+        return false;
+#elif defined(_MSC_VER)
+        int info[4];
+
+        __cpuid(info, 1);
+
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+
+        // The OS must save the YMM registers on context switches
+        if(!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+
+        __cpuidex(info, 7, 0);
+
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    static SimdLevel DetectSimdLevel() noexcept {
+        if(CpuSupportsAvx2()) return SimdLevel::AVX2;
+
+#ifdef PHYSICS_X86_64
+        // SSE2 is part of x86-64
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    static const SimdLevel supportedSimdLevel = DetectSimdLevel();
+    static std::atomic<SimdLevel> simdLevel = supportedSimdLevel;
+
+    SimdLevel GetSupportedSimdLevel() noexcept {
+        return supportedSimdLevel;
+    }
+
+    SimdLevel GetSimdLevel() noexcept {
+        return simdLevel.load(std::memory_order_relaxed);
+    }
+
+    void SetSimdLevel(SimdLevel level) {
+        if(level > supportedSimdLevel) {
+            throw std::invalid_argument{"SIMD level is not supported by this CPU"};
+        }
+
+        simdLevel.store(level, std::memory_order_relaxed);
+    }
+
+    static Kernels::ResultArgs GetResultArgs(BatchResults& results) noexcept {
+        return {
+            results.collides.data(),
+            results.normal.x.data(), results.normal.y.data(), results.normal.z.data(),
+            results.penetration.data()
+        };
+    }
+
+    void SpheresCollideBatch(const SpherePairBatch& batch, BatchResults& results) {
+        auto count = batch.Size();
+
+        results.Resize(count);
+
+        Kernels::SphereArgs args{
+            batch.position1.x.data(), batch.position1.y.data(), batch.position1.z.data(), batch.size1.data(),
+            batch.position2.x.data(), batch.position2.y.data(), batch.position2.z.data(), batch.size2.data()
+        };
+
+        auto resultArgs = GetResultArgs(results);
+
+        std::size_t tested = 0;
+
+        switch(GetSimdLevel()) {
+#ifdef PHYSICS_AVX2_KERNELS
+        case SimdLevel::AVX2:
+            tested = Kernels::SpheresAvx2(args, resultArgs, count);
+            break;
+#endif
+#ifdef PHYSICS_X86_64
+        case SimdLevel::SSE2:
+            tested = Kernels::SpheresSse2(args, resultArgs, count);
+            break;
+#endif
+        default:
+            break;
+        }
+
+        Kernels::SpheresScalar(args, resultArgs, tested, count - tested);
+    }
+
+    void CubesCollideBatch(const CubePairBatch& batch, BatchResults& results) {
+        auto count = batch.Size();
+
+        results.Resize(count);
+
+        Kernels::CubeArgs args{
+            batch.position1.x.data(), batch.position1.y.data(), batch.position1.z.data(),
+            batch.size1.x.data(), batch.size1.y.data(), batch.size1.z.data(),
+            batch.position2.x.data(), batch.position2.y.data(), batch.position2.z.data(),
+            batch.size2.x.data(), batch.size2.y.data(), batch.size2.z.data()
+        };
+
+        auto resultArgs = GetResultArgs(results);
+
+        std::size_t tested = 0;
+
+        switch(GetSimdLevel()) {
+#ifdef PHYSICS_AVX2_KERNELS
+        case SimdLevel::AVX2:
+            tested = Kernels::CubesAvx2(args, resultArgs, count);
+            break;
+#endif
+#ifdef PHYSICS_X86_64
+        case SimdLevel::SSE2:
+            tested = Kernels::CubesSse2(args, resultArgs, count);
+            break;
+#endif
+        default:
+            break;
+        }
+
+        Kernels::CubesScalar(args, resultArgs, tested, count - tested);
+    }
+
+    void PlanesCollideBatch(const PlanePairBatch& batch, BatchResults& results) {
+        auto count = batch.Size();
+
+        results.Resize(count);
+
+        Kernels::PlaneArgs args{batch.planeHeight.data(), batch.height.data(), batch.size.data(), batch.velocity.data()};
+
+        auto resultArgs = GetResultArgs(results);
+
+        std::size_t tested = 0;
+
+        switch(GetSimdLevel()) {
+#ifdef PHYSICS_AVX2_KERNELS
+        case SimdLevel::AVX2:
+            tested = Kernels::PlanesAvx2(args, resultArgs, count);
+            break;
+#endif
+#ifdef PHYSICS_X86_64
+        case SimdLevel::SSE2:
+            tested = Kernels::PlanesSse2(args, resultArgs, count);
+            break;
+#endif
+        default:
+            break;
+        }
+
+        Kernels::PlanesScalar(args, resultArgs, tested, count - tested);
+    }
+}
+
+// The scalar kernels follow CollisionTest.cpp operation for operation, so they give identical results
+
+namespace Physics::Kernels {
+    void SpheresScalar(const SphereArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept {
+        for(auto i = first; i < first + count; i++) {
+            float vx = args.x1[i] - args.x2[i];
+            float vy = args.y1[i] - args.y2[i];
+            float vz = args.z1[i] - args.z2[i];
+
+            float r = (args.size1[i] + args.size2[i]) / 2;
+            float vv = vx * vx + vy * vy + vz * vz;
+
+            bool collides = vv < r * r;
+            float distance = std::sqrt(vv);
+            bool separated = distance > 0;
+
+            results.collides[i] = collides;
+            results.normalX[i] = collides && separated ? vx / distance : 0;
+            results.normalY[i] = collides ? (separated ? vy / distance : 1) : 0;
+            results.normalZ[i] = collides && separated ? vz / distance : 0;
+            results.penetration[i] = collides ? r - distance : 0;
+        }
+    }
+
+    void CubesScalar(const CubeArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept {
+        auto rangesOverlap = [](float f1, float size1, float f2, float size2) {
+            return f1 - size1 / 2 < f2 + size2 / 2 && f1 + size1 / 2 > f2 - size2 / 2;
+        };
+
+        for(auto i = first; i < first + count; i++) {
+            bool collides = rangesOverlap(args.x1[i], args.sizeX1[i], args.x2[i], args.sizeX2[i]) &&
+                            rangesOverlap(args.y1[i], args.sizeY1[i], args.y2[i], args.sizeY2[i]) &&
+                            rangesOverlap(args.z1[i], args.sizeZ1[i], args.z2[i], args.sizeZ2[i]);
+
+            results.collides[i] = collides;
+            results.normalX[i] = 0;
+            results.normalY[i] = 0;
+            results.normalZ[i] = 0;
+            results.penetration[i] = 0;
+
+            if(!collides) continue;
+
+            float v[3] = {args.x2[i] - args.x1[i], args.y2[i] - args.y1[i], args.z2[i] - args.z1[i]};
+
+            float overlaps[3] = {
+                (args.sizeX1[i] / 2 + args.sizeX2[i] / 2) - std::abs(v[0]),
+                (args.sizeY1[i] / 2 + args.sizeY2[i] / 2) - std::abs(v[1]),
+                (args.sizeZ1[i] / 2 + args.sizeZ2[i] / 2) - std::abs(v[2])
+            };
+
+            float minOverlap = std::fmin(std::fmin(overlaps[0], overlaps[1]), overlaps[2]);
+
+            float* normal[3] = {results.normalX, results.normalY, results.normalZ};
+
+            // Later axes take priority when overlaps are equal, like in CollisionTest.cpp
+            for(int axis = 0; axis < 3; axis++) {
+                if(minOverlap != overlaps[axis]) continue;
+
+                for(int other = 0; other < 3; other++) {
+                    normal[other][i] = 0;
+                }
+
+                normal[axis][i] = v[axis] > 0 ? -1.0f : 1.0f;
+                results.penetration[i] = std::abs(overlaps[axis]);
+            }
+        }
+    }
+
+    void PlanesScalar(const PlaneArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept {
+        for(auto i = first; i < first + count; i++) {
+            float r = args.size[i] / 2;
+            float d = std::abs(args.planeHeight[i] - args.height[i]);
+
+            bool collides = d < r;
+
+            results.collides[i] = collides;
+            results.normalX[i] = 0;
+            results.normalY[i] = 0;
+            results.normalZ[i] = 0;
+            results.penetration[i] = 0;
+
+            if(!collides) continue;
+
+            float velocity = args.velocity[i];
+
+            // Approaching the plane from above
+            if(velocity < 0) {
+                results.penetration[i] = r - (args.height[i] - args.planeHeight[i]);
+                results.normalY[i] = -1;
+            }
+            // Approaching the plane from below
+            if(velocity > 0) {
+                results.penetration[i] = r + (args.height[i] - args.planeHeight[i]);
+                results.normalY[i] = 1;
+            }
+        }
+    }
+}
+
+#ifdef PHYSICS_X86_64
+namespace Physics::Kernels {
+    static void StoreMask(std::uint8_t* collides, int mask) noexcept {
+        for(int lane = 0; lane < 4; lane++) {
+            collides[lane] = (mask >> lane) & 1;
+        }
+    }
+
+    static __m128 Abs(__m128 v) noexcept {
+        return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+    }
+
+    static __m128 Select(__m128 mask, __m128 a, __m128 b) noexcept {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Multiplying by 0.5 is exact, so it gives the same result as dividing by 2
+
+    std::size_t SpheresSse2(const SphereArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm_set1_ps(0.5f);
+
+        std::size_t i = 0;
+
+        for(; i + 4 <= count; i += 4) {
+            auto vx = _mm_sub_ps(_mm_loadu_ps(args.x1 + i), _mm_loadu_ps(args.x2 + i));
+            auto vy = _mm_sub_ps(_mm_loadu_ps(args.y1 + i), _mm_loadu_ps(args.y2 + i));
+            auto vz = _mm_sub_ps(_mm_loadu_ps(args.z1 + i), _mm_loadu_ps(args.z2 + i));
+
+            auto r = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(args.size1 + i), _mm_loadu_ps(args.size2 + i)), half);
+            auto vv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+
+            auto collides = _mm_cmplt_ps(vv, _mm_mul_ps(r, r));
+            auto distance = _mm_sqrt_ps(vv);
+            // Lanes at distance 0 divide by 0, but are replaced
+            auto separated = _mm_cmpgt_ps(distance, _mm_setzero_ps());
+
+            _mm_storeu_ps(results.normalX + i, _mm_and_ps(collides, _mm_and_ps(separated, _mm_div_ps(vx, distance))));
+            _mm_storeu_ps(results.normalY + i, _mm_and_ps(collides, Select(separated, _mm_div_ps(vy, distance), _mm_set1_ps(1))));
+            _mm_storeu_ps(results.normalZ + i, _mm_and_ps(collides, _mm_and_ps(separated, _mm_div_ps(vz, distance))));
+            _mm_storeu_ps(results.penetration + i, _mm_and_ps(collides, _mm_sub_ps(r, distance)));
+
+            StoreMask(results.collides + i, _mm_movemask_ps(collides));
+        }
+
+        return i;
+    }
+
+    std::size_t CubesSse2(const CubeArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm_set1_ps(0.5f);
+        const auto zero = _mm_setzero_ps();
+        const auto one = _mm_set1_ps(1);
+        const auto minusOne = _mm_set1_ps(-1);
+
+        std::size_t i = 0;
+
+        for(; i + 4 <= count; i += 4) {
+            __m128 collides = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            __m128 v[3];
+            __m128 overlaps[3];
+
+            const float* positions1[3] = {args.x1, args.y1, args.z1};
+            const float* positions2[3] = {args.x2, args.y2, args.z2};
+            const float* sizes1[3] = {args.sizeX1, args.sizeY1, args.sizeZ1};
+            const float* sizes2[3] = {args.sizeX2, args.sizeY2, args.sizeZ2};
+
+            for(int axis = 0; axis < 3; axis++) {
+                auto position1 = _mm_loadu_ps(positions1[axis] + i);
+                auto position2 = _mm_loadu_ps(positions2[axis] + i);
+                auto extent1 = _mm_mul_ps(_mm_loadu_ps(sizes1[axis] + i), half);
+                auto extent2 = _mm_mul_ps(_mm_loadu_ps(sizes2[axis] + i), half);
+
+                auto overlap = _mm_and_ps(
+                    _mm_cmplt_ps(_mm_sub_ps(position1, extent1), _mm_add_ps(position2, extent2)),
+                    _mm_cmpgt_ps(_mm_add_ps(position1, extent1), _mm_sub_ps(position2, extent2))
+                );
+
+                collides = _mm_and_ps(collides, overlap);
+
+                v[axis] = _mm_sub_ps(position2, position1);
+                overlaps[axis] = _mm_sub_ps(_mm_add_ps(extent1, extent2), Abs(v[axis]));
+            }
+
+            auto minOverlap = _mm_min_ps(_mm_min_ps(overlaps[0], overlaps[1]), overlaps[2]);
+
+            __m128 isMin[3];
+            __m128 sign[3];
+
+            for(int axis = 0; axis < 3; axis++) {
+                isMin[axis] = _mm_cmpeq_ps(minOverlap, overlaps[axis]);
+                sign[axis] = Select(_mm_cmpgt_ps(v[axis], zero), minusOne, one);
+            }
+
+            // Later axes take priority when overlaps are equal, like in CollisionTest.cpp
+            auto useZ = isMin[2];
+            auto useY = _mm_andnot_ps(useZ, isMin[1]);
+            auto useX = _mm_andnot_ps(_mm_or_ps(useY, useZ), isMin[0]);
+
+            auto penetration = Select(useZ, Abs(overlaps[2]), Select(useY, Abs(overlaps[1]), _mm_and_ps(useX, Abs(overlaps[0]))));
+
+            _mm_storeu_ps(results.normalX + i, _mm_and_ps(collides, _mm_and_ps(useX, sign[0])));
+            _mm_storeu_ps(results.normalY + i, _mm_and_ps(collides, _mm_and_ps(useY, sign[1])));
+            _mm_storeu_ps(results.normalZ + i, _mm_and_ps(collides, _mm_and_ps(useZ, sign[2])));
+            _mm_storeu_ps(results.penetration + i, _mm_and_ps(collides, penetration));
+
+            StoreMask(results.collides + i, _mm_movemask_ps(collides));
+        }
+
+        return i;
+    }
+
+    std::size_t PlanesSse2(const PlaneArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm_set1_ps(0.5f);
+        const auto zero = _mm_setzero_ps();
+        const auto one = _mm_set1_ps(1);
+        const auto minusOne = _mm_set1_ps(-1);
+
+        std::size_t i = 0;
+
+        for(; i + 4 <= count; i += 4) {
+            auto planeHeight = _mm_loadu_ps(args.planeHeight + i);
+            auto height = _mm_loadu_ps(args.height + i);
+            auto velocity = _mm_loadu_ps(args.velocity + i);
+
+            auto r = _mm_mul_ps(_mm_loadu_ps(args.size + i), half);
+            auto d = Abs(_mm_sub_ps(planeHeight, height));
+
+            auto collides = _mm_cmplt_ps(d, r);
+
+            auto fromAbove = _mm_cmplt_ps(velocity, zero);
+            auto fromBelow = _mm_cmpgt_ps(velocity, zero);
+
+            auto offset = _mm_sub_ps(height, planeHeight);
+
+            auto normal = Select(fromAbove, minusOne, _mm_and_ps(fromBelow, one));
+            auto penetration = Select(fromAbove, _mm_sub_ps(r, offset), _mm_and_ps(fromBelow, _mm_add_ps(r, offset)));
+
+            _mm_storeu_ps(results.normalX + i, zero);
+            _mm_storeu_ps(results.normalY + i, _mm_and_ps(collides, normal));
+            _mm_storeu_ps(results.normalZ + i, zero);
+            _mm_storeu_ps(results.penetration + i, _mm_and_ps(collides, penetration));
+
+            StoreMask(results.collides + i, _mm_movemask_ps(collides));
+        }
+
+        return i;
+    }
+}
+#endif
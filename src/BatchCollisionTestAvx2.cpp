@@ -0,0 +1,163 @@
+// This file is compiled with AVX2 enabled, and is only called after checking that the CPU supports it
+// It must only include BatchKernels.hpp and intrinsics, see BatchKernels.hpp
+
+#include "BatchKernels.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace Physics::Kernels {
+    static void StoreMask(std::uint8_t* collides, int mask) noexcept {
+        for(int lane = 0; lane < 8; lane++) {
+            collides[lane] = (mask >> lane) & 1;
+        }
+    }
+
+    static __m256 Abs(__m256 v) noexcept {
+        return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+    }
+
+    static __m256 Select(__m256 mask, __m256 a, __m256 b) noexcept {
+        return _mm256_blendv_ps(b, a, mask);
+    }
+
+    static __m256 LessThan(__m256 a, __m256 b) noexcept {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+
+    static __m256 GreaterThan(__m256 a, __m256 b) noexcept {
+        return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    }
+
+    // Multiplying by 0.5 is exact, so it gives the same result as dividing by 2
+
+    std::size_t SpheresAvx2(const SphereArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm256_set1_ps(0.5f);
+
+        std::size_t i = 0;
+
+        for(; i + 8 <= count; i += 8) {
+            auto vx = _mm256_sub_ps(_mm256_loadu_ps(args.x1 + i), _mm256_loadu_ps(args.x2 + i));
+            auto vy = _mm256_sub_ps(_mm256_loadu_ps(args.y1 + i), _mm256_loadu_ps(args.y2 + i));
+            auto vz = _mm256_sub_ps(_mm256_loadu_ps(args.z1 + i), _mm256_loadu_ps(args.z2 + i));
+
+            auto r = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(args.size1 + i), _mm256_loadu_ps(args.size2 + i)), half);
+            auto vv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz));
+
+            auto collides = LessThan(vv, _mm256_mul_ps(r, r));
+            auto distance = _mm256_sqrt_ps(vv);
+            // Lanes at distance 0 divide by 0, but are replaced
+            auto separated = GreaterThan(distance, _mm256_setzero_ps());
+
+            _mm256_storeu_ps(results.normalX + i, _mm256_and_ps(collides, _mm256_and_ps(separated, _mm256_div_ps(vx, distance))));
+            _mm256_storeu_ps(results.normalY + i, _mm256_and_ps(collides, Select(separated, _mm256_div_ps(vy, distance), _mm256_set1_ps(1))));
+            _mm256_storeu_ps(results.normalZ + i, _mm256_and_ps(collides, _mm256_and_ps(separated, _mm256_div_ps(vz, distance))));
+            _mm256_storeu_ps(results.penetration + i, _mm256_and_ps(collides, _mm256_sub_ps(r, distance)));
+
+            StoreMask(results.collides + i, _mm256_movemask_ps(collides));
+        }
+
+        return i;
+    }
+
+    std::size_t CubesAvx2(const CubeArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm256_set1_ps(0.5f);
+        const auto zero = _mm256_setzero_ps();
+        const auto one = _mm256_set1_ps(1);
+        const auto minusOne = _mm256_set1_ps(-1);
+
+        const float* positions1[3] = {args.x1, args.y1, args.z1};
+        const float* positions2[3] = {args.x2, args.y2, args.z2};
+        const float* sizes1[3] = {args.sizeX1, args.sizeY1, args.sizeZ1};
+        const float* sizes2[3] = {args.sizeX2, args.sizeY2, args.sizeZ2};
+
+        std::size_t i = 0;
+
+        for(; i + 8 <= count; i += 8) {
+            __m256 collides = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            __m256 v[3];
+            __m256 overlaps[3];
+
+            for(int axis = 0; axis < 3; axis++) {
+                auto position1 = _mm256_loadu_ps(positions1[axis] + i);
+                auto position2 = _mm256_loadu_ps(positions2[axis] + i);
+                auto extent1 = _mm256_mul_ps(_mm256_loadu_ps(sizes1[axis] + i), half);
+                auto extent2 = _mm256_mul_ps(_mm256_loadu_ps(sizes2[axis] + i), half);
+
+                auto overlap = _mm256_and_ps(
+                    LessThan(_mm256_sub_ps(position1, extent1), _mm256_add_ps(position2, extent2)),
+                    GreaterThan(_mm256_add_ps(position1, extent1), _mm256_sub_ps(position2, extent2))
+                );
+
+                collides = _mm256_and_ps(collides, overlap);
+
+                v[axis] = _mm256_sub_ps(position2, position1);
+                overlaps[axis] = _mm256_sub_ps(_mm256_add_ps(extent1, extent2), Abs(v[axis]));
+            }
+
+            auto minOverlap = _mm256_min_ps(_mm256_min_ps(overlaps[0], overlaps[1]), overlaps[2]);
+
+            __m256 isMin[3];
+            __m256 sign[3];
+
+            for(int axis = 0; axis < 3; axis++) {
+                isMin[axis] = _mm256_cmp_ps(minOverlap, overlaps[axis], _CMP_EQ_OQ);
+                sign[axis] = Select(GreaterThan(v[axis], zero), minusOne, one);
+            }
+
+            // Later axes take priority when overlaps are equal, like in CollisionTest.cpp
+            auto useZ = isMin[2];
+            auto useY = _mm256_andnot_ps(useZ, isMin[1]);
+            auto useX = _mm256_andnot_ps(_mm256_or_ps(useY, useZ), isMin[0]);
+
+            auto penetration = Select(useZ, Abs(overlaps[2]), Select(useY, Abs(overlaps[1]), _mm256_and_ps(useX, Abs(overlaps[0]))));
+
+            _mm256_storeu_ps(results.normalX + i, _mm256_and_ps(collides, _mm256_and_ps(useX, sign[0])));
+            _mm256_storeu_ps(results.normalY + i, _mm256_and_ps(collides, _mm256_and_ps(useY, sign[1])));
+            _mm256_storeu_ps(results.normalZ + i, _mm256_and_ps(collides, _mm256_and_ps(useZ, sign[2])));
+            _mm256_storeu_ps(results.penetration + i, _mm256_and_ps(collides, penetration));
+
+            StoreMask(results.collides + i, _mm256_movemask_ps(collides));
+        }
+
+        return i;
+    }
+
+    std::size_t PlanesAvx2(const PlaneArgs& args, const ResultArgs& results, std::size_t count) noexcept {
+        const auto half = _mm256_set1_ps(0.5f);
+        const auto zero = _mm256_setzero_ps();
+        const auto one = _mm256_set1_ps(1);
+        const auto minusOne = _mm256_set1_ps(-1);
+
+        std::size_t i = 0;
+
+        for(; i + 8 <= count; i += 8) {
+            auto planeHeight = _mm256_loadu_ps(args.planeHeight + i);
+            auto height = _mm256_loadu_ps(args.height + i);
+            auto velocity = _mm256_loadu_ps(args.velocity + i);
+
+            auto r = _mm256_mul_ps(_mm256_loadu_ps(args.size + i), half);
+            auto d = Abs(_mm256_sub_ps(planeHeight, height));
+
+            auto collides = LessThan(d, r);
+
+            auto fromAbove = LessThan(velocity, zero);
+            auto fromBelow = GreaterThan(velocity, zero);
+
+            auto offset = _mm256_sub_ps(height, planeHeight);
+
+            auto normal = Select(fromAbove, minusOne, _mm256_and_ps(fromBelow, one));
+            auto penetration = Select(fromAbove, _mm256_sub_ps(r, offset), _mm256_and_ps(fromBelow, _mm256_add_ps(r, offset)));
+
+            _mm256_storeu_ps(results.normalX + i, zero);
+            _mm256_storeu_ps(results.normalY + i, _mm256_and_ps(collides, normal));
+            _mm256_storeu_ps(results.normalZ + i, zero);
+            _mm256_storeu_ps(results.penetration + i, _mm256_and_ps(collides, penetration));
+
+            StoreMask(results.collides + i, _mm256_movemask_ps(collides));
+        }
+
+        return i;
+    }
+}
+#endif
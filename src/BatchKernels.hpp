@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw pointer versions of the batches in BatchCollisionTest.hpp
+// The AVX2 kernels are compiled with different flags, so they must not share any inline functions with the rest of the library
+// Otherwise the linker could pick the AVX2 version of a function and use it on CPUs that don't support it
+
+namespace Physics::Kernels {
+    struct SphereArgs {
+        const float* x1;
+        const float* y1;
+        const float* z1;
+        const float* size1;
+
+        const float* x2;
+        const float* y2;
+        const float* z2;
+        const float* size2;
+    };
+
+    struct CubeArgs {
+        const float* x1;
+        const float* y1;
+        const float* z1;
+        const float* sizeX1;
+        const float* sizeY1;
+        const float* sizeZ1;
+
+        const float* x2;
+        const float* y2;
+        const float* z2;
+        const float* sizeX2;
+        const float* sizeY2;
+        const float* sizeZ2;
+    };
+
+    struct PlaneArgs {
+        const float* planeHeight;
+        const float* height;
+        const float* size;
+        const float* velocity;
+    };
+
+    struct ResultArgs {
+        std::uint8_t* collides;
+        float* normalX;
+        float* normalY;
+        float* normalZ;
+        float* penetration;
+    };
+
+    // The SIMD kernels return how many pairs they tested, which is always a multiple of their width
+    // The remaining pairs are left for the scalar kernels
+
+    void SpheresScalar(const SphereArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept;
+    void CubesScalar(const CubeArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept;
+    void PlanesScalar(const PlaneArgs& args, const ResultArgs& results, std::size_t first, std::size_t count) noexcept;
+
+    std::size_t SpheresSse2(const SphereArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+    std::size_t CubesSse2(const CubeArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+    std::size_t PlanesSse2(const PlaneArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+
+    std::size_t SpheresAvx2(const SphereArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+    std::size_t CubesAvx2(const CubeArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+    std::size_t PlanesAvx2(const PlaneArgs& args, const ResultArgs& results, std::size_t count) noexcept;
+}
@@ -0,0 +1,156 @@
+#include "BodyStore.hpp"
+
+#include <glm/common.hpp>
+
+namespace Physics {
+    // Calls function with each array
+    template<typename Function>
+    static void ForEachArray(BodyStore& bodies, Function&& function) {
+        function(bodies.positions);
+        function(bodies.previousPositions);
+        function(bodies.velocities);
+        function(bodies.inverseMasses);
+        function(bodies.restitutions);
+        function(bodies.gravityFlags);
+        function(bodies.awakeFlags);
+        function(bodies.sleepTimes);
+        function(bodies.tickLevels);
+        function(bodies.pendingTicks);
+        function(bodies.stepScales);
+        function(bodies.continuousFlags);
+        function(bodies.categories);
+        function(bodies.masks);
+        function(bodies.groups);
+        function(bodies.extents);
+        function(bodies.sizes);
+        function(bodies.typeIndices);
+        function(bodies.colliders);
+        function(bodies.handleSlots);
+    }
+
+    std::uint32_t BodyStore::Add(Collider* collider, std::uint32_t handleSlot) {
+        auto index = static_cast<std::uint32_t>(Size());
+
+        positions.push_back(collider->position);
+        previousPositions.push_back(collider->position);
+        velocities.push_back(collider->velocity);
+        inverseMasses.push_back(collider->CalculateInverseMass());
+        restitutions.push_back(collider->restitution);
+        gravityFlags.push_back(collider->hasGravity && !collider->isStatic);
+        awakeFlags.push_back(!collider->isStatic);
+        sleepTimes.push_back(0);
+        tickLevels.push_back(0);
+        pendingTicks.push_back(0);
+        stepScales.push_back(0);
+        continuousFlags.push_back(collider->continuousCollision);
+        categories.push_back(collider->category);
+        masks.push_back(collider->mask);
+        groups.push_back(collider->group);
+        extents.push_back(collider->CalculateExtents());
+        sizes.push_back(collider->size);
+        typeIndices.push_back(collider->GetTypeIndex());
+        colliders.push_back(collider);
+        handleSlots.push_back(handleSlot);
+
+        return index;
+    }
+
+    std::uint32_t BodyStore::Remove(std::uint32_t index) noexcept {
+        auto last = static_cast<std::uint32_t>(Size() - 1);
+
+        ForEachArray(*this, [&](auto& values) {
+            values[index] = values[last];
+            values.pop_back();
+        });
+
+        return last;
+    }
+
+    void BodyStore::Reserve(std::size_t count) {
+        ForEachArray(*this, [&](auto& values) {
+            values.reserve(count);
+        });
+    }
+
+    void BodyStore::Clear() noexcept {
+        ForEachArray(*this, [](auto& values) {
+            values.clear();
+        });
+    }
+
+    void BodyStore::Wake(std::uint32_t index) noexcept {
+        if(IsStatic(index) || IsAwake(index)) return;
+
+        awakeFlags[index] = true;
+        sleepTimes[index] = 0;
+    }
+
+    void BodyStore::Sleep(std::uint32_t index) noexcept {
+        awakeFlags[index] = false;
+        pendingTicks[index] = 0;
+        velocities[index] = {};
+
+        WriteBack(index);
+    }
+
+    void BodyStore::SelectSteppingBodies(std::uint64_t tick, std::size_t begin, std::size_t end) noexcept {
+        for(std::size_t i = begin; i < end; i++) {
+            if(!awakeFlags[i]) {
+                stepScales[i] = 0;
+                continue;
+            }
+
+            pendingTicks[i]++;
+
+            auto period = std::uint64_t{1} << tickLevels[i];
+
+            if((tick + 1) % period == 0) {
+                stepScales[i] = static_cast<float>(pendingTicks[i]);
+                pendingTicks[i] = 0;
+            } else {
+                stepScales[i] = 0;
+            }
+        }
+    }
+
+    bool BodyStore::StartStep(std::uint32_t index) noexcept {
+        if(!IsAwake(index) || IsStepping(index)) return false;
+
+        stepScales[index] = static_cast<float>(pendingTicks[index]);
+        pendingTicks[index] = 0;
+
+        return true;
+    }
+
+    void BodyStore::CalculateBounds(std::vector<AABB>& bounds) const {
+        bounds.resize(Size());
+
+        CalculateBounds(bounds, 0, Size());
+    }
+
+    void BodyStore::CalculateBounds(std::span<AABB> bounds, std::size_t begin, std::size_t end) const noexcept {
+        for(std::size_t i = begin; i < end; i++) {
+            bounds[i] = {positions[i] - extents[i], positions[i] + extents[i]};
+
+            if(continuousFlags[i]) {
+                bounds[i].min = glm::min(bounds[i].min, previousPositions[i] - extents[i]);
+                bounds[i].max = glm::max(bounds[i].max, previousPositions[i] + extents[i]);
+            }
+        }
+    }
+
+    void BodyStore::WriteBack(std::uint32_t index) const noexcept {
+        colliders[index]->position = positions[index];
+        colliders[index]->velocity = velocities[index];
+    }
+
+    void BodyStore::WriteBack() const noexcept {
+        WriteBack(0, Size());
+    }
+
+    void BodyStore::WriteBack(std::size_t begin, std::size_t end) const noexcept {
+        for(auto i = begin; i < end; i++) {
+            WriteBack(static_cast<std::uint32_t>(i));
+        }
+    }
+}
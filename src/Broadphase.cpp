@@ -0,0 +1,118 @@
+#include "Broadphase.hpp"
+
+#include <algorithm>
+
+namespace Physics {
+    // Each range of the sweep covers this many entries
+    constexpr std::size_t sweepGrainSize = 1024;
+
+    void BruteForceBroadphase::CalculatePairs(std::span<const AABB> bounds, std::vector<IndexPair>& pairs, JobSystem*) {
+        auto count = static_cast<std::uint32_t>(bounds.size());
+
+        for(std::uint32_t i = 0; i < count; i++) {
+            for(std::uint32_t j = i + 1; j < count; j++) {
+                pairs.push_back({i, j});
+            }
+        }
+    }
+
+    void SweepAndPruneBroadphase::CalculatePairs(std::span<const AABB> bounds, std::vector<IndexPair>& pairs, JobSystem* jobSystem) {
+        // Bodies were removed without calling Remap
+        if(entries.size() > bounds.size()) {
+            Reset();
+        }
+
+        // Entries before this are sorted from the previous call, and the rest are for new bodies
+        auto sortedCount = entries.size();
+
+        if(entries.size() < bounds.size()) {
+            hasEntry.assign(bounds.size(), false);
+
+            for(auto& entry : entries) {
+                hasEntry[entry.index] = true;
+            }
+
+            for(std::uint32_t i = 0; i < bounds.size(); i++) {
+                if(!hasEntry[i]) {
+                    entries.push_back({0, 0, i});
+                }
+            }
+        }
+
+        for(auto& entry : entries) {
+            entry.min = bounds[entry.index].min.x;
+            entry.max = bounds[entry.index].max.x;
+        }
+
+        auto compareMin = [](const Entry& entry1, const Entry& entry2) {
+            return entry1.min < entry2.min;
+        };
+
+        // Insertion sort, since the entries are usually already almost sorted from the previous call
+        for(std::size_t i = 1; i < sortedCount; i++) {
+            auto entry = entries[i];
+
+            auto j = i;
+
+            for(; j > 0 && entries[j - 1].min > entry.min; j--) {
+                entries[j] = entries[j - 1];
+            }
+
+            entries[j] = entry;
+        }
+
+        // Insertion sort is O(n²) for the new entries, since they aren't sorted at all
+        if(sortedCount < entries.size()) {
+            auto middle = entries.begin() + static_cast<std::ptrdiff_t>(sortedCount);
+
+            std::stable_sort(middle, entries.end(), compareMin);
+            std::inplace_merge(entries.begin(), middle, entries.end(), compareMin);
+        }
+
+        rangePairs.resize((entries.size() + sweepGrainSize - 1) / sweepGrainSize);
+
+        ParallelFor(jobSystem, entries.size(), sweepGrainSize, [&](std::size_t begin, std::size_t end) {
+            auto& found = rangePairs[begin / sweepGrainSize];
+
+            found.clear();
+
+            for(auto it = entries.begin() + begin; it != entries.begin() + end; ++it) {
+                for(auto other = it + 1; other != entries.end() && other->min < it->max; ++other) {
+                    if(!bounds[it->index].Overlaps(bounds[other->index])) continue;
+
+                    auto [first, second] = std::minmax(it->index, other->index);
+
+                    found.push_back({first, second});
+                }
+            }
+        });
+
+        auto firstPair = pairs.size();
+
+        for(auto& found : rangePairs) {
+            pairs.insert(pairs.end(), found.begin(), found.end());
+        }
+
+        std::sort(pairs.begin() + firstPair, pairs.end());
+    }
+
+    void SweepAndPruneBroadphase::Reset() noexcept {
+        entries.clear();
+    }
+
+    void SweepAndPruneBroadphase::Remap(std::span<const std::uint32_t> newIndices) {
+        // Entries for bodies added since the last call aren't in newIndices
+        if(entries.size() != newIndices.size()) {
+            Reset();
+            return;
+        }
+
+        std::erase_if(entries, [&](const Entry& entry) {
+            return newIndices[entry.index] == removedIndex;
+        });
+
+        for(auto& entry : entries) {
+            entry.index = newIndices[entry.index];
+        }
+    }
+}
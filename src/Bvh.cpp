@@ -0,0 +1,95 @@
+#include "Bvh.hpp"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Physics {
+    static bool IsBounded(const AABB& box) noexcept {
+        return std::isfinite(box.min.x) && std::isfinite(box.min.y) && std::isfinite(box.min.z) &&
+               std::isfinite(box.max.x) && std::isfinite(box.max.y) && std::isfinite(box.max.z);
+    }
+
+    void Bvh::Build(std::span<const AABB> bounds) {
+        nodes.clear();
+        items.clear();
+        unboundedItems.clear();
+
+        centers.resize(bounds.size());
+
+        for(std::uint32_t i = 0; i < bounds.size(); i++) {
+            if(IsBounded(bounds[i])) {
+                items.push_back(i);
+                centers[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+            } else {
+                unboundedItems.push_back(i);
+            }
+        }
+
+        if(items.empty()) return;
+
+        nodes.push_back({{}, 0, static_cast<std::uint32_t>(items.size())});
+
+        Split(0, bounds);
+    }
+
+    void Bvh::Split(std::uint32_t nodeIndex, std::span<const AABB> bounds) {
+        auto first = nodes[nodeIndex].first;
+        auto count = nodes[nodeIndex].count;
+
+        AABB nodeBounds = bounds[items[first]];
+        AABB centerBounds = {centers[items[first]], centers[items[first]]};
+
+        for(auto i = first + 1; i < first + count; i++) {
+            nodeBounds.min = glm::min(nodeBounds.min, bounds[items[i]].min);
+            nodeBounds.max = glm::max(nodeBounds.max, bounds[items[i]].max);
+
+            centerBounds.min = glm::min(centerBounds.min, centers[items[i]]);
+            centerBounds.max = glm::max(centerBounds.max, centers[items[i]]);
+        }
+
+        nodes[nodeIndex].bounds = nodeBounds;
+
+        if(count <= leafSize) return;
+
+        auto size = centerBounds.max - centerBounds.min;
+        int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+
+        auto begin = items.begin() + first;
+        auto middle = begin + count / 2;
+
+        std::nth_element(begin, middle, begin + count, [&](std::uint32_t item1, std::uint32_t item2) {
+            return centers[item1][axis] < centers[item2][axis];
+        });
+
+        auto firstChild = static_cast<std::uint32_t>(nodes.size());
+
+        nodes[nodeIndex].first = firstChild;
+        nodes[nodeIndex].count = 0;
+
+        nodes.push_back({{}, first, count / 2});
+        nodes.push_back({{}, first + count / 2, count - count / 2});
+
+        Split(firstChild, bounds);
+        Split(firstChild + 1, bounds);
+    }
+
+    bool RayIntersectsAABB(const AABB& box, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance) noexcept {
+        float entry = 0;
+        float exit = maxDistance;
+
+        for(int axis = 0; axis < 3; axis++) {
+            auto distance1 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+            auto distance2 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+
+            // NaN when the ray is parallel to the axis and starts on the box's face, which counts as inside
+            if(std::isnan(distance1) || std::isnan(distance2)) continue;
+
+            entry = std::max(entry, std::min(distance1, distance2));
+            exit = std::min(exit, std::max(distance1, distance2));
+        }
+
+        return entry <= exit;
+    }
+}
@@ -1,6 +1,10 @@
 #include "Collider.hpp"
+#include "CollisionTest.hpp"
+#include "Heightfield.hpp"
 
+#include <array>
 #include <string>
+#include <limits>
 
 #include <fmt/core.h>
 
@@ -23,10 +27,73 @@ namespace Physics {
         return {position + distance, newVelocity};
     }
 
-    Collider::Collider(glm::vec3 position, glm::vec3 size, glm::vec3 velocity) :
-        position{position}, size{size}, velocity{velocity} {}
+    glm::vec3 Collider::CalculateExtents() const noexcept {
+        return size / glm::vec3{2};
+    }
+
+    AABB Collider::CalculateAABB() const noexcept {
+        auto extents = CalculateExtents();
+
+        return {position - extents, position + extents};
+    }
+
+    float Collider::CalculateInverseMass() const noexcept {
+        return isStatic ? 0 : 1 / mass;
+    }
+
+    glm::vec3 SimplePlaneCollider::CalculateExtents() const noexcept {
+        constexpr auto infinity = std::numeric_limits<float>::infinity();
+
+        return {infinity, 0, infinity};
+    }
+
+    // The offset from a heightfield's origin to the center of its bounds
+    static glm::vec3 GetCenterOffset(const Heightfield& heightfield) noexcept {
+        auto size = heightfield.GetSize();
+
+        return {size.x / 2, (heightfield.GetMinHeight() + heightfield.GetMaxHeight()) / 2, size.z / 2};
+    }
+
+    HeightfieldCollider::HeightfieldCollider(glm::vec3 origin, std::shared_ptr<const Heightfield> heightfield) :
+        ColliderCreator{origin, 1, {}}, heightfield{std::move(heightfield)} {
+        if(!this->heightfield) {
+            throw std::invalid_argument{"A heightfield collider needs a heightfield"};
+        }
+
+        position = origin + GetCenterOffset(*this->heightfield);
+        size = this->heightfield->GetSize();
+
+        isStatic = true;
+        hasGravity = false;
+    }
+
+    glm::vec3 HeightfieldCollider::GetOrigin() const noexcept {
+        return position - GetCenterOffset(*heightfield);
+    }
+
+    bool Collider::SupportsCollisionWith(const Collider& other) const noexcept {
+        return supportsCollisionTable[typeIndex][other.typeIndex];
+    }
+
+    CollisionResult Collider::CollidesWith(const Collider& other) const {
+        return collidesTable[other.typeIndex][typeIndex](other, *this);
+    }
+
+    template<typename... Types>
+    static constexpr std::array<const char*, sizeof...(Types)> MakeTypeNames(TypeList<Types...>) noexcept {
+        return {Types::colliderTypeName...};
+    }
+
+    static constexpr auto colliderTypeNames = MakeTypeNames(ColliderTypes{});
+
+    const char* Collider::GetColliderTypeName() const noexcept {
+        return colliderTypeNames[typeIndex];
+    }
+
+    Collider::Collider(ColliderTypeIndex typeIndex, glm::vec3 position, glm::vec3 size, glm::vec3 velocity) :
+        typeIndex{typeIndex}, position{position}, size{size}, velocity{velocity} {}
 
-    Collider::Collider(glm::vec3 position, float size, glm::vec3 velocity) :
-        Collider{position, glm::vec3{size}, velocity} {
+    Collider::Collider(ColliderTypeIndex typeIndex, glm::vec3 position, float size, glm::vec3 velocity) :
+        Collider{typeIndex, position, glm::vec3{size}, velocity} {
     }
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "Collision.hpp"
 
-#include <set>
+#include <vector>
 #include <utility>
 
 #include <glm/glm.hpp>
@@ -9,71 +9,115 @@
 #include <spdlog/spdlog.h>
 
 namespace Physics {
-    static std::set<std::pair<Collider*, Collider*>> CalculatePairs(std::span<Collider*> colliders) {
-        std::set<std::pair<Collider*, Collider*>> pairs;
-
-        spdlog::trace("Calculating colliding pairs for {} colliders", colliders.size());
-
-        for(auto collider1 : colliders) {
-            for(auto collider2 : colliders) {
-                if(collider1 == collider2) continue;
-                if(!collider1->SupportsCollisionWith(*collider2)) continue;
-
-                if(collider1->CollidesWith(*collider2)) {
-                    if(collider1 < collider2) {
-                        pairs.emplace(collider1, collider2);
-                    } else {
-                        pairs.emplace(collider2, collider1);
-                    }
-                }
+    void CalculateContacts(std::span<Collider* const> colliders, std::span<const IndexPair> pairs, std::vector<Contact>& contacts) {
+        [[maybe_unused]] auto firstContact = contacts.size();
+
+        for(auto [first, second] : pairs) {
+            auto collider1 = colliders[first];
+            auto collider2 = colliders[second];
+
+            if(!collider1->SupportsCollisionWith(*collider2)) continue;
+
+            auto result = collider1->CollidesWith(*collider2);
+
+            if(result.collides) {
+                contacts.push_back({collider1, collider2, first, second, result.normal, result.penetration});
             }
         }
 
+        SPDLOG_DEBUG("Found {} colliding pairs", contacts.size() - firstContact);
+    }
+
+    void CalculateContacts(std::span<Collider*> colliders, Broadphase& broadphase, std::vector<Contact>& contacts) {
+        SPDLOG_TRACE("Calculating contacts for {} colliders", colliders.size());
+
+        std::vector<AABB> bounds;
+        bounds.reserve(colliders.size());
+
+        for(auto collider : colliders) {
+            bounds.push_back(collider->CalculateAABB());
+        }
+
+        std::vector<IndexPair> candidates;
 
-        spdlog::info("Found {} colliding pairs", pairs.size());
+        broadphase.CalculatePairs(bounds, candidates);
 
-        return pairs;
+        CalculateContacts(colliders, candidates, contacts);
     }
 
-    static glm::vec3 CalculateImpulse(glm::vec3 relativeVel, glm::vec3 n, float restitution, float mass1, float mass2) {
+    static glm::vec3 CalculateImpulse(glm::vec3 relativeVel, glm::vec3 n, float restitution, float inverseMass1, float inverseMass2) {
         float vel = glm::dot(relativeVel, n);
 
-        if(vel < 0) return {};
+        // Two static bodies can't push each other apart
+        if(vel < 0 || inverseMass1 + inverseMass2 == 0) return {};
 
         float j = -(1 + restitution) * vel;
 
-        j /= 1/mass1 + 1/mass2;
+        j /= inverseMass1 + inverseMass2;
 
         return j * n;
     }
 
-    static void ResolveCollision(std::pair<Collider*, Collider*> pair) {
-        auto [collider1, collider2] = pair;
+    static void ResolveContact(const Contact& contact) {
+        auto [collider1, collider2, index1, index2, n, penetration, accumulatedImpulse] = contact;
 
-        auto result = collider1->CollidesWith(*collider2);
+        SPDLOG_TRACE("Collision between {} and {}", collider1->name, collider2->name);
+        SPDLOG_TRACE("Collision normal: {}, {}, {}", n.x, n.y, n.z);
+        SPDLOG_TRACE("Collision penetration: {}", penetration);
 
-        if(result.collides) {
-            auto n = result.normal;
+        float restitution = std::min(collider1->restitution, collider2->restitution);
 
-            spdlog::trace("Collision between {} and {}", collider1->name, collider2->name);
-            spdlog::trace("Collision normal: {}, {}, {}", n.x, n.y, n.z);
-            spdlog::trace("Collision penetration: {}", result.penetration);
+        auto relativeVel = collider1->velocity - collider2->velocity;
 
-            float restitution = std::min(collider1->restitution, collider2->restitution);
+        auto inverseMass1 = collider1->CalculateInverseMass();
+        auto inverseMass2 = collider2->CalculateInverseMass();
 
-            auto relativeVel = collider1->velocity - collider2->velocity;
+        auto impulse = CalculateImpulse(relativeVel, n, restitution, inverseMass1, inverseMass2);
 
-            auto impulse = CalculateImpulse(relativeVel, n, restitution, collider1->mass, collider2->mass);
+        collider1->velocity += inverseMass1 * impulse;
+        collider2->velocity -= inverseMass2 * impulse;
+    }
+
+    void ResolveContacts(std::span<const Contact> contacts) {
+        std::for_each(contacts.begin(), contacts.end(), ResolveContact);
+    }
+
+    void ResolveContacts(BodyStore& bodies, std::span<const Contact> contacts) {
+        for(auto& contact : contacts) {
+            auto index1 = contact.index1;
+            auto index2 = contact.index2;
+
+            float restitution = std::min(bodies.restitutions[index1], bodies.restitutions[index2]);
+
+            auto relativeVel = bodies.velocities[index1] - bodies.velocities[index2];
 
-            collider1->velocity += 1 / collider1->mass * impulse;
-            collider2->velocity -= 1 / collider2->mass * impulse;
+            auto inverseMass1 = bodies.inverseMasses[index1];
+            auto inverseMass2 = bodies.inverseMasses[index2];
+
+            auto impulse = CalculateImpulse(relativeVel, contact.normal, restitution, inverseMass1, inverseMass2);
+
+            // Static bodies are shared between islands, so they must not be written to while islands are resolved in parallel
+            if(inverseMass1 != 0) {
+                bodies.velocities[index1] += inverseMass1 * impulse;
+            }
+
+            if(inverseMass2 != 0) {
+                bodies.velocities[index2] -= inverseMass2 * impulse;
+            }
         }
     }
 
+    void ResolveCollisions(std::span<Collider*> colliders, Broadphase& broadphase) {
+        std::vector<Contact> contacts;
+
+        CalculateContacts(colliders, broadphase, contacts);
+        ResolveContacts(contacts);
+    }
+
     void ResolveCollisions(std::span<Collider*> colliders) {
-        auto pairs = CalculatePairs(colliders);
+        BruteForceBroadphase broadphase;
 
-        std::for_each(pairs.begin(), pairs.end(), ResolveCollision);
+        ResolveCollisions(colliders, broadphase);
     }
 
     void ApplyVelocity(std::span<Collider*> colliders, glm::vec3 gravityVector, float deltaTime) {
@@ -84,4 +128,54 @@ namespace Physics {
             collider->velocity = velocity;
         }
     }
-}
\ No newline at end of file
+
+    void ApplyVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime) {
+        ApplyVelocity(bodies, gravityVector, deltaTime, 0, bodies.Size());
+    }
+
+    void ApplyVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime, std::size_t begin, std::size_t end) {
+        auto positions = bodies.positions.data();
+        auto velocities = bodies.velocities.data();
+        auto gravityFlags = bodies.gravityFlags.data();
+        auto awakeFlags = bodies.awakeFlags.data();
+
+        // Same as Collider::CalculatePositionAndVelocity, but gravity is applied by multiplying by the gravity flag instead of branching on it
+        // Multiplying by a gravity flag of 0 gives exactly the same result as skipping the acceleration
+        // Sleeping bodies are skipped, so they don't drift
+        for(std::size_t i = begin; i < end; i++) {
+            if(!awakeFlags[i]) continue;
+
+            auto acceleration = gravityVector * static_cast<float>(gravityFlags[i]);
+
+            auto distance = velocities[i] * deltaTime;
+
+            distance += (acceleration * (deltaTime * deltaTime / 2));
+
+            positions[i] += distance;
+            velocities[i] += acceleration * deltaTime;
+        }
+    }
+
+    void ApplyScaledVelocity(BodyStore& bodies, glm::vec3 gravityVector, float deltaTime, std::size_t begin, std::size_t end) {
+        auto positions = bodies.positions.data();
+        auto velocities = bodies.velocities.data();
+        auto gravityFlags = bodies.gravityFlags.data();
+        auto stepScales = bodies.stepScales.data();
+
+        // Sleeping and static bodies, and bodies waiting for their next step, have a step scale of 0 and are skipped
+        // Constant acceleration is integrated exactly, so one long step lands where several short ones would
+        for(std::size_t i = begin; i < end; i++) {
+            if(stepScales[i] == 0) continue;
+
+            auto stepTime = deltaTime * stepScales[i];
+            auto acceleration = gravityVector * static_cast<float>(gravityFlags[i]);
+
+            auto distance = velocities[i] * stepTime;
+
+            distance += (acceleration * (stepTime * stepTime / 2));
+
+            positions[i] += distance;
+            velocities[i] += acceleration * stepTime;
+        }
+    }
+}
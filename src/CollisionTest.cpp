@@ -1,4 +1,5 @@
 #include "CollisionTest.hpp"
+#include "Heightfield.hpp"
 
 #include <glm/geometric.hpp>
 
@@ -30,15 +31,6 @@ namespace Physics {
 #define IMPLEMENT(Type1, Type2) \
     CollisionResult CollidesImpl::operator()(const Type1& collider1, const Type2& collider2)
 
-#define NOTIMPLEMENTED(Type1, Type2) \
-    IMPLEMENT(Type1, Type2) { \
-        throw NotImplementedException{collider1, collider2}; \
-    }
-
-
-
-    NOTIMPLEMENTED(SimplePlaneCollider, SimplePlaneCollider);
-
     IMPLEMENT(SimplePlaneCollider, SimpleCubeCollider) {
         auto planeHeight = collider1.position.y;
         auto height = collider2.position.y;
@@ -142,8 +134,6 @@ namespace Physics {
         return result;
     }
 
-    NOTIMPLEMENTED(SimpleCubeCollider, SphereCollider);
-
     IMPLEMENT(SphereCollider, SphereCollider) {
         auto v = collider1.position - collider2.position;
 
@@ -153,11 +143,42 @@ namespace Physics {
         CollisionResult result{vv < r * r};
 
         if(result.collides) {
-            result.penetration = r - std::sqrt(vv);
+            auto distance = std::sqrt(vv);
 
-            result.normal = v;
+            result.penetration = r - distance;
+
+            // Spheres at the same position are pushed apart vertically
+            result.normal = distance > 0 ? v / distance : glm::vec3{0, 1, 0};
         }
 
         return result;
     }
-}
\ No newline at end of file
+
+    // Cubes are pushed straight up out of the terrain, so they rest on slopes instead of sliding off along the normal
+    IMPLEMENT(HeightfieldCollider, SimpleCubeCollider) {
+        auto& heightfield = collider1.GetHeightfield();
+        auto min = collider2.position - collider2.size / 2.0f - collider1.GetOrigin();
+        auto max = collider2.position + collider2.size / 2.0f - collider1.GetOrigin();
+
+        auto highest = heightfield.GetHighestPoint(min.x, min.z, max.x, max.z);
+
+        // Everything under the surface is inside the terrain, so cubes below it are pushed up too
+        CollisionResult result{highest > min.y};
+
+        if(result.collides) {
+            result.penetration = highest - min.y;
+            result.normal = glm::vec3{0, -1, 0};
+        }
+
+        return result;
+    }
+
+    IMPLEMENT(HeightfieldCollider, SphereCollider) {
+        auto result = collider1.GetHeightfield().CollideSphere(collider2.position - collider1.GetOrigin(), collider2.size.x / 2);
+
+        // CollideSphere's normal points towards the sphere
+        result.normal = -result.normal;
+
+        return result;
+    }
+}
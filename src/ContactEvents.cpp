@@ -0,0 +1,132 @@
+#include "ContactEvents.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace Physics {
+    // Mixes both handles, so pairs in neighbouring slots don't end up in neighbouring buckets
+    static std::uint64_t HashPair(BodyHandle body1, BodyHandle body2) noexcept {
+        auto key = (std::uint64_t{body1.index} << 32 | body2.index) ^ (std::uint64_t{body1.generation} << 32 | body2.generation) * 0x9e3779b97f4a7c15;
+
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccd;
+        key ^= key >> 33;
+
+        return key;
+    }
+
+    std::uint32_t ContactTracker::PairTable::Find(BodyHandle body1, BodyHandle body2) const noexcept {
+        if(slots.empty()) return emptySlot;
+
+        auto mask = slots.size() - 1;
+
+        for(auto slot = HashPair(body1, body2) & mask;; slot = (slot + 1) & mask) {
+            auto index = slots[slot];
+
+            if(index == emptySlot) return emptySlot;
+
+            if(pairs[index].body1 == body1 && pairs[index].body2 == body2) return index;
+        }
+    }
+
+    void ContactTracker::PairTable::Insert(const TouchingPair& pair) noexcept {
+        auto mask = slots.size() - 1;
+        auto slot = HashPair(pair.body1, pair.body2) & mask;
+
+        // Linear probing
+        while(slots[slot] != emptySlot) {
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = static_cast<std::uint32_t>(pairs.size());
+        pairs.push_back(pair);
+    }
+
+    void ContactTracker::PairTable::Reset(std::size_t count) {
+        pairs.clear();
+        pairs.reserve(count);
+
+        // At most half full, so probes stay short
+        slots.assign(std::bit_ceil(std::max<std::size_t>(count * 2, 16)), emptySlot);
+    }
+
+    void ContactTracker::Update(std::span<Contact> contacts, const BodyStore& bodies, const HandleTable& handles) {
+        // Every previous pair may be kept without a contact
+        current.Reset(contacts.size() + previous.pairs.size());
+
+        found.assign(previous.pairs.size(), false);
+
+        firstContactEvent = events.size();
+
+        for(auto& contact : contacts) {
+            TouchingPair pair{
+                handles.GetHandle(bodies.handleSlots[contact.index1]),
+                handles.GetHandle(bodies.handleSlots[contact.index2]),
+                contact.normal,
+                contact.penetration,
+                0
+            };
+
+            // Body indices change when bodies are removed, but handle slots don't
+            if(pair.body2.index < pair.body1.index) {
+                std::swap(pair.body1, pair.body2);
+                pair.normal = -pair.normal;
+            }
+
+            auto index = previous.Find(pair.body1, pair.body2);
+
+            if(index != emptySlot) {
+                found[index] = true;
+
+                contact.impulse = previous.pairs[index].impulse;
+            }
+
+            // Contacts are inserted first and in order, so pair i is always contact i
+            current.Insert(pair);
+
+            events.push_back({index == emptySlot ? ContactEventType::Begin : ContactEventType::Persist, pair});
+        }
+
+        for(std::size_t i = 0; i < previous.pairs.size(); i++) {
+            if(found[i]) continue;
+
+            auto& pair = previous.pairs[i];
+
+            if(handles.Contains(pair.body1) && handles.Contains(pair.body2)) {
+                auto index1 = handles.GetIndex(pair.body1);
+                auto index2 = handles.GetIndex(pair.body2);
+
+                // Neither body moved, so they are still touching
+                if(!bodies.IsStepping(index1) && !bodies.IsStepping(index2)) {
+                    current.Insert(pair);
+                    continue;
+                }
+            }
+
+            events.push_back({ContactEventType::End, pair});
+        }
+
+        std::swap(previous, current);
+    }
+
+    void ContactTracker::StoreImpulses(std::span<const Contact> contacts) noexcept {
+        for(std::size_t i = 0; i < contacts.size(); i++) {
+            previous.pairs[i].impulse = contacts[i].impulse;
+            events[firstContactEvent + i].pair.impulse = contacts[i].impulse;
+        }
+    }
+
+    void ContactTracker::Restore(std::span<const TouchingPair> pairs) {
+        previous.Reset(pairs.size());
+
+        for(auto& pair : pairs) {
+            previous.Insert(pair);
+        }
+    }
+
+    void ContactTracker::Clear() noexcept {
+        previous.pairs.clear();
+        std::ranges::fill(previous.slots, emptySlot);
+    }
+}
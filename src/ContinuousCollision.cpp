@@ -0,0 +1,222 @@
+#include "ContinuousCollision.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Physics {
+    // Sweeps a shape extending halfHeight above and below its center against a horizontal plane
+    static SweepResult SweepHeightPlane(float start, float displacement, float halfHeight, float planeHeight) noexcept {
+        auto distance = start - planeHeight;
+
+        if(std::abs(distance) < halfHeight) return {};
+
+        // The side of the plane the shape starts on
+        float side = distance > 0 ? 1.0f : -1.0f;
+
+        // Moving away from the plane, or along it
+        if(displacement * side >= 0) return {};
+
+        auto time = (side * halfHeight - distance) / displacement;
+
+        if(time > 1) return {};
+
+        return {true, time, {0, side, 0}};
+    }
+
+    SweepResult SweepSpherePlane(glm::vec3 start, glm::vec3 displacement, float radius, float planeHeight) noexcept {
+        return SweepHeightPlane(start.y, displacement.y, radius, planeHeight);
+    }
+
+    SweepResult SweepAABBPlane(const AABB& box, glm::vec3 displacement, float planeHeight) noexcept {
+        auto center = (box.min.y + box.max.y) * 0.5f;
+        auto halfHeight = (box.max.y - box.min.y) * 0.5f;
+
+        return SweepHeightPlane(center, displacement.y, halfHeight, planeHeight);
+    }
+
+    SweepResult SweepSpheres(glm::vec3 start1, glm::vec3 displacement1, float radius1,
+                             glm::vec3 start2, glm::vec3 displacement2, float radius2) noexcept {
+        // Sphere 2 relative to sphere 1, which is treated as stationary
+        auto offset = start2 - start1;
+        auto velocity = displacement2 - displacement1;
+        auto radius = radius1 + radius2;
+
+        // Solves |offset + velocity * t| = radius
+        auto a = glm::dot(velocity, velocity);
+        auto b = 2 * glm::dot(offset, velocity);
+        auto c = glm::dot(offset, offset) - radius * radius;
+
+        if(c < 0 || a == 0) return {};
+
+        auto discriminant = b * b - 4 * a * c;
+
+        if(discriminant < 0) return {};
+
+        auto time = (-b - std::sqrt(discriminant)) / (2 * a);
+
+        if(time < 0 || time > 1) return {};
+
+        return {true, time, glm::normalize(offset + velocity * time)};
+    }
+
+    SweepResult SweepAABBs(const AABB& box1, glm::vec3 displacement1, const AABB& box2, glm::vec3 displacement2) noexcept {
+        constexpr auto infinity = std::numeric_limits<float>::infinity();
+
+        // Box 2 relative to box 1, which is treated as stationary
+        auto velocity = displacement2 - displacement1;
+
+        float entry = -infinity;
+        float exit = infinity;
+        int entryAxis = 0;
+
+        for(int axis = 0; axis < 3; axis++) {
+            float axisEntry;
+            float axisExit;
+
+            if(velocity[axis] == 0) {
+                // Never overlaps on this axis
+                if(box2.max[axis] <= box1.min[axis] || box2.min[axis] >= box1.max[axis]) return {};
+
+                continue;
+            }
+
+            if(velocity[axis] > 0) {
+                axisEntry = (box1.min[axis] - box2.max[axis]) / velocity[axis];
+                axisExit = (box1.max[axis] - box2.min[axis]) / velocity[axis];
+            } else {
+                axisEntry = (box1.max[axis] - box2.min[axis]) / velocity[axis];
+                axisExit = (box1.min[axis] - box2.max[axis]) / velocity[axis];
+            }
+
+            if(axisEntry > entry) {
+                entry = axisEntry;
+                entryAxis = axis;
+            }
+
+            exit = std::min(exit, axisExit);
+        }
+
+        // Already overlapping, separated for the whole movement, or not touching until after it
+        if(entry < 0 || entry >= exit || entry > 1) return {};
+
+        glm::vec3 normal{};
+
+        // Box 2 enters from the side it is moving away from
+        normal[entryAxis] = velocity[entryAxis] > 0 ? -1.0f : 1.0f;
+
+        return {true, entry, normal};
+    }
+
+    SweepResult ContinuousCollision::Sweep(const BodyStore& bodies, IndexPair pair) const noexcept {
+        constexpr auto plane = colliderTypeIndex<SimplePlaneCollider>;
+        constexpr auto cube = colliderTypeIndex<SimpleCubeCollider>;
+        constexpr auto sphere = colliderTypeIndex<SphereCollider>;
+
+        auto [first, second] = pair;
+
+        auto type1 = bodies.typeIndices[first];
+        auto type2 = bodies.typeIndices[second];
+
+        auto start = [&](std::uint32_t body) {
+            return bodies.previousPositions[body];
+        };
+
+        auto displacement = [&](std::uint32_t body) {
+            return bodies.positions[body] - bodies.previousPositions[body];
+        };
+
+        auto startBox = [&](std::uint32_t body) {
+            return AABB{start(body) - bodies.extents[body], start(body) + bodies.extents[body]};
+        };
+
+        if(type1 == sphere && type2 == sphere) {
+            return SweepSpheres(start(first), displacement(first), bodies.extents[first].x,
+                                start(second), displacement(second), bodies.extents[second].x);
+        }
+
+        if(type1 == cube && type2 == cube) {
+            return SweepAABBs(startBox(first), displacement(first), startBox(second), displacement(second));
+        }
+
+        if(type1 == plane || type2 == plane) {
+            auto planeFirst = type1 == plane;
+
+            auto planeBody = planeFirst ? first : second;
+            auto other = planeFirst ? second : first;
+
+            auto planeHeight = bodies.positions[planeBody].y;
+
+            SweepResult result;
+
+            if(bodies.typeIndices[other] == sphere) {
+                result = SweepSpherePlane(start(other), displacement(other), bodies.extents[other].x, planeHeight);
+            } else if(bodies.typeIndices[other] == cube) {
+                result = SweepAABBPlane(startBox(other), displacement(other), planeHeight);
+            }
+
+            // The normal must point from first to second
+            if(!planeFirst) {
+                result.normal = -result.normal;
+            }
+
+            return result;
+        }
+
+        // Not supported by the discrete tests either
+        return {};
+    }
+
+    void ContinuousCollision::CalculateContacts(BodyStore& bodies, std::span<const IndexPair> pairs, std::vector<Contact>& contacts) {
+        if(std::none_of(bodies.continuousFlags.begin(), bodies.continuousFlags.end(), [](std::uint8_t flag) { return flag; })) return;
+
+        impactTimes.resize(bodies.Size(), 1);
+
+        auto discreteContactCount = contacts.size();
+        std::size_t nextContact = 0;
+
+        for(auto pair : pairs) {
+            auto [first, second] = pair;
+
+            if(!bodies.continuousFlags[first] && !bodies.continuousFlags[second]) continue;
+
+            // The discrete contacts are in the same order as the pairs, so they can be skipped while walking the pairs
+            while(nextContact < discreteContactCount && IndexPair{contacts[nextContact].index1, contacts[nextContact].index2} < pair) {
+                nextContact++;
+            }
+
+            if(nextContact < discreteContactCount && IndexPair{contacts[nextContact].index1, contacts[nextContact].index2} == pair) continue;
+
+            auto result = Sweep(bodies, pair);
+
+            if(!result.hits) continue;
+
+            for(auto body : {first, second}) {
+                if(!bodies.continuousFlags[body]) continue;
+
+                if(impactTimes[body] == 1 && result.time < 1) {
+                    hitBodies.push_back(body);
+                }
+
+                impactTimes[body] = std::min(impactTimes[body], result.time);
+            }
+
+            contacts.push_back({bodies.colliders[first], bodies.colliders[second], first, second, result.normal, 0});
+        }
+
+        // Moves each body back to where it first touched something, instead of letting it pass through
+        for(auto body : hitBodies) {
+            auto time = impactTimes[body];
+
+            bodies.positions[body] = glm::mix(bodies.previousPositions[body], bodies.positions[body], time);
+            bodies.WriteBack(body);
+
+            impactTimes[body] = 1;
+        }
+
+        hitBodies.clear();
+    }
+}
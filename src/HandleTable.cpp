@@ -0,0 +1,35 @@
+#include "HandleTable.hpp"
+
+namespace Physics {
+    BodyHandle HandleTable::Create(std::uint32_t index) {
+        std::uint32_t slot;
+
+        if(firstFreeSlot != BodyHandle::invalidIndex) {
+            slot = firstFreeSlot;
+            firstFreeSlot = slots[slot].index;
+        } else {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        slots[slot].index = index;
+        slots[slot].used = true;
+
+        return {slot, slots[slot].generation};
+    }
+
+    void HandleTable::Destroy(BodyHandle handle) noexcept {
+        auto& slot = slots[handle.index];
+
+        slot.generation++;
+        slot.used = false;
+        slot.index = firstFreeSlot;
+
+        firstFreeSlot = handle.index;
+    }
+
+    void HandleTable::Restore(std::span<const Slot> newSlots, std::uint32_t newFirstFreeSlot) {
+        slots.assign(newSlots.begin(), newSlots.end());
+        firstFreeSlot = newFirstFreeSlot;
+    }
+}
@@ -0,0 +1,474 @@
+#include "Heightfield.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace Physics {
+    static std::uint32_t GetTileCount(std::uint32_t count) noexcept {
+        // Rounded up in 64 bits, so counts near the largest std::uint32_t don't wrap around
+        return static_cast<std::uint32_t>((std::uint64_t{count} + Heightfield::tileSize - 1) / Heightfield::tileSize);
+    }
+
+    // Finds the cell containing x and z, and the position in it from 0 to 1 along each axis
+    // The coordinates are clamped to the heightfield
+    struct CellPosition {
+        std::uint32_t x;
+        std::uint32_t z;
+        float u;
+        float v;
+    };
+
+    static CellPosition FindCell(float x, float z, std::uint32_t countX, std::uint32_t countZ, float spacing) noexcept {
+        auto gridX = std::clamp(x / spacing, 0.0f, static_cast<float>(countX - 1));
+        auto gridZ = std::clamp(z / spacing, 0.0f, static_cast<float>(countZ - 1));
+
+        auto cellX = std::min(static_cast<std::uint32_t>(gridX), countX - 2);
+        auto cellZ = std::min(static_cast<std::uint32_t>(gridZ), countZ - 2);
+
+        return {cellX, cellZ, gridX - static_cast<float>(cellX), gridZ - static_cast<float>(cellZ)};
+    }
+
+    // Ericson, Real-Time Collision Detection, 5.1.5
+    static glm::vec3 ClosestPointOnTriangle(glm::vec3 p, glm::vec3 a, glm::vec3 b, glm::vec3 c) noexcept {
+        auto ab = b - a;
+        auto ac = c - a;
+        auto ap = p - a;
+
+        auto d1 = glm::dot(ab, ap);
+        auto d2 = glm::dot(ac, ap);
+        if(d1 <= 0 && d2 <= 0) return a;
+
+        auto bp = p - b;
+        auto d3 = glm::dot(ab, bp);
+        auto d4 = glm::dot(ac, bp);
+        if(d3 >= 0 && d4 <= d3) return b;
+
+        auto vc = d1 * d4 - d3 * d2;
+        if(vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+
+        auto cp = p - c;
+        auto d5 = glm::dot(ab, cp);
+        auto d6 = glm::dot(ac, cp);
+        if(d6 >= 0 && d5 <= d6) return c;
+
+        auto vb = d5 * d2 - d1 * d6;
+        if(vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+
+        auto va = d3 * d6 - d5 * d4;
+        if(va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        auto denominator = 1 / (va + vb + vc);
+
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    // Moller and Trumbore, Fast, Minimum Storage Ray/Triangle Intersection
+    // Only hits the side that cross(b - a, c - a) points to, and returns infinity for a miss
+    static float CastAgainstTriangle(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, glm::vec3 c) noexcept {
+        constexpr auto miss = std::numeric_limits<float>::infinity();
+
+        auto ab = b - a;
+        auto ac = c - a;
+
+        auto p = glm::cross(direction, ac);
+        auto determinant = glm::dot(ab, p);
+
+        // Parallel to the triangle, or hitting its back
+        if(determinant <= 0) return miss;
+
+        auto inverseDeterminant = 1 / determinant;
+
+        auto s = origin - a;
+        auto u = glm::dot(s, p) * inverseDeterminant;
+
+        if(u < 0 || u > 1) return miss;
+
+        auto q = glm::cross(s, ab);
+        auto v = glm::dot(direction, q) * inverseDeterminant;
+
+        if(v < 0 || u + v > 1) return miss;
+
+        auto distance = glm::dot(ac, q) * inverseDeterminant;
+
+        return distance >= 0 ? distance : miss;
+    }
+
+    Heightfield::Heightfield(std::uint32_t countX, std::uint32_t countZ, float spacing, std::span<const float> rowHeights) :
+        countX{countX}, countZ{countZ}, tileCountX{GetTileCount(countX)}, spacing{spacing} {
+        if(countX < 2 || countZ < 2 || countX > maxCount || countZ > maxCount) {
+            throw std::invalid_argument{"A heightfield needs from 2 to maxCount samples along each axis"};
+        }
+
+        if(!(spacing > 0)) {
+            throw std::invalid_argument{"The spacing of a heightfield must be positive"};
+        }
+
+        if(rowHeights.size() != static_cast<std::size_t>(countX) * countZ) {
+            throw std::invalid_argument{"The number of heights doesn't match the size of the heightfield"};
+        }
+
+        ownedHeights.resize(GetStoredCount());
+
+        for(std::uint32_t z = 0; z < countZ; z++) {
+            for(std::uint32_t x = 0; x < countX; x++) {
+                ownedHeights[GetTiledIndex(x, z)] = rowHeights[static_cast<std::size_t>(z) * countX + x];
+            }
+        }
+
+        heights = ownedHeights.data();
+
+        auto [min, max] = std::ranges::minmax(rowHeights);
+        minHeight = min;
+        maxHeight = max;
+    }
+
+    Heightfield::Heightfield(const std::filesystem::path& path) : file{std::make_unique<MappedFile>(path)} {
+        auto data = file->GetData();
+
+        HeightfieldHeader header;
+
+        if(data.size() < sizeof(header)) {
+            throw std::runtime_error{path.string() + " isn't a heightfield"};
+        }
+
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if(header.magic != heightfieldMagic) {
+            throw std::runtime_error{path.string() + " isn't a heightfield"};
+        }
+
+        if(header.version != heightfieldVersion || header.tileSize != tileSize) {
+            throw std::runtime_error{path.string() + " has an unsupported version"};
+        }
+
+        if(header.countX < 2 || header.countZ < 2 || header.countX > maxCount || header.countZ > maxCount || !(header.spacing > 0)) {
+            throw std::runtime_error{path.string() + " has an invalid size"};
+        }
+
+        // Also rejects NaN
+        if(!(header.minHeight <= header.maxHeight)) {
+            throw std::runtime_error{path.string() + " has an invalid height range"};
+        }
+
+        countX = header.countX;
+        countZ = header.countZ;
+        tileCountX = GetTileCount(countX);
+        spacing = header.spacing;
+        minHeight = header.minHeight;
+        maxHeight = header.maxHeight;
+
+        if(data.size() - sizeof(header) != GetStoredCount() * sizeof(float)) {
+            throw std::runtime_error{path.string() + " has the wrong size"};
+        }
+
+        // Mappings are page aligned, and the header is a multiple of the size of a float, so the heights can be used in place
+        heights = reinterpret_cast<const float*>(data.data() + sizeof(header));
+    }
+
+    void Heightfield::Save(const std::filesystem::path& path) const {
+        std::ofstream stream{path, std::ios::binary};
+
+        if(!stream) {
+            throw std::runtime_error{"Could not open " + path.string()};
+        }
+
+        HeightfieldHeader header{heightfieldMagic, heightfieldVersion, countX, countZ, tileSize, spacing, minHeight, maxHeight};
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(heights), static_cast<std::streamsize>(GetStoredCount() * sizeof(float)));
+
+        if(!stream) {
+            throw std::runtime_error{"Could not write " + path.string()};
+        }
+    }
+
+    std::size_t Heightfield::GetStoredCount() const noexcept {
+        return static_cast<std::size_t>(tileCountX) * GetTileCount(countZ) * tileSize * tileSize;
+    }
+
+    glm::vec3 Heightfield::GetSize() const noexcept {
+        return {static_cast<float>(countX - 1) * spacing, maxHeight - minHeight, static_cast<float>(countZ - 1) * spacing};
+    }
+
+    std::pair<std::uint32_t, std::uint32_t> Heightfield::GetCellRange(float min, float max, std::uint32_t count) const noexcept {
+        auto lastCell = static_cast<float>(count - 2);
+
+        if(max < 0 || min > static_cast<float>(count - 1) * spacing) return {1, 0};
+
+        auto first = std::clamp(std::floor(min / spacing), 0.0f, lastCell);
+        auto last = std::clamp(std::floor(max / spacing), 0.0f, lastCell);
+
+        return {static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(last)};
+    }
+
+    float Heightfield::GetSurfaceHeight(float x, float z) const noexcept {
+        auto [cellX, cellZ, u, v] = FindCell(x, z, countX, countZ, spacing);
+
+        auto h00 = GetHeight(cellX, cellZ);
+        auto h11 = GetHeight(cellX + 1, cellZ + 1);
+
+        if(u >= v) {
+            auto h10 = GetHeight(cellX + 1, cellZ);
+
+            return h00 + (h10 - h00) * u + (h11 - h10) * v;
+        }
+
+        auto h01 = GetHeight(cellX, cellZ + 1);
+
+        return h00 + (h11 - h01) * u + (h01 - h00) * v;
+    }
+
+    glm::vec3 Heightfield::GetSurfaceNormal(float x, float z) const noexcept {
+        auto [cellX, cellZ, u, v] = FindCell(x, z, countX, countZ, spacing);
+
+        auto h00 = GetHeight(cellX, cellZ);
+        auto h11 = GetHeight(cellX + 1, cellZ + 1);
+
+        // The change in height over one cell along x and z
+        float slopeX;
+        float slopeZ;
+
+        if(u >= v) {
+            auto h10 = GetHeight(cellX + 1, cellZ);
+
+            slopeX = h10 - h00;
+            slopeZ = h11 - h10;
+        } else {
+            auto h01 = GetHeight(cellX, cellZ + 1);
+
+            slopeX = h11 - h01;
+            slopeZ = h01 - h00;
+        }
+
+        return glm::normalize(glm::vec3{-slopeX, spacing, -slopeZ});
+    }
+
+    float Heightfield::GetHighestPoint(float minX, float minZ, float maxX, float maxZ) const noexcept {
+        auto size = GetSize();
+
+        minX = std::max(minX, 0.0f);
+        minZ = std::max(minZ, 0.0f);
+        maxX = std::min(maxX, size.x);
+        maxZ = std::min(maxZ, size.z);
+
+        auto highest = -std::numeric_limits<float>::infinity();
+
+        if(minX > maxX || minZ > maxZ) return highest;
+
+        auto sample = [&](float x, float z) {
+            highest = std::max(highest, GetSurfaceHeight(x, z));
+        };
+
+        // The surface is flat over each triangle, so its highest point over the rectangle is at a corner of the rectangle,
+        // a sample inside it, or where the rectangle's edges cross the edges of the triangles
+        sample(minX, minZ);
+        sample(maxX, minZ);
+        sample(minX, maxZ);
+        sample(maxX, maxZ);
+
+        auto [firstX, lastX] = GetCellRange(minX, maxX, countX);
+        auto [firstZ, lastZ] = GetCellRange(minZ, maxZ, countZ);
+
+        for(auto x = firstX; x <= lastX + 1; x++) {
+            auto lineX = static_cast<float>(x) * spacing;
+
+            if(lineX < minX || lineX > maxX) continue;
+
+            sample(lineX, minZ);
+            sample(lineX, maxZ);
+
+            for(auto z = firstZ; z <= lastZ + 1; z++) {
+                auto lineZ = static_cast<float>(z) * spacing;
+
+                if(lineZ >= minZ && lineZ <= maxZ) {
+                    highest = std::max(highest, GetHeight(x, z));
+                }
+            }
+        }
+
+        for(auto z = firstZ; z <= lastZ + 1; z++) {
+            auto lineZ = static_cast<float>(z) * spacing;
+
+            if(lineZ < minZ || lineZ > maxZ) continue;
+
+            sample(minX, lineZ);
+            sample(maxX, lineZ);
+        }
+
+        // The diagonal of the cell at x and z is the line where x - z = (cellX - cellZ) * spacing
+        for(auto x = firstX; x <= lastX; x++) {
+            for(auto z = firstZ; z <= lastZ; z++) {
+                auto cellMinX = static_cast<float>(x) * spacing;
+                auto cellMinZ = static_cast<float>(z) * spacing;
+                auto offset = cellMinX - cellMinZ;
+
+                auto crossing = [&](float crossX, float crossZ) {
+                    if(crossX >= std::max(minX, cellMinX) && crossX <= std::min(maxX, cellMinX + spacing) &&
+                       crossZ >= std::max(minZ, cellMinZ) && crossZ <= std::min(maxZ, cellMinZ + spacing)) {
+                        sample(crossX, crossZ);
+                    }
+                };
+
+                crossing(minZ + offset, minZ);
+                crossing(maxZ + offset, maxZ);
+                crossing(minX, minX - offset);
+                crossing(maxX, maxX - offset);
+            }
+        }
+
+        return highest;
+    }
+
+    CollisionResult Heightfield::CollideSphere(glm::vec3 center, float radius) const noexcept {
+        CollisionResult result{false};
+
+        if(center.y - radius >= maxHeight) return result;
+
+        auto size = GetSize();
+
+        // A center below the surface is pushed out along the normal of the triangle above it
+        // The closest point can't be used, since the sphere would be pushed out of the bottom of a thin surface
+        if(center.x >= 0 && center.x <= size.x && center.z >= 0 && center.z <= size.z) {
+            auto surface = GetSurfaceHeight(center.x, center.z);
+
+            if(center.y < surface) {
+                auto normal = GetSurfaceNormal(center.x, center.z);
+
+                result.collides = true;
+                result.normal = normal;
+                result.penetration = (surface - center.y) * normal.y + radius;
+
+                return result;
+            }
+        }
+
+        auto [firstX, lastX] = GetCellRange(center.x - radius, center.x + radius, countX);
+        auto [firstZ, lastZ] = GetCellRange(center.z - radius, center.z + radius, countZ);
+
+        auto closestDistance = radius * radius;
+        glm::vec3 closest{};
+
+        auto point = [&](std::uint32_t x, std::uint32_t z) {
+            return glm::vec3{static_cast<float>(x) * spacing, GetHeight(x, z), static_cast<float>(z) * spacing};
+        };
+
+        auto testTriangle = [&](glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+            auto candidate = ClosestPointOnTriangle(center, a, b, c);
+            auto offset = center - candidate;
+            auto distance = glm::dot(offset, offset);
+
+            if(distance < closestDistance) {
+                closestDistance = distance;
+                closest = candidate;
+                result.collides = true;
+            }
+        };
+
+        for(auto z = firstZ; z <= lastZ; z++) {
+            for(auto x = firstX; x <= lastX; x++) {
+                auto p00 = point(x, z);
+                auto p11 = point(x + 1, z + 1);
+
+                testTriangle(p00, point(x + 1, z), p11);
+                testTriangle(p00, p11, point(x, z + 1));
+            }
+        }
+
+        if(result.collides) {
+            auto distance = std::sqrt(closestDistance);
+
+            result.penetration = radius - distance;
+            result.normal = distance > 0 ? (center - closest) / distance : GetSurfaceNormal(center.x, center.z);
+        }
+
+        return result;
+    }
+
+    float Heightfield::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const noexcept {
+        constexpr auto miss = std::numeric_limits<float>::infinity();
+
+        auto size = GetSize();
+
+        glm::vec3 min{0, minHeight, 0};
+        glm::vec3 max{size.x, maxHeight, size.z};
+
+        if(origin.x >= 0 && origin.x <= size.x && origin.z >= 0 && origin.z <= size.z && origin.y < GetSurfaceHeight(origin.x, origin.z)) return miss;
+
+        // Clips the ray to the bounds, so the walk starts at the first cell the ray reaches
+        float entry = 0;
+        float exit = maxDistance;
+
+        for(int axis = 0; axis < 3; axis++) {
+            if(direction[axis] == 0) {
+                if(origin[axis] < min[axis] || origin[axis] > max[axis]) return miss;
+
+                continue;
+            }
+
+            auto distance1 = (min[axis] - origin[axis]) / direction[axis];
+            auto distance2 = (max[axis] - origin[axis]) / direction[axis];
+
+            entry = std::max(entry, std::min(distance1, distance2));
+            exit = std::min(exit, std::max(distance1, distance2));
+        }
+
+        if(entry > exit) return miss;
+
+        auto start = origin + direction * entry;
+
+        auto cellX = static_cast<std::int64_t>(std::clamp(std::floor(start.x / spacing), 0.0f, static_cast<float>(countX - 2)));
+        auto cellZ = static_cast<std::int64_t>(std::clamp(std::floor(start.z / spacing), 0.0f, static_cast<float>(countZ - 2)));
+
+        // The distance along the ray to the next cell along x and z, and between cells along each
+        auto next = [&](std::int64_t cell, float originComponent, float directionComponent) {
+            if(directionComponent == 0) return miss;
+
+            auto line = static_cast<float>(directionComponent > 0 ? cell + 1 : cell) * spacing;
+
+            return (line - originComponent) / directionComponent;
+        };
+
+        auto nextX = next(cellX, origin.x, direction.x);
+        auto nextZ = next(cellZ, origin.z, direction.z);
+
+        auto stepX = direction.x > 0 ? 1 : -1;
+        auto stepZ = direction.z > 0 ? 1 : -1;
+
+        auto deltaX = spacing / std::abs(direction.x);
+        auto deltaZ = spacing / std::abs(direction.z);
+
+        auto point = [&](std::int64_t x, std::int64_t z) {
+            return glm::vec3{static_cast<float>(x) * spacing, GetHeight(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(z)), static_cast<float>(z) * spacing};
+        };
+
+        for(;;) {
+            auto p00 = point(cellX, cellZ);
+            auto p11 = point(cellX + 1, cellZ + 1);
+
+            // The triangles of a cell are inside it, so the first cell with a hit has the closest hit
+            auto distance = std::min(CastAgainstTriangle(origin, direction, p00, p11, point(cellX + 1, cellZ)), CastAgainstTriangle(origin, direction, p00, point(cellX, cellZ + 1), p11));
+
+            if(distance <= exit) return distance;
+
+            // Leaves the bounds before reaching the next cell
+            if(std::min(nextX, nextZ) > exit) return miss;
+
+            if(nextX < nextZ) {
+                cellX += stepX;
+                nextX += deltaX;
+            } else {
+                cellZ += stepZ;
+                nextZ += deltaZ;
+            }
+
+            if(cellX < 0 || cellX > countX - 2 || cellZ < 0 || cellZ > countZ - 2) return miss;
+        }
+    }
+}
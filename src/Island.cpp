@@ -0,0 +1,122 @@
+#include "Island.hpp"
+
+#include <limits>
+
+namespace Physics {
+    constexpr auto noIsland = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t IslandBuilder::Find(std::uint32_t body) noexcept {
+        auto root = body;
+
+        while(parents[root] != root) {
+            root = parents[root];
+        }
+
+        // Path compression
+        while(parents[body] != root) {
+            auto parent = parents[body];
+            parents[body] = root;
+            body = parent;
+        }
+
+        return root;
+    }
+
+    void IslandBuilder::Union(std::uint32_t body1, std::uint32_t body2) noexcept {
+        auto root1 = Find(body1);
+        auto root2 = Find(body2);
+
+        if(root1 < root2) {
+            parents[root2] = root1;
+        } else {
+            parents[root1] = root2;
+        }
+    }
+
+    void IslandBuilder::Build(const BodyStore& bodies, std::span<const Contact> contacts) {
+        auto bodyCount = static_cast<std::uint32_t>(bodies.Size());
+
+        parents.resize(bodyCount);
+
+        for(std::uint32_t i = 0; i < bodyCount; i++) {
+            parents[i] = i;
+        }
+
+        for(auto& contact : contacts) {
+            if(!bodies.IsAwake(contact.index1) || !bodies.IsAwake(contact.index2)) continue;
+
+            Union(contact.index1, contact.index2);
+        }
+
+        // Number the islands in order of their smallest body, and count their bodies
+        islands.clear();
+        bodyIslands.assign(bodyCount, noIsland);
+
+        for(std::uint32_t i = 0; i < bodyCount; i++) {
+            if(!bodies.IsAwake(i)) continue;
+
+            auto root = Find(i);
+
+            // The root is the smallest body in the island, so it is reached first
+            if(root == i) {
+                bodyIslands[i] = static_cast<std::uint32_t>(islands.size());
+                islands.push_back({0, 0, 0, 0});
+            } else {
+                bodyIslands[i] = bodyIslands[root];
+            }
+
+            islands[bodyIslands[i]].bodyCount++;
+        }
+
+        auto contactIsland = [&](const Contact& contact) {
+            return bodies.IsAwake(contact.index1) ? bodyIslands[contact.index1] : bodyIslands[contact.index2];
+        };
+
+        for(auto& contact : contacts) {
+            auto island = contactIsland(contact);
+
+            if(island != noIsland) {
+                islands[island].contactCount++;
+            }
+        }
+
+        // Counting sort of bodies and contacts by island
+        std::uint32_t bodyOffset = 0;
+        std::uint32_t contactOffset = 0;
+
+        for(auto& island : islands) {
+            island.firstBody = bodyOffset;
+            island.firstContact = contactOffset;
+
+            bodyOffset += island.bodyCount;
+            contactOffset += island.contactCount;
+
+            // Counted again as the bodies and contacts are inserted
+            island.bodyCount = 0;
+            island.contactCount = 0;
+        }
+
+        islandBodies.resize(bodyOffset);
+        islandContacts.resize(contactOffset);
+        islandContactIndices.resize(contactOffset);
+
+        for(std::uint32_t i = 0; i < bodyCount; i++) {
+            if(bodyIslands[i] == noIsland) continue;
+
+            auto& island = islands[bodyIslands[i]];
+
+            islandBodies[island.firstBody + island.bodyCount++] = i;
+        }
+
+        for(std::uint32_t i = 0; i < contacts.size(); i++) {
+            auto islandIndex = contactIsland(contacts[i]);
+
+            if(islandIndex == noIsland) continue;
+
+            auto& island = islands[islandIndex];
+
+            islandContactIndices[island.firstContact + island.contactCount] = i;
+            islandContacts[island.firstContact + island.contactCount++] = contacts[i];
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace Physics {
+    namespace {
+        thread_local const JobSystem* currentJobSystem = nullptr;
+        thread_local std::size_t currentThreadIndex = 0;
+    }
+
+    JobSystem::JobSystem(std::size_t threadCount) {
+        if(threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for(std::size_t i = 0; i < threadCount; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+
+        for(std::size_t i = 1; i < threadCount; i++) {
+            workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard lock{sleepMutex};
+            stopping = true;
+        }
+
+        wake.notify_all();
+
+        for(auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::size_t JobSystem::GetThreadIndex() const noexcept {
+        return currentJobSystem == this ? currentThreadIndex : 0;
+    }
+
+    bool JobSystem::TryRunJob(std::size_t threadIndex, const JobGroup* onlyGroup) {
+        Job job;
+        bool found = false;
+
+        auto take = [&](Queue& queue, bool newest) {
+            std::lock_guard lock{queue.mutex};
+
+            if(onlyGroup) {
+                auto groupJob = std::ranges::find(queue.jobs, onlyGroup, &Job::group);
+
+                if(groupJob == queue.jobs.end()) return;
+
+                job = *groupJob;
+                queue.jobs.erase(groupJob);
+            } else if(queue.jobs.empty()) {
+                return;
+            } else if(newest) {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            } else {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+
+            found = true;
+        };
+
+        // Newest job from our own queue first, since its data is most likely to be in cache
+        take(*queues[threadIndex], true);
+
+        // Then steal the oldest job from another queue
+        for(std::size_t i = 1; !found && i < queues.size(); i++) {
+            take(*queues[(threadIndex + i) % queues.size()], false);
+        }
+
+        if(!found) return false;
+
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+        auto& group = *job.group;
+
+        try {
+            (*group.function)(job.begin, job.end);
+        } catch(...) {
+            std::lock_guard lock{group.exceptionMutex};
+
+            if(!group.exception) {
+                group.exception = std::current_exception();
+            }
+        }
+
+        group.remaining.fetch_sub(1, std::memory_order_release);
+
+        return true;
+    }
+
+    void JobSystem::WorkerLoop(std::size_t threadIndex) {
+        currentJobSystem = this;
+        currentThreadIndex = threadIndex;
+
+        while(true) {
+            if(TryRunJob(threadIndex)) continue;
+
+            std::unique_lock lock{sleepMutex};
+
+            wake.wait(lock, [&] {
+                return stopping || queuedJobs.load(std::memory_order_relaxed) > 0;
+            });
+
+            if(stopping) return;
+        }
+    }
+
+    void JobSystem::ParallelFor(std::size_t count, std::size_t grainSize, const RangeFunction& function) {
+        grainSize = std::max<std::size_t>(grainSize, 1);
+
+        auto jobCount = (count + grainSize - 1) / grainSize;
+
+        if(jobCount <= 1 || workers.empty()) {
+            for(std::size_t begin = 0; begin < count; begin += grainSize) {
+                function(begin, std::min(begin + grainSize, count));
+            }
+
+            return;
+        }
+
+        JobGroup group{&function, jobCount, {}, {}};
+
+        auto threadIndex = GetThreadIndex();
+
+        // Threads that aren't workers share index 0, so running another caller's job could use the same per-thread data at the same time
+        auto onlyGroup = currentJobSystem == this ? nullptr : &group;
+
+        for(std::size_t i = 0; i < jobCount; i++) {
+            auto begin = i * grainSize;
+
+            auto& queue = *queues[(threadIndex + i) % queues.size()];
+
+            std::lock_guard lock{queue.mutex};
+
+            queue.jobs.push_back({&group, begin, std::min(begin + grainSize, count)});
+        }
+
+        // Holding the lock prevents a worker from missing the notification between checking queuedJobs and waiting
+        {
+            std::lock_guard lock{sleepMutex};
+            queuedJobs.fetch_add(jobCount, std::memory_order_relaxed);
+        }
+
+        wake.notify_all();
+
+        while(group.remaining.load(std::memory_order_acquire) > 0) {
+            if(!TryRunJob(threadIndex, onlyGroup)) {
+                std::this_thread::yield();
+            }
+        }
+
+        if(group.exception) {
+            std::rethrow_exception(group.exception);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Physics {
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if(file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            throw std::runtime_error{"Could not open " + path.string()};
+        }
+
+        LARGE_INTEGER fileSize;
+
+        if(!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error{"Could not get the size of " + path.string()};
+        }
+
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+
+        // Empty files can't be mapped
+        if(size == 0) return;
+
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if(mapping) {
+            data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+
+        if(!data) {
+            if(mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            throw std::runtime_error{"Could not map " + path.string()};
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if(data) UnmapViewOfFile(data);
+        if(mapping) CloseHandle(mapping);
+        if(file) CloseHandle(file);
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        auto descriptor = open(path.c_str(), O_RDONLY);
+
+        if(descriptor == -1) {
+            throw std::runtime_error{"Could not open " + path.string()};
+        }
+
+        struct stat status;
+
+        if(fstat(descriptor, &status) == -1) {
+            close(descriptor);
+            throw std::runtime_error{"Could not get the size of " + path.string()};
+        }
+
+        size = static_cast<std::size_t>(status.st_size);
+
+        // Empty files can't be mapped
+        if(size > 0) {
+            auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+            if(address == MAP_FAILED) {
+                close(descriptor);
+                throw std::runtime_error{"Could not map " + path.string()};
+            }
+
+            data = static_cast<const std::byte*>(address);
+        }
+
+        // The mapping stays valid after the file is closed
+        close(descriptor);
+    }
+
+    MappedFile::~MappedFile() {
+        if(data) munmap(const_cast<std::byte*>(data), size);
+    }
+#endif
+}
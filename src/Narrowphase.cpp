@@ -0,0 +1,201 @@
+#include "Narrowphase.hpp"
+
+#include "CollisionTest.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+#include <spdlog/spdlog.h>
+
+namespace Physics {
+    // A contact between bodies first and second is calculated as colliders[first]->CollidesWith(*colliders[second])
+    // That calls Collides(*colliders[second], *colliders[first]), so second is the first argument to the collision test
+
+    template<typename T, typename U>
+    void Narrowphase::TestBucket(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers) {
+        constexpr bool isPlane1 = std::is_same_v<T, SimplePlaneCollider>;
+        constexpr bool isPlane2 = std::is_same_v<U, SimplePlaneCollider>;
+        constexpr bool isCubeOrSphere1 = std::is_same_v<T, SimpleCubeCollider> || std::is_same_v<T, SphereCollider>;
+        constexpr bool isCubeOrSphere2 = std::is_same_v<U, SimpleCubeCollider> || std::is_same_v<U, SphereCollider>;
+
+        if constexpr(!SupportsCollision<T, U>()) {
+            // CalculateContacts skips pairs that don't support collision
+        }
+        else if constexpr(std::is_same_v<T, SphereCollider> && std::is_same_v<U, SphereCollider>) {
+            TestSpheres(bodies, pairs, bucket, buffers);
+        }
+        else if constexpr(std::is_same_v<T, SimpleCubeCollider> && std::is_same_v<U, SimpleCubeCollider>) {
+            TestCubes(bodies, pairs, bucket, buffers);
+        }
+        else if constexpr(isPlane1 && isCubeOrSphere2) {
+            TestPlanes(bodies, pairs, bucket, buffers, true);
+        }
+        else if constexpr(isCubeOrSphere1 && isPlane2) {
+            TestPlanes(bodies, pairs, bucket, buffers, false);
+        }
+        else {
+            for(auto i : bucket) {
+                auto [first, second] = pairs[i];
+
+                auto& collider1 = static_cast<const T&>(*bodies.colliders[first]);
+                auto& collider2 = static_cast<const U&>(*bodies.colliders[second]);
+
+                results[i] = Collides(collider2, collider1);
+            }
+        }
+    }
+
+    void Narrowphase::TestSpheres(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers) {
+        auto& spheres = buffers.spheres;
+        auto& batchResults = buffers.results;
+
+        spheres.Resize(bucket.size());
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            auto [first, second] = pairs[bucket[i]];
+
+            spheres.position1.Set(i, bodies.positions[second]);
+            spheres.size1[i] = bodies.sizes[second].x;
+            spheres.position2.Set(i, bodies.positions[first]);
+            spheres.size2[i] = bodies.sizes[first].x;
+        }
+
+        SpheresCollideBatch(spheres, batchResults);
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            results[bucket[i]] = batchResults.Get(i);
+        }
+    }
+
+    void Narrowphase::TestCubes(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers) {
+        auto& cubes = buffers.cubes;
+        auto& batchResults = buffers.results;
+
+        cubes.Resize(bucket.size());
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            auto [first, second] = pairs[bucket[i]];
+
+            cubes.position1.Set(i, bodies.positions[second]);
+            cubes.size1.Set(i, bodies.sizes[second]);
+            cubes.position2.Set(i, bodies.positions[first]);
+            cubes.size2.Set(i, bodies.sizes[first]);
+        }
+
+        CubesCollideBatch(cubes, batchResults);
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            results[bucket[i]] = batchResults.Get(i);
+        }
+    }
+
+    void Narrowphase::TestPlanes(const BodyStore& bodies, std::span<const IndexPair> pairs, std::span<const std::uint32_t> bucket, BatchBuffers& buffers, bool planeFirst) {
+        auto& planes = buffers.planes;
+        auto& batchResults = buffers.results;
+
+        planes.Resize(bucket.size());
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            auto [first, second] = pairs[bucket[i]];
+
+            auto plane = planeFirst ? first : second;
+            auto other = planeFirst ? second : first;
+
+            planes.planeHeight[i] = bodies.positions[plane].y;
+            planes.height[i] = bodies.positions[other].y;
+            planes.size[i] = bodies.sizes[other].y;
+            planes.velocity[i] = bodies.velocities[other].y;
+        }
+
+        PlanesCollideBatch(planes, batchResults);
+
+        for(std::size_t i = 0; i < bucket.size(); i++) {
+            auto result = batchResults.Get(i);
+
+            // Collides switches the arguments if the plane isn't first, which reverses the normal
+            if(planeFirst) {
+                result.normal = -result.normal;
+            }
+
+            results[bucket[i]] = result;
+        }
+    }
+
+    template<typename T, typename... Types>
+    constexpr std::array<Narrowphase::BucketFunction, colliderTypeCount> Narrowphase::MakeBucketRow(TypeList<Types...>) noexcept {
+        return {&Narrowphase::TestBucket<T, Types>...};
+    }
+
+    template<typename... Types>
+    constexpr Narrowphase::BucketTable Narrowphase::MakeBucketTable(TypeList<Types...> types) noexcept {
+        return {MakeBucketRow<Types>(types)...};
+    }
+
+    // Pairs are tested in ranges of this many pairs, which may span several buckets
+    constexpr std::size_t narrowphaseGrainSize = 1024;
+
+    void Narrowphase::CalculateContacts(const BodyStore& bodies, std::span<const IndexPair> pairs, std::vector<Contact>& contacts, JobSystem* jobSystem) {
+        static constexpr auto bucketTable = MakeBucketTable(ColliderTypes{});
+
+        auto bucketIndex = [&](IndexPair pair) {
+            return bodies.typeIndices[pair.first] * colliderTypeCount + bodies.typeIndices[pair.second];
+        };
+
+        // Counting sort, which keeps the pairs in each bucket in their original order
+        bucketOffsets.fill(0);
+
+        for(auto pair : pairs) {
+            bucketOffsets[bucketIndex(pair) + 1]++;
+        }
+
+        for(std::size_t i = 1; i < bucketOffsets.size(); i++) {
+            bucketOffsets[i] += bucketOffsets[i - 1];
+        }
+
+        auto insertOffsets = bucketOffsets;
+
+        sortedPairs.resize(pairs.size());
+
+        for(std::uint32_t i = 0; i < pairs.size(); i++) {
+            sortedPairs[insertOffsets[bucketIndex(pairs[i])]++] = i;
+        }
+
+        results.assign(pairs.size(), CollisionResult{false});
+
+        batchBuffers.resize(jobSystem ? jobSystem->GetThreadCount() : 1);
+
+        ParallelFor(jobSystem, sortedPairs.size(), narrowphaseGrainSize, [&](std::size_t begin, std::size_t end) {
+            auto& buffers = batchBuffers[jobSystem ? jobSystem->GetThreadIndex() : 0];
+
+            for(std::size_t type1 = 0; type1 < colliderTypeCount; type1++) {
+                for(std::size_t type2 = 0; type2 < colliderTypeCount; type2++) {
+                    auto bucket = type1 * colliderTypeCount + type2;
+
+                    // The part of this bucket that is in the range
+                    auto bucketBegin = std::max<std::size_t>(bucketOffsets[bucket], begin);
+                    auto bucketEnd = std::min<std::size_t>(bucketOffsets[bucket + 1], end);
+
+                    if(bucketBegin >= bucketEnd) continue;
+
+                    std::span<const std::uint32_t> range{sortedPairs.begin() + bucketBegin, sortedPairs.begin() + bucketEnd};
+
+                    (this->*bucketTable[type1][type2])(bodies, pairs, range, buffers);
+                }
+            }
+        });
+
+        [[maybe_unused]] auto firstContact = contacts.size();
+
+        for(std::size_t i = 0; i < pairs.size(); i++) {
+            auto& result = results[i];
+
+            if(!result.collides) continue;
+
+            auto [first, second] = pairs[i];
+
+            contacts.push_back({bodies.colliders[first], bodies.colliders[second], first, second, result.normal, result.penetration});
+        }
+
+        SPDLOG_DEBUG("Found {} colliding pairs", contacts.size() - firstContact);
+    }
+}
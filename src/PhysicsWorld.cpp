@@ -2,23 +2,790 @@
 
 #include "Collision.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <spdlog/spdlog.h>
+
 namespace Physics {
 
+// Bodies are integrated in ranges of this many bodies
+constexpr std::size_t integrateGrainSize = 4096;
+
+// Most islands are small, so each job resolves several
+constexpr std::size_t islandGrainSize = 64;
+
 void PhysicsWorld::Tick() {
+    contactTracker.ClearEvents();
+
+    RunTick();
+}
+
+void PhysicsWorld::RunTick() {
     float deltaTime = (float)1 / tickRate;
 
-    Physics::ApplyVelocity(physicsObjects, gravityVector, deltaTime);
-    Physics::ResolveCollisions(physicsObjects);
+    rollback.Save(bodies, contactTracker.GetTouchingPairs(), currentTick, lastUpdate, staticChanges);
+
+    {
+        ScopedTimer timer{profiler, ProfileTimer::Tick};
+
+        Step(deltaTime);
+    }
+
+    profiler.EndTick();
 
-    lastUpdate += deltaTime;
+    lastUpdate += 1.0 / tickRate;
+    currentTick++;
+    queryTreeDirty = true;
 }
 
-void PhysicsWorld::TickUntil() {
-    while(lastUpdate < timeManager->elapsedTime) {
-        Tick();
+void PhysicsWorld::Step(float deltaTime) {
+    {
+        ScopedTimer timer{profiler, ProfileTimer::Integrate};
+
+        bounds.resize(bodies.Size());
+
+        // Each body only depends on its own state, so the ranges can run in any order
+        ParallelFor(jobSystem, bodies.Size(), integrateGrainSize, [&](std::size_t begin, std::size_t end) {
+            std::copy(bodies.positions.begin() + begin, bodies.positions.begin() + end, bodies.previousPositions.begin() + begin);
+
+            bodies.SelectSteppingBodies(currentTick, begin, end);
+
+            Physics::ApplyScaledVelocity(bodies, gravityVector, deltaTime, begin, end);
+
+            // The narrowphase reads the colliders, so they need the new positions
+            bodies.WriteBack(begin, end);
+
+            bodies.CalculateBounds(bounds, begin, end);
+        });
+    }
+
+    {
+        ScopedTimer timer{profiler, ProfileTimer::Broadphase};
+
+        UpdateBodyLists();
+        CalculatePairs();
+
+        CatchUpBodies(deltaTime);
+
+        // Only stepping bodies have moved, so pairs without a stepping body can't have changed
+        std::erase_if(candidates, [&](IndexPair pair) {
+            return !bodies.IsStepping(pair.first) && !bodies.IsStepping(pair.second);
+        });
+    }
+
+    {
+        ScopedTimer timer{profiler, ProfileTimer::Narrowphase};
+
+        contacts.clear();
+
+        narrowphase.CalculateContacts(bodies, candidates, contacts, jobSystem);
+
+        // Moves fast bodies back to where they first hit something, so this must run before the islands are resolved
+        continuousCollision.CalculateContacts(bodies, candidates, contacts);
+
+        // Resolving wakes bodies, which would end the contacts of sleeping pairs that weren't tested
+        contactTracker.Update(contacts, bodies, handles);
     }
+
+    {
+        ScopedTimer timer{profiler, ProfileTimer::Resolve};
+
+        // Sleeping bodies touched by an awake body join its island
+        for(auto& contact : contacts) {
+            bodies.Wake(contact.index1);
+            bodies.Wake(contact.index2);
+        }
+
+        islands.Build(bodies, contacts);
+
+        solver.SetThreadCount(jobSystem ? jobSystem->GetThreadCount() : 1);
+
+        // Islands don't share any awake bodies, so they can be resolved in parallel
+        ParallelFor(jobSystem, islands.GetIslands().size(), islandGrainSize, [&](std::size_t begin, std::size_t end) {
+            for(auto& island : islands.GetIslands().subspan(begin, end - begin)) {
+                // Only bodies in a contact have their velocity changed
+                if(island.contactCount != 0) {
+                    auto islandContacts = islands.GetContacts(island);
+
+                    solver.Solve(bodies, islandContacts, solverSettings, jobSystem ? jobSystem->GetThreadIndex() : 0);
+
+                    // Each contact is in one island, so the impulses can be copied back in parallel
+                    auto indices = islands.GetContactIndices(island);
+
+                    for(std::size_t i = 0; i < islandContacts.size(); i++) {
+                        contacts[indices[i]].impulse = islandContacts[i].impulse;
+                    }
+
+                    for(auto body : islands.GetBodies(island)) {
+                        bodies.WriteBack(body);
+                    }
+                }
+
+                if(sleepingEnabled) {
+                    UpdateSleep(island, deltaTime);
+                }
+            }
+        });
+
+        contactTracker.StoreImpulses(contacts);
+    }
+
+    if(tickLevelFunction) {
+        // Levels only change at the end of a step, so pending ticks are never skipped
+        for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+            if(!bodies.IsStepping(i)) continue;
+
+            auto level = tickLevelFunction(handles.GetHandle(bodies.handleSlots[i]), bodies.positions[i]);
+
+            bodies.tickLevels[i] = std::min(level, maxTickLevel);
+        }
+    }
+
+    CountBodies();
+
+    profiler.SetCounter(ProfileCounter::Bodies, bodies.Size());
+    profiler.SetCounter(ProfileCounter::SteppedBodies, steppedBodyCount);
+    profiler.SetCounter(ProfileCounter::NarrowphaseCalls, candidates.size());
+    profiler.SetCounter(ProfileCounter::Contacts, contacts.size());
 }
 
-void PhysicsWorld::AddPhysicsObject(Collider* collider) { physicsObjects.push_back(collider); }
+void PhysicsWorld::UpdateBodyLists() {
+    if(!bodyListsDirty) return;
+
+    dynamicIndices.resize(bodies.Size());
+
+    std::uint32_t dynamicCount = 0;
+
+    for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+        dynamicIndices[i] = bodies.IsStatic(i) ? Broadphase::removedIndex : dynamicCount++;
+    }
+
+    // dynamicBodies still has the old body indices, which broadphaseRemap maps to the new ones
+    if(bodiesRemoved) {
+        dynamicRemap.resize(dynamicBodies.size());
+
+        for(std::size_t i = 0; i < dynamicBodies.size(); i++) {
+            auto body = broadphaseRemap[dynamicBodies[i]];
+
+            dynamicRemap[i] = body == Broadphase::removedIndex ? Broadphase::removedIndex : dynamicIndices[body];
+        }
+
+        broadphase->Remap(dynamicRemap);
+
+        bodiesRemoved = false;
+        broadphaseIndices.clear();
+    }
+
+    dynamicBodies.clear();
+    staticBodies.clear();
+
+    for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+        if(bodies.IsStatic(i)) {
+            staticBodies.push_back(i);
+        } else {
+            dynamicBodies.push_back(i);
+        }
+    }
+
+    bodyListsDirty = false;
+}
+
+// Each range of dynamic bodies checked against the static bodies covers this many bodies
+constexpr std::size_t staticPairGrainSize = 1024;
+
+void PhysicsWorld::CalculatePairs() {
+    if(staticTreeDirty) {
+        staticBounds.resize(staticBodies.size());
+
+        for(std::size_t i = 0; i < staticBodies.size(); i++) {
+            staticBounds[i] = bounds[staticBodies[i]];
+        }
+
+        staticTree.Build(staticBounds);
+
+        staticTreeDirty = false;
+    }
+
+    dynamicBounds.resize(dynamicBodies.size());
+
+    for(std::size_t i = 0; i < dynamicBodies.size(); i++) {
+        dynamicBounds[i] = bounds[dynamicBodies[i]];
+    }
+
+    dynamicPairs.clear();
+    broadphase->CalculatePairs(dynamicBounds, dynamicPairs, jobSystem);
+
+    broadphaseBodyCount = bodies.Size();
+
+    rangeStaticPairs.resize((dynamicBodies.size() + staticPairGrainSize - 1) / staticPairGrainSize);
+
+    ParallelFor(jobSystem, dynamicBodies.size(), staticPairGrainSize, [&](std::size_t begin, std::size_t end) {
+        auto& found = rangeStaticPairs[begin / staticPairGrainSize];
+
+        found.clear();
+
+        for(auto i = begin; i < end; i++) {
+            auto body = dynamicBodies[i];
+
+            // Static bodies don't move, so nothing changes for a sleeping body
+            if(!bodies.IsAwake(body)) continue;
+
+            auto& bodyBounds = dynamicBounds[i];
+
+            staticTree.Query([&](const AABB& nodeBounds) {
+                return nodeBounds.Overlaps(bodyBounds);
+            }, [&](std::uint32_t staticIndex) {
+                if(!staticBounds[staticIndex].Overlaps(bodyBounds)) return;
+
+                auto [first, second] = std::minmax(body, staticBodies[staticIndex]);
+
+                found.push_back({first, second});
+            });
+        }
+    });
+
+    // dynamicBodies is in ascending order, so the pairs keep first < second
+    candidates.clear();
+
+    for(auto [first, second] : dynamicPairs) {
+        candidates.push_back({dynamicBodies[first], dynamicBodies[second]});
+    }
+
+    for(auto& found : rangeStaticPairs) {
+        candidates.insert(candidates.end(), found.begin(), found.end());
+    }
+
+    auto candidateCount = candidates.size();
+
+    // Cheaper than the narrowphase, since it only reads the hot arrays
+    std::erase_if(candidates, [&](IndexPair pair) {
+        return !bodies.ShouldCollide(pair.first, pair.second);
+    });
+
+    profiler.SetCounter(ProfileCounter::CandidatePairs, candidateCount);
+    profiler.SetCounter(ProfileCounter::FilteredPairs, candidateCount - candidates.size());
+
+    std::sort(candidates.begin(), candidates.end());
+}
+
+void PhysicsWorld::CatchUpBodies(float deltaTime) noexcept {
+    // Catching a body up can give it a pair with another body that isn't stepping, so this repeats until every pair is caught up
+    for(bool changed = true; changed;) {
+        changed = false;
+
+        for(auto [first, second] : candidates) {
+            if(bodies.IsStepping(first) == bodies.IsStepping(second)) continue;
+
+            auto body = bodies.IsStepping(first) ? second : first;
+
+            // Sleeping bodies haven't moved since they fell asleep, so they are already up to date
+            if(!bodies.StartStep(body)) continue;
+
+            Physics::ApplyScaledVelocity(bodies, gravityVector, deltaTime, body, body + 1);
+
+            bodies.WriteBack(body);
+            bodies.CalculateBounds(bounds, body, body + 1);
+
+            changed = true;
+        }
+    }
+}
+
+void PhysicsWorld::CountBodies() noexcept {
+    awakeBodyCount = 0;
+    sleepingBodyCount = 0;
+    steppedBodyCount = 0;
+
+    for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+        if(bodies.IsStatic(i)) continue;
+
+        steppedBodyCount += bodies.IsStepping(i);
+
+        if(bodies.IsAwake(i)) {
+            awakeBodyCount++;
+        } else {
+            sleepingBodyCount++;
+        }
+    }
+}
+
+void PhysicsWorld::UpdateSleep(const Island& island, float deltaTime) noexcept {
+    auto islandBodies = islands.GetBodies(island);
+
+    float minSleepTime = sleepTime;
+
+    for(auto body : islandBodies) {
+        auto velocity = bodies.velocities[body];
+
+        if(glm::dot(velocity, velocity) < sleepVelocity * sleepVelocity) {
+            bodies.sleepTimes[body] += deltaTime;
+        } else {
+            bodies.sleepTimes[body] = 0;
+        }
+
+        minSleepTime = std::min(minSleepTime, bodies.sleepTimes[body]);
+    }
+
+    // An island only sleeps once all of its bodies are ready to sleep, so a body resting on a moving one stays awake
+    if(minSleepTime < sleepTime) return;
+
+    for(auto body : islandBodies) {
+        bodies.Sleep(body);
+    }
+}
+
+std::size_t PhysicsWorld::TickUntil() {
+    double tickLength = 1.0 / tickRate;
+
+    auto clock = timeManager->elapsedTime - droppedTime;
+
+    std::size_t substeps = 0;
+
+    contactTracker.ClearEvents();
+
+    for(; substeps < maxSubsteps && lastUpdate + tickLength <= clock; substeps++) {
+        RunTick();
+    }
+
+    auto backlog = clock - lastUpdate;
+
+    if(backlog >= tickLength && overrunPolicy == OverrunPolicy::Drop) {
+        // Only whole ticks are dropped, so the fraction of the next tick is kept for interpolation
+        auto dropped = std::floor(backlog / tickLength) * tickLength;
+
+        droppedTime += dropped;
+        backlog -= dropped;
+
+        SPDLOG_DEBUG("Dropped {} seconds after running {} ticks", dropped, substeps);
+    }
+
+    interpolationAlpha = std::clamp(backlog / tickLength, 0.0, 1.0);
+
+    return substeps;
+}
+
+void PhysicsWorld::SetTickRate(float rate) noexcept {
+    tickRate = rate;
+}
+
+float PhysicsWorld::GetTickRate() const noexcept {
+    return tickRate;
+}
+
+void PhysicsWorld::SetMaxSubsteps(std::size_t substeps) noexcept {
+    maxSubsteps = substeps;
+}
+
+void PhysicsWorld::SetOverrunPolicy(OverrunPolicy policy) noexcept {
+    overrunPolicy = policy;
+}
+
+double PhysicsWorld::GetSimulationTime() const noexcept {
+    return lastUpdate;
+}
+
+double PhysicsWorld::GetDroppedTime() const noexcept {
+    return droppedTime;
+}
+
+double PhysicsWorld::GetInterpolationAlpha() const noexcept {
+    return interpolationAlpha;
+}
+
+void PhysicsWorld::AddBody(Collider* collider, BodyHandle handle, std::uint32_t poolIndex) {
+    bodies.Add(collider, handle.index);
+
+    if(handle.index >= poolIndices.size()) {
+        poolIndices.resize(handle.index + 1);
+    }
+
+    poolIndices[handle.index] = poolIndex;
+
+    // The broadphase hasn't seen this body yet
+    if(bodiesRemoved) {
+        broadphaseIndices.push_back(Broadphase::removedIndex);
+    }
+
+    // Frames from before the body was added can't be restored
+    rollback.Clear();
+
+    queryTreeDirty = true;
+    bodyListsDirty = true;
+    if(bodies.IsStatic(bodies.Size() - 1)) {
+        staticTreeDirty = true;
+        staticChanges++;
+    }
+}
+
+BodyHandle PhysicsWorld::AddPhysicsObject(Collider* collider) {
+    auto handle = handles.Create(static_cast<std::uint32_t>(bodies.Size()));
+
+    AddBody(collider, handle, BodyHandle::invalidIndex);
+
+    return handle;
+}
+
+template<typename T>
+void PhysicsWorld::UpdateColliderPointers(ColliderPool<T>& pool) noexcept {
+    for(std::uint32_t i = 0; i < pool.Size(); i++) {
+        bodies.colliders[handles.GetIndex(handles.GetHandle(pool.GetHandleSlot(i)))] = &pool[i];
+    }
+}
+
+template<typename T>
+BodyHandle PhysicsWorld::CreateInPool(const T& collider) {
+    auto& pool = std::get<colliderTypeIndex<T>>(pools);
+
+    auto handle = handles.Create(static_cast<std::uint32_t>(bodies.Size()));
+
+    auto oldStorage = pool.Size() > 0 ? &pool[0] : nullptr;
+    auto poolIndex = pool.Add(collider, handle.index);
+
+    AddBody(&pool[poolIndex], handle, poolIndex);
+
+    // The pool's storage grew, so every collider in it moved
+    if(oldStorage && oldStorage != &pool[0]) {
+        UpdateColliderPointers(pool);
+    }
+
+    return handle;
+}
+
+template<typename T>
+void PhysicsWorld::RemoveFromPool(std::uint32_t poolIndex) noexcept {
+    auto& pool = std::get<colliderTypeIndex<T>>(pools);
+
+    auto movedFrom = pool.Remove(poolIndex);
+
+    if(movedFrom == poolIndex) return;
+
+    auto slot = pool.GetHandleSlot(poolIndex);
+
+    poolIndices[slot] = poolIndex;
+    bodies.colliders[handles.GetIndex(handles.GetHandle(slot))] = &pool[poolIndex];
+}
+
+BodyHandle PhysicsWorld::CreateSphere(glm::vec3 position, float size, glm::vec3 velocity) {
+    return Create(SphereCollider{position, size, velocity});
+}
+
+BodyHandle PhysicsWorld::CreateCube(glm::vec3 position, glm::vec3 size, glm::vec3 velocity) {
+    return Create(SimpleCubeCollider{position, size, velocity});
+}
+
+BodyHandle PhysicsWorld::CreatePlane(float height) {
+    return Create(SimplePlaneCollider{height});
+}
+
+BodyHandle PhysicsWorld::Create(const SimplePlaneCollider& collider) {
+    return CreateInPool(collider);
+}
+
+BodyHandle PhysicsWorld::Create(const SimpleCubeCollider& collider) {
+    return CreateInPool(collider);
+}
+
+BodyHandle PhysicsWorld::Create(const SphereCollider& collider) {
+    return CreateInPool(collider);
+}
+
+BodyHandle PhysicsWorld::Create(const HeightfieldCollider& collider) {
+    return CreateInPool(collider);
+}
+
+void PhysicsWorld::Destroy(BodyHandle body) {
+    if(!IsValid(body)) {
+        throw std::invalid_argument{"Destroying a body that isn't valid"};
+    }
+
+    auto index = handles.GetIndex(body);
+    auto poolIndex = poolIndices[body.index];
+
+    if(poolIndex != BodyHandle::invalidIndex) {
+        // Calls RemoveFromPool for the pool of the body's collider type
+        [&]<typename... Types>(TypeList<Types...>) {
+            static_cast<void>(((bodies.typeIndices[index] == colliderTypeIndex<Types> && (RemoveFromPool<Types>(poolIndex), true)) || ...));
+        }(ColliderTypes{});
+    }
+
+    if(!bodiesRemoved) {
+        bodiesRemoved = true;
+
+        broadphaseRemap.resize(broadphaseBodyCount);
+        std::iota(broadphaseRemap.begin(), broadphaseRemap.end(), 0);
+
+        broadphaseIndices.resize(bodies.Size());
+
+        for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+            broadphaseIndices[i] = i < broadphaseBodyCount ? i : Broadphase::removedIndex;
+        }
+    }
+
+    if(bodies.IsStatic(index)) {
+        staticTreeDirty = true;
+        staticChanges++;
+    }
+
+    auto movedFrom = bodies.Remove(index);
+
+    // Keeps track of where the bodies the broadphase knows about are now
+    if(broadphaseIndices[index] != Broadphase::removedIndex) {
+        broadphaseRemap[broadphaseIndices[index]] = Broadphase::removedIndex;
+    }
+
+    if(broadphaseIndices[movedFrom] != Broadphase::removedIndex && movedFrom != index) {
+        broadphaseRemap[broadphaseIndices[movedFrom]] = index;
+    }
+
+    broadphaseIndices[index] = broadphaseIndices[movedFrom];
+    broadphaseIndices.pop_back();
+
+    if(movedFrom != index) {
+        handles.SetIndex(bodies.handleSlots[index], index);
+    }
+
+    handles.Destroy(body);
+
+    rollback.Clear();
+    queryTreeDirty = true;
+    bodyListsDirty = true;
+
+    // The contacts refer to bodies by index, and may point to the destroyed collider
+    contacts.clear();
+}
+
+bool PhysicsWorld::IsValid(BodyHandle body) const noexcept {
+    return handles.Contains(body);
+}
+
+const Collider& PhysicsWorld::GetCollider(BodyHandle body) const noexcept {
+    return *bodies.colliders[handles.GetIndex(body)];
+}
+
+glm::vec3 PhysicsWorld::GetPosition(BodyHandle body) const noexcept {
+    return bodies.positions[handles.GetIndex(body)];
+}
+
+void PhysicsWorld::SetPosition(BodyHandle body, glm::vec3 position) noexcept {
+    auto index = handles.GetIndex(body);
+
+    bodies.Wake(index);
+    bodies.positions[index] = position;
+    bodies.previousPositions[index] = position;
+    bodies.pendingTicks[index] = 0;
+    bodies.WriteBack(index);
+
+    queryTreeDirty = true;
+    if(bodies.IsStatic(index)) {
+        staticTreeDirty = true;
+        staticChanges++;
+    }
+}
+
+glm::vec3 PhysicsWorld::GetPreviousPosition(BodyHandle body) const noexcept {
+    return bodies.previousPositions[handles.GetIndex(body)];
+}
+
+glm::vec3 PhysicsWorld::GetInterpolatedPosition(BodyHandle body) const noexcept {
+    auto index = handles.GetIndex(body);
+
+    return glm::mix(bodies.previousPositions[index], bodies.positions[index], static_cast<float>(interpolationAlpha));
+}
+
+glm::vec3 PhysicsWorld::GetVelocity(BodyHandle body) const noexcept {
+    return bodies.velocities[handles.GetIndex(body)];
+}
+
+void PhysicsWorld::SetVelocity(BodyHandle body, glm::vec3 velocity) noexcept {
+    auto index = handles.GetIndex(body);
+
+    bodies.Wake(index);
+    bodies.velocities[index] = velocity;
+    bodies.WriteBack(index);
+}
+
+void PhysicsWorld::ApplyImpulse(BodyHandle body, glm::vec3 impulse) noexcept {
+    auto index = handles.GetIndex(body);
+
+    if(bodies.IsStatic(index)) return;
+
+    bodies.Wake(index);
+    bodies.velocities[index] += impulse * bodies.inverseMasses[index];
+    bodies.WriteBack(index);
+}
+
+void PhysicsWorld::Reserve(std::size_t bodyCount) {
+    bodies.Reserve(bodyCount);
+    poolIndices.reserve(bodyCount);
+    bounds.reserve(bodyCount);
+    dynamicBodies.reserve(bodyCount);
+    dynamicIndices.reserve(bodyCount);
+    dynamicBounds.reserve(bodyCount);
+}
+
+std::size_t PhysicsWorld::GetBodyCount() const noexcept {
+    return bodies.Size();
+}
+
+bool PhysicsWorld::IsAwake(BodyHandle body) const noexcept {
+    return bodies.IsAwake(handles.GetIndex(body));
+}
+
+void PhysicsWorld::Wake(BodyHandle body) noexcept {
+    bodies.Wake(handles.GetIndex(body));
+}
+
+void PhysicsWorld::SetSleepingEnabled(bool enabled) noexcept {
+    sleepingEnabled = enabled;
+
+    if(!enabled) {
+        for(std::uint32_t i = 0; i < bodies.Size(); i++) {
+            bodies.Wake(i);
+        }
+    }
+}
+
+void PhysicsWorld::SetSleepThreshold(float velocity, float time) noexcept {
+    sleepVelocity = velocity;
+    sleepTime = time;
+}
+
+std::size_t PhysicsWorld::GetAwakeBodyCount() const noexcept {
+    return awakeBodyCount;
+}
+
+std::size_t PhysicsWorld::GetSleepingBodyCount() const noexcept {
+    return sleepingBodyCount;
+}
+
+std::size_t PhysicsWorld::GetSteppedBodyCount() const noexcept {
+    return steppedBodyCount;
+}
+
+void PhysicsWorld::SetTickLevel(BodyHandle body, std::uint8_t level) noexcept {
+    bodies.tickLevels[handles.GetIndex(body)] = std::min(level, maxTickLevel);
+}
+
+std::uint8_t PhysicsWorld::GetTickLevel(BodyHandle body) const noexcept {
+    return bodies.tickLevels[handles.GetIndex(body)];
+}
+
+void PhysicsWorld::SetTickLevelFunction(TickLevelFunction function) {
+    tickLevelFunction = std::move(function);
+}
+
+void PhysicsWorld::SetBroadphase(std::unique_ptr<Broadphase> newBroadphase) {
+    broadphase = std::move(newBroadphase);
+}
+
+void PhysicsWorld::SetThreadCount(std::size_t threadCount) {
+    jobSystem = nullptr;
+    ownedJobSystem.reset();
+
+    if(threadCount != 1) {
+        ownedJobSystem = std::make_unique<JobSystem>(threadCount);
+        jobSystem = ownedJobSystem.get();
+    }
+}
+
+void PhysicsWorld::SetJobSystem(JobSystem* newJobSystem) noexcept {
+    ownedJobSystem.reset();
+    jobSystem = newJobSystem;
+}
+
+std::size_t PhysicsWorld::GetThreadCount() const noexcept {
+    return jobSystem ? jobSystem->GetThreadCount() : 1;
+}
+
+void PhysicsWorld::SetRollbackLength(std::size_t ticks) {
+    rollback.SetCapacity(ticks);
+}
+
+void PhysicsWorld::SetSolverSettings(const SolverSettings& settings) noexcept {
+    solverSettings = settings;
+}
+
+const SolverSettings& PhysicsWorld::GetSolverSettings() const noexcept {
+    return solverSettings;
+}
+
+std::size_t PhysicsWorld::GetRollbackLength() const noexcept {
+    return rollback.GetCapacity();
+}
+
+std::uint64_t PhysicsWorld::GetTick() const noexcept {
+    return currentTick;
+}
+
+bool PhysicsWorld::Rewind(std::uint64_t tick) {
+    auto frame = rollback.Find(tick);
+
+    // A frame of different bodies would leave the body store's arrays with different sizes
+    if(!frame || frame->positions.size() != bodies.Size()) return false;
+
+    RollbackBuffer::Restore(bodies, *frame);
+    bodies.WriteBack();
+
+    contactTracker.Restore(frame->touchingPairs);
+    contactTracker.ClearEvents();
+
+    lastUpdate = frame->lastUpdate;
+    currentTick = tick;
+
+    // Running tick again saves its frame again
+    rollback.DiscardFrom(tick);
+
+    contacts.clear();
+    queryTreeDirty = true;
+
+    // Static bodies don't move during ticks, so the tree still matches them unless one was moved since the frame was saved
+    staticTreeDirty |= frame->staticChanges != staticChanges;
+
+    CountBodies();
+
+    return true;
+}
+
+std::span<const Contact> PhysicsWorld::GetContacts() const noexcept {
+    return contacts;
+}
+
+void PhysicsWorld::CopyTransforms(TransformSnapshot& snapshot) const {
+    snapshot.tick = currentTick;
+    snapshot.time = TransformSnapshot::Clock::now();
+    snapshot.tickLength = 1.0 / tickRate;
+
+    snapshot.bodies.resize(bodies.Size());
+
+    for(std::size_t i = 0; i < bodies.Size(); i++) {
+        snapshot.bodies[i] = {handles.GetHandle(bodies.handleSlots[i]), bodies.positions[i], bodies.previousPositions[i]};
+    }
+
+    auto slots = handles.GetSlots();
+
+    snapshot.slotIndices.resize(slots.size());
+
+    for(std::size_t i = 0; i < slots.size(); i++) {
+        snapshot.slotIndices[i] = slots[i].used ? slots[i].index : BodyHandle::invalidIndex;
+    }
+}
+
+std::span<const ContactEvent> PhysicsWorld::GetContactEvents() const noexcept {
+    return contactTracker.GetEvents();
+}
+
+std::span<const Island> PhysicsWorld::GetIslands() const noexcept {
+    return islands.GetIslands();
+}
+
+const PhysicsStats& PhysicsWorld::GetStats() const noexcept {
+    return profiler.GetStats();
+}
 
 }
\ No newline at end of file
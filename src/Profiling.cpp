@@ -0,0 +1,65 @@
+#include "Profiling.hpp"
+
+#include <algorithm>
+
+namespace Physics {
+    const char* GetName(ProfileTimer timer) noexcept {
+        constexpr std::array<const char*, profileTimerCount> names = {"Integrate", "Broadphase", "Narrowphase", "Resolve", "Tick"};
+
+        return names[static_cast<std::size_t>(timer)];
+    }
+
+    const char* GetName(ProfileCounter counter) noexcept {
+        constexpr std::array<const char*, profileCounterCount> names = {"Bodies", "CandidatePairs", "FilteredPairs", "NarrowphaseCalls", "Contacts", "SteppedBodies"};
+
+        return names[static_cast<std::size_t>(counter)];
+    }
+
+    void Profiler::EndTick() {
+        if constexpr(!profilingEnabled) return;
+
+        if(history.size() < profileWindowSize) {
+            history.push_back(current);
+        } else {
+            history[nextSample] = current;
+        }
+
+        nextSample = (nextSample + 1) % profileWindowSize;
+
+        CalculateStats();
+
+        current = {};
+    }
+
+    void Profiler::CalculateStats() noexcept {
+        auto& latest = history[(nextSample + history.size() - 1) % history.size()];
+
+        auto calculate = [&](RollingStat& stat, auto member, std::size_t index) {
+            stat.last = (latest.*member)[index];
+            stat.min = stat.last;
+            stat.max = stat.last;
+
+            double total = 0;
+
+            for(auto& sample : history) {
+                auto value = (sample.*member)[index];
+
+                stat.min = std::min(stat.min, value);
+                stat.max = std::max(stat.max, value);
+                total += value;
+            }
+
+            stat.average = total / static_cast<double>(history.size());
+        };
+
+        for(std::size_t i = 0; i < profileTimerCount; i++) {
+            calculate(stats.timers[i], &Sample::timers, i);
+        }
+
+        for(std::size_t i = 0; i < profileCounterCount; i++) {
+            calculate(stats.counters[i], &Sample::counters, i);
+        }
+
+        stats.tickCount = history.size();
+    }
+}
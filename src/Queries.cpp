@@ -0,0 +1,362 @@
+#include "PhysicsWorld.hpp"
+#include "Heightfield.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Physics {
+
+// Each job runs this many queries
+constexpr std::size_t queryGrainSize = 64;
+
+// Where a cast first touches a shape
+struct CastResult {
+    bool hits = false;
+    float distance = 0;
+    glm::vec3 normal = {};
+};
+
+static CastResult CastAgainstSphere(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, glm::vec3 center, float sphereRadius) noexcept {
+    auto offset = origin - center;
+    auto totalRadius = radius + sphereRadius;
+
+    // Solves |offset + direction * t| = totalRadius, with |direction| = 1
+    auto b = glm::dot(offset, direction);
+    auto c = glm::dot(offset, offset) - totalRadius * totalRadius;
+
+    // Starts inside the sphere, or is moving away from it
+    if(c < 0 || b > 0) return {};
+
+    auto discriminant = b * b - c;
+
+    if(discriminant < 0) return {};
+
+    auto distance = -b - std::sqrt(discriminant);
+
+    if(distance > maxDistance) return {};
+
+    return {true, distance, glm::normalize(offset + direction * distance)};
+}
+
+// Like continuous collision, casts against boxes use the bounding box of the sphere
+static CastResult CastAgainstBox(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, const AABB& box) noexcept {
+    auto min = box.min - radius;
+    auto max = box.max + radius;
+
+    float entry = -std::numeric_limits<float>::infinity();
+    float exit = maxDistance;
+    int entryAxis = 0;
+
+    for(int axis = 0; axis < 3; axis++) {
+        if(direction[axis] == 0) {
+            if(origin[axis] <= min[axis] || origin[axis] >= max[axis]) return {};
+
+            continue;
+        }
+
+        auto distance1 = (min[axis] - origin[axis]) / direction[axis];
+        auto distance2 = (max[axis] - origin[axis]) / direction[axis];
+
+        auto axisEntry = std::min(distance1, distance2);
+
+        if(axisEntry > entry) {
+            entry = axisEntry;
+            entryAxis = axis;
+        }
+
+        exit = std::min(exit, std::max(distance1, distance2));
+    }
+
+    // Starts inside the box, or misses it
+    if(entry < 0 || entry >= exit) return {};
+
+    glm::vec3 normal = {};
+    normal[entryAxis] = direction[entryAxis] > 0 ? -1.0f : 1.0f;
+
+    return {true, entry, normal};
+}
+
+static CastResult CastAgainstPlane(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, float planeHeight) noexcept {
+    auto height = origin.y - planeHeight;
+
+    if(std::abs(height) < radius) return {};
+
+    // The side of the plane the cast starts on
+    float side = height > 0 ? 1.0f : -1.0f;
+
+    if(direction.y * side >= 0) return {};
+
+    auto distance = (side * radius - height) / direction.y;
+
+    if(distance > maxDistance) return {};
+
+    return {true, distance, {0, side, 0}};
+}
+
+static const Heightfield& GetHeightfield(const BodyStore& bodies, std::uint32_t index) noexcept {
+    return static_cast<const HeightfieldCollider*>(bodies.colliders[index])->GetHeightfield();
+}
+
+// Where the heightfield's first sample would be if its height was 0
+static glm::vec3 GetHeightfieldOrigin(const BodyStore& bodies, std::uint32_t index) noexcept {
+    return bodies.positions[index] - bodies.extents[index] - glm::vec3{0, GetHeightfield(bodies, index).GetMinHeight(), 0};
+}
+
+// Sphere casts cast the lowest point of the sphere, so they can pass closer to steep slopes than the sphere would
+static CastResult CastAgainstHeightfield(glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance, const Heightfield& heightfield, glm::vec3 heightfieldOrigin) noexcept {
+    auto lowest = origin - heightfieldOrigin - glm::vec3{0, radius, 0};
+    auto distance = heightfield.Raycast(lowest, direction, maxDistance);
+
+    if(std::isinf(distance)) return {};
+
+    auto point = lowest + direction * distance;
+
+    return {true, distance, heightfield.GetSurfaceNormal(point.x, point.z)};
+}
+
+static CastResult CastAgainstBody(const BodyStore& bodies, std::uint32_t index, glm::vec3 origin, glm::vec3 direction, float radius, float maxDistance) noexcept {
+    auto position = bodies.positions[index];
+
+    switch(bodies.typeIndices[index]) {
+    case colliderTypeIndex<SphereCollider>:
+        return CastAgainstSphere(origin, direction, radius, maxDistance, position, bodies.sizes[index].x / 2);
+    case colliderTypeIndex<SimplePlaneCollider>:
+        return CastAgainstPlane(origin, direction, radius, maxDistance, position.y);
+    case colliderTypeIndex<HeightfieldCollider>:
+        return CastAgainstHeightfield(origin, direction, radius, maxDistance, GetHeightfield(bodies, index), GetHeightfieldOrigin(bodies, index));
+    default:
+        return CastAgainstBox(origin, direction, radius, maxDistance, {position - bodies.extents[index], position + bodies.extents[index]});
+    }
+}
+
+static bool Overlaps(const BodyStore& bodies, std::uint32_t index, const SphereOverlap& sphere) noexcept {
+    auto position = bodies.positions[index];
+
+    switch(bodies.typeIndices[index]) {
+    case colliderTypeIndex<SphereCollider>: {
+        auto radius = sphere.radius + bodies.sizes[index].x / 2;
+        auto offset = sphere.center - position;
+
+        return glm::dot(offset, offset) < radius * radius;
+    }
+    case colliderTypeIndex<SimplePlaneCollider>:
+        return std::abs(sphere.center.y - position.y) < sphere.radius;
+    case colliderTypeIndex<HeightfieldCollider>:
+        return GetHeightfield(bodies, index).CollideSphere(sphere.center - GetHeightfieldOrigin(bodies, index), sphere.radius).collides;
+    default: {
+        // The closest point in the box to the sphere's center
+        auto closest = glm::clamp(sphere.center, position - bodies.extents[index], position + bodies.extents[index]);
+        auto offset = sphere.center - closest;
+
+        return glm::dot(offset, offset) < sphere.radius * sphere.radius;
+    }
+    }
+}
+
+static bool Overlaps(const BodyStore& bodies, std::uint32_t index, const BoxOverlap& box) noexcept {
+    auto position = bodies.positions[index];
+
+    switch(bodies.typeIndices[index]) {
+    case colliderTypeIndex<SphereCollider>: {
+        auto radius = bodies.sizes[index].x / 2;
+        auto closest = glm::clamp(position, box.bounds.min, box.bounds.max);
+        auto offset = position - closest;
+
+        return glm::dot(offset, offset) < radius * radius;
+    }
+    case colliderTypeIndex<SimplePlaneCollider>:
+        return box.bounds.min.y < position.y && box.bounds.max.y > position.y;
+    case colliderTypeIndex<HeightfieldCollider>: {
+        // Everything under the surface is inside the heightfield, so the box overlaps it if its bottom is below the surface
+        auto min = box.bounds.min - GetHeightfieldOrigin(bodies, index);
+        auto max = box.bounds.max - GetHeightfieldOrigin(bodies, index);
+
+        return GetHeightfield(bodies, index).GetHighestPoint(min.x, min.z, max.x, max.z) > min.y;
+    }
+    default:
+        return box.bounds.Overlaps({position - bodies.extents[index], position + bodies.extents[index]});
+    }
+}
+
+static AABB GetBounds(const SphereOverlap& sphere) noexcept {
+    return {sphere.center - sphere.radius, sphere.center + sphere.radius};
+}
+
+static AABB GetBounds(const BoxOverlap& box) noexcept {
+    return box.bounds;
+}
+
+// Runs find(query, results) for each query, and joins the results in the order of the queries
+template<typename Query, typename Result, typename Find>
+static void FindAll(JobSystem* jobSystem, std::span<const Query> queries, std::vector<Result>& results, std::vector<std::size_t>& offsets, std::vector<std::vector<Result>>& rangeResults, Find&& find) {
+    offsets.assign(queries.size() + 1, 0);
+    rangeResults.resize((queries.size() + queryGrainSize - 1) / queryGrainSize);
+
+    ParallelFor(jobSystem, queries.size(), queryGrainSize, [&](std::size_t begin, std::size_t end) {
+        auto& found = rangeResults[begin / queryGrainSize];
+
+        found.clear();
+
+        for(auto i = begin; i < end; i++) {
+            auto firstResult = found.size();
+
+            find(queries[i], found);
+
+            offsets[i + 1] = found.size() - firstResult;
+        }
+    });
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    results.clear();
+
+    for(auto& found : rangeResults) {
+        results.insert(results.end(), found.begin(), found.end());
+    }
+}
+
+void PhysicsWorld::UpdateQueryTree() {
+    if(!queryTreeDirty) return;
+
+    bodies.CalculateBounds(bounds);
+    queryTree.Build(bounds);
+
+    queryTreeDirty = false;
+}
+
+QueryHit PhysicsWorld::CastClosest(glm::vec3 origin, float radius, glm::vec3 direction, float maxDistance, std::uint32_t layerMask) const noexcept {
+    auto inverseDirection = 1.0f / direction;
+
+    QueryHit closest;
+    closest.distance = maxDistance;
+
+    queryTree.Query([&](const AABB& nodeBounds) {
+        return RayIntersectsAABB({nodeBounds.min - radius, nodeBounds.max + radius}, origin, inverseDirection, closest.distance);
+    }, [&](std::uint32_t index) {
+        if(!(bodies.categories[index] & layerMask)) return;
+
+        auto result = CastAgainstBody(bodies, index, origin, direction, radius, closest.distance);
+
+        if(!result.hits) return;
+
+        // Ties go to the smallest index, so the result doesn't depend on the order of the tree
+        auto body = handles.GetHandle(bodies.handleSlots[index]);
+
+        if(closest.body.IsValid() && result.distance == closest.distance && handles.GetIndex(closest.body) < index) return;
+
+        closest.body = body;
+        closest.distance = result.distance;
+        closest.normal = result.normal;
+        closest.point = origin + direction * result.distance - result.normal * radius;
+    });
+
+    return closest;
+}
+
+void PhysicsWorld::CastAll(const Ray& ray, std::vector<QueryHit>& hits) const {
+    auto inverseDirection = 1.0f / ray.direction;
+
+    auto firstHit = hits.size();
+
+    queryTree.Query([&](const AABB& nodeBounds) {
+        return RayIntersectsAABB(nodeBounds, ray.origin, inverseDirection, ray.maxDistance);
+    }, [&](std::uint32_t index) {
+        if(!(bodies.categories[index] & ray.layerMask)) return;
+
+        auto result = CastAgainstBody(bodies, index, ray.origin, ray.direction, 0, ray.maxDistance);
+
+        if(!result.hits) return;
+
+        hits.push_back({handles.GetHandle(bodies.handleSlots[index]), result.distance, ray.origin + ray.direction * result.distance, result.normal});
+    });
+
+    std::sort(hits.begin() + static_cast<std::ptrdiff_t>(firstHit), hits.end(), [&](const QueryHit& hit1, const QueryHit& hit2) {
+        if(hit1.distance != hit2.distance) return hit1.distance < hit2.distance;
+
+        return handles.GetIndex(hit1.body) < handles.GetIndex(hit2.body);
+    });
+}
+
+template<typename Shape>
+void PhysicsWorld::FindOverlaps(const Shape& shape, std::uint32_t layerMask, std::vector<BodyHandle>& found) const {
+    auto shapeBounds = GetBounds(shape);
+
+    auto firstFound = found.size();
+
+    queryTree.Query([&](const AABB& nodeBounds) {
+        return nodeBounds.Overlaps(shapeBounds);
+    }, [&](std::uint32_t index) {
+        if(!(bodies.categories[index] & layerMask)) return;
+
+        if(Overlaps(bodies, index, shape)) {
+            found.push_back(handles.GetHandle(bodies.handleSlots[index]));
+        }
+    });
+
+    // In the order the world stores the bodies, instead of the order of the tree
+    std::sort(found.begin() + static_cast<std::ptrdiff_t>(firstFound), found.end(), [&](BodyHandle body1, BodyHandle body2) {
+        return handles.GetIndex(body1) < handles.GetIndex(body2);
+    });
+}
+
+QueryHit PhysicsWorld::Raycast(const Ray& ray) {
+    UpdateQueryTree();
+
+    return CastClosest(ray.origin, 0, ray.direction, ray.maxDistance, ray.layerMask);
+}
+
+QueryHit PhysicsWorld::CastSphere(const SphereCast& cast) {
+    UpdateQueryTree();
+
+    return CastClosest(cast.origin, cast.radius, cast.direction, cast.maxDistance, cast.layerMask);
+}
+
+void PhysicsWorld::Raycast(std::span<const Ray> rays, std::span<QueryHit> hits) {
+    UpdateQueryTree();
+
+    ParallelFor(jobSystem, rays.size(), queryGrainSize, [&](std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; i++) {
+            hits[i] = CastClosest(rays[i].origin, 0, rays[i].direction, rays[i].maxDistance, rays[i].layerMask);
+        }
+    });
+}
+
+void PhysicsWorld::CastSphere(std::span<const SphereCast> casts, std::span<QueryHit> hits) {
+    UpdateQueryTree();
+
+    ParallelFor(jobSystem, casts.size(), queryGrainSize, [&](std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; i++) {
+            hits[i] = CastClosest(casts[i].origin, casts[i].radius, casts[i].direction, casts[i].maxDistance, casts[i].layerMask);
+        }
+    });
+}
+
+void PhysicsWorld::RaycastAll(std::span<const Ray> rays, std::vector<QueryHit>& hits, std::vector<std::size_t>& offsets) {
+    UpdateQueryTree();
+
+    FindAll(jobSystem, rays, hits, offsets, rangeHits, [&](const Ray& ray, std::vector<QueryHit>& found) {
+        CastAll(ray, found);
+    });
+}
+
+void PhysicsWorld::Overlap(std::span<const SphereOverlap> spheres, std::vector<BodyHandle>& found, std::vector<std::size_t>& offsets) {
+    UpdateQueryTree();
+
+    FindAll(jobSystem, spheres, found, offsets, rangeBodies, [&](const SphereOverlap& sphere, std::vector<BodyHandle>& sphereFound) {
+        FindOverlaps(sphere, sphere.layerMask, sphereFound);
+    });
+}
+
+void PhysicsWorld::Overlap(std::span<const BoxOverlap> boxes, std::vector<BodyHandle>& found, std::vector<std::size_t>& offsets) {
+    UpdateQueryTree();
+
+    FindAll(jobSystem, boxes, found, offsets, rangeBodies, [&](const BoxOverlap& box, std::vector<BodyHandle>& boxFound) {
+        FindOverlaps(box, box.layerMask, boxFound);
+    });
+}
+
+}
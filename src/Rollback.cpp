@@ -0,0 +1,71 @@
+#include "Rollback.hpp"
+
+#include <algorithm>
+
+namespace Physics {
+    void RollbackBuffer::SetCapacity(std::size_t capacity) {
+        frames.resize(capacity);
+
+        Clear();
+    }
+
+    void RollbackBuffer::Save(const BodyStore& bodies, std::span<const TouchingPair> touchingPairs, std::uint64_t tick, double lastUpdate, std::uint64_t staticChanges) {
+        if(frames.empty()) return;
+
+        auto& frame = frames[nextFrame];
+
+        frame.tick = tick;
+        frame.lastUpdate = lastUpdate;
+        frame.staticChanges = staticChanges;
+
+        // Assigning reuses the frame's storage
+        frame.positions.assign(bodies.positions.begin(), bodies.positions.end());
+        frame.previousPositions.assign(bodies.previousPositions.begin(), bodies.previousPositions.end());
+        frame.velocities.assign(bodies.velocities.begin(), bodies.velocities.end());
+        frame.awakeFlags.assign(bodies.awakeFlags.begin(), bodies.awakeFlags.end());
+        frame.sleepTimes.assign(bodies.sleepTimes.begin(), bodies.sleepTimes.end());
+        frame.tickLevels.assign(bodies.tickLevels.begin(), bodies.tickLevels.end());
+        frame.pendingTicks.assign(bodies.pendingTicks.begin(), bodies.pendingTicks.end());
+        frame.touchingPairs.assign(touchingPairs.begin(), touchingPairs.end());
+
+        nextFrame = (nextFrame + 1) % frames.size();
+        frameCount = std::min(frameCount + 1, frames.size());
+    }
+
+    const RollbackFrame* RollbackBuffer::Find(std::uint64_t tick) const noexcept {
+        for(std::size_t i = 1; i <= frameCount; i++) {
+            auto& frame = frames[(nextFrame + frames.size() - i) % frames.size()];
+
+            if(frame.tick == tick) return &frame;
+        }
+
+        return nullptr;
+    }
+
+    void RollbackBuffer::DiscardFrom(std::uint64_t tick) noexcept {
+        // Frames are saved in order, so the newest ones are discarded until one is older than tick
+        while(frameCount > 0) {
+            auto newest = (nextFrame + frames.size() - 1) % frames.size();
+
+            if(frames[newest].tick < tick) break;
+
+            nextFrame = newest;
+            frameCount--;
+        }
+    }
+
+    void RollbackBuffer::Clear() noexcept {
+        nextFrame = 0;
+        frameCount = 0;
+    }
+
+    void RollbackBuffer::Restore(BodyStore& bodies, const RollbackFrame& frame) {
+        bodies.positions.assign(frame.positions.begin(), frame.positions.end());
+        bodies.previousPositions.assign(frame.previousPositions.begin(), frame.previousPositions.end());
+        bodies.velocities.assign(frame.velocities.begin(), frame.velocities.end());
+        bodies.awakeFlags.assign(frame.awakeFlags.begin(), frame.awakeFlags.end());
+        bodies.sleepTimes.assign(frame.sleepTimes.begin(), frame.sleepTimes.end());
+        bodies.tickLevels.assign(frame.tickLevels.begin(), frame.tickLevels.end());
+        bodies.pendingTicks.assign(frame.pendingTicks.begin(), frame.pendingTicks.end());
+    }
+}
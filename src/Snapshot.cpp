@@ -0,0 +1,407 @@
+#include "PhysicsWorld.hpp"
+
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Physics {
+
+// Bodies and handle slots are written in chunks of this many records
+constexpr std::size_t snapshotChunkSize = 256;
+
+template<typename T>
+static T ConstructCollider(const BodySnapshot& body) {
+    if constexpr(std::is_same_v<T, SimplePlaneCollider>) {
+        return T{body.position.y};
+    } else if constexpr(std::is_same_v<T, SphereCollider>) {
+        return T{body.position, body.size.x, body.velocity};
+    } else if constexpr(std::is_same_v<T, HeightfieldCollider>) {
+        // Snapshots don't store heights, and Create and RestoreSnapshot reject heightfields before getting here
+        throw std::invalid_argument{"Heightfields can't be restored from a snapshot"};
+    } else {
+        return T{body.position, body.size, body.velocity};
+    }
+}
+
+template<typename T>
+static T RestoreCollider(const BodySnapshot& body) {
+    auto collider = ConstructCollider<T>(body);
+
+    collider.position = body.position;
+    collider.size = body.size;
+    collider.mass = body.mass;
+    collider.restitution = body.restitution;
+    collider.hasGravity = body.flags & BodySnapshot::HasGravity;
+    collider.isStatic = body.flags & BodySnapshot::IsStatic;
+    collider.continuousCollision = body.flags & BodySnapshot::ContinuousCollision;
+    collider.category = body.category;
+    collider.mask = body.mask;
+    collider.group = body.group;
+
+    return collider;
+}
+
+BodySnapshot SnapshotCollider(const Collider& collider) noexcept {
+    // Zeroes the padding, so the same collider always gives the same bytes
+    BodySnapshot body{};
+
+    body.position = collider.position;
+    body.previousPosition = collider.position;
+    body.velocity = collider.velocity;
+    body.size = collider.size;
+    body.mass = collider.mass;
+    body.restitution = collider.restitution;
+    body.handleSlot = BodyHandle::invalidIndex;
+    body.category = collider.category;
+    body.mask = collider.mask;
+    body.group = collider.group;
+    body.typeIndex = collider.GetTypeIndex();
+
+    if(collider.hasGravity) body.flags |= BodySnapshot::HasGravity;
+    if(collider.isStatic) body.flags |= BodySnapshot::IsStatic;
+    if(collider.continuousCollision) body.flags |= BodySnapshot::ContinuousCollision;
+    if(!collider.isStatic) body.flags |= BodySnapshot::Awake;
+
+    return body;
+}
+
+// Copies a record out of the snapshot, which may not be aligned
+template<typename T>
+static T ReadRecord(std::span<const std::byte> data, std::uint64_t offset, std::size_t index) noexcept {
+    T record;
+    std::memcpy(&record, data.data() + offset + index * sizeof(T), sizeof(T));
+
+    return record;
+}
+
+BodySnapshot PhysicsWorld::SaveBody(std::uint32_t index) const noexcept {
+    auto& collider = *bodies.colliders[index];
+
+    // Zeroes the padding, so the same world always gives the same bytes
+    BodySnapshot body{};
+
+    body.position = bodies.positions[index];
+    body.previousPosition = bodies.previousPositions[index];
+    body.velocity = bodies.velocities[index];
+    body.size = bodies.sizes[index];
+    body.mass = collider.mass;
+    body.restitution = bodies.restitutions[index];
+    body.sleepTime = bodies.sleepTimes[index];
+    body.handleSlot = bodies.handleSlots[index];
+    body.category = bodies.categories[index];
+    body.mask = bodies.masks[index];
+    body.group = bodies.groups[index];
+    body.pendingTicks = bodies.pendingTicks[index];
+    body.tickLevel = bodies.tickLevels[index];
+    body.typeIndex = bodies.typeIndices[index];
+
+    if(collider.hasGravity) body.flags |= BodySnapshot::HasGravity;
+    if(collider.isStatic) body.flags |= BodySnapshot::IsStatic;
+    if(collider.continuousCollision) body.flags |= BodySnapshot::ContinuousCollision;
+    if(bodies.awakeFlags[index]) body.flags |= BodySnapshot::Awake;
+
+    return body;
+}
+
+void PhysicsWorld::RestoreBodyState(std::uint32_t index, const BodySnapshot& body) noexcept {
+    bodies.previousPositions[index] = body.previousPosition;
+    bodies.awakeFlags[index] = !(body.flags & BodySnapshot::IsStatic) && (body.flags & BodySnapshot::Awake);
+    bodies.sleepTimes[index] = body.sleepTime;
+    bodies.tickLevels[index] = std::min(body.tickLevel, maxTickLevel);
+    bodies.pendingTicks[index] = bodies.awakeFlags[index] ? body.pendingTicks : 0;
+}
+
+BodySnapshot PhysicsWorld::GetBodySnapshot(BodyHandle body) const noexcept {
+    return SaveBody(handles.GetIndex(body));
+}
+
+BodyHandle PhysicsWorld::Create(const BodySnapshot& body) {
+    if(body.typeIndex >= colliderTypeCount || body.typeIndex == colliderTypeIndex<HeightfieldCollider>) {
+        throw std::invalid_argument{"The body has an invalid collider type"};
+    }
+
+    BodyHandle handle;
+
+    // Calls Create for the body's collider type
+    [&]<typename... Types>(TypeList<Types...>) {
+        static_cast<void>(((body.typeIndex == colliderTypeIndex<Types> && (handle = Create(RestoreCollider<Types>(body)), true)) || ...));
+    }(ColliderTypes{});
+
+    RestoreBodyState(handles.GetIndex(handle), body);
+
+    return handle;
+}
+
+void PhysicsWorld::WriteSnapshot(std::ostream& stream) const {
+    auto slots = handles.GetSlots();
+
+    for(std::size_t i = 0; i < bodies.Size(); i++) {
+        if(bodies.typeIndices[i] == colliderTypeIndex<HeightfieldCollider>) {
+            throw std::runtime_error{"Worlds with heightfields can't be saved in a snapshot"};
+        }
+    }
+
+    // Pairs with a body destroyed since the last tick only report an End event, which isn't kept
+    auto touchingPairs = contactTracker.GetTouchingPairs();
+
+    auto isStored = [&](const TouchingPair& pair) {
+        return handles.Contains(pair.body1) && handles.Contains(pair.body2);
+    };
+
+    SnapshotHeader header{};
+
+    header.magic = snapshotMagic;
+    header.version = snapshotVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.bodySize = sizeof(BodySnapshot);
+    header.slotSize = sizeof(HandleSlotSnapshot);
+    header.contactSize = sizeof(ContactSnapshot);
+    header.firstFreeSlot = handles.GetFirstFreeSlot();
+    header.bodyCount = bodies.Size();
+    header.slotCount = slots.size();
+    header.contactCount = static_cast<std::uint64_t>(std::ranges::count_if(touchingPairs, isStored));
+    header.bodiesOffset = sizeof(SnapshotHeader);
+    header.slotsOffset = header.bodiesOffset + header.bodyCount * sizeof(BodySnapshot);
+    header.contactsOffset = header.slotsOffset + header.slotCount * sizeof(HandleSlotSnapshot);
+    header.tick = currentTick;
+    header.lastUpdate = lastUpdate;
+    header.droppedTime = droppedTime;
+    header.gravity = gravityVector;
+    header.tickRate = tickRate;
+    header.sleepVelocity = sleepVelocity;
+    header.sleepTime = sleepTime;
+    header.sleepingEnabled = sleepingEnabled;
+    header.solverIterations = static_cast<std::uint32_t>(solverSettings.iterations);
+    header.warmStarting = solverSettings.warmStarting;
+    header.correctionFactor = solverSettings.correctionFactor;
+    header.allowedPenetration = solverSettings.allowedPenetration;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::array<BodySnapshot, snapshotChunkSize> bodyChunk;
+
+    for(std::size_t begin = 0; begin < bodies.Size(); begin += snapshotChunkSize) {
+        auto count = std::min(snapshotChunkSize, bodies.Size() - begin);
+
+        for(std::size_t i = 0; i < count; i++) {
+            bodyChunk[i] = SaveBody(static_cast<std::uint32_t>(begin + i));
+        }
+
+        stream.write(reinterpret_cast<const char*>(bodyChunk.data()), static_cast<std::streamsize>(count * sizeof(BodySnapshot)));
+    }
+
+    std::array<HandleSlotSnapshot, snapshotChunkSize> slotChunk;
+
+    for(std::size_t begin = 0; begin < slots.size(); begin += snapshotChunkSize) {
+        auto count = std::min(snapshotChunkSize, slots.size() - begin);
+
+        for(std::size_t i = 0; i < count; i++) {
+            auto& slot = slots[begin + i];
+
+            slotChunk[i] = {slot.generation, slot.index, slot.used};
+        }
+
+        stream.write(reinterpret_cast<const char*>(slotChunk.data()), static_cast<std::streamsize>(count * sizeof(HandleSlotSnapshot)));
+    }
+
+    std::array<ContactSnapshot, snapshotChunkSize> contactChunk;
+    std::size_t contactCount = 0;
+
+    // Written in the tracker's order, so events after restoring are in the same order too
+    for(auto& pair : touchingPairs) {
+        if(!isStored(pair)) continue;
+
+        contactChunk[contactCount++] = {pair.body1.index, pair.body2.index, pair.normal, pair.penetration, pair.impulse};
+
+        if(contactCount == snapshotChunkSize) {
+            stream.write(reinterpret_cast<const char*>(contactChunk.data()), static_cast<std::streamsize>(contactCount * sizeof(ContactSnapshot)));
+            contactCount = 0;
+        }
+    }
+
+    stream.write(reinterpret_cast<const char*>(contactChunk.data()), static_cast<std::streamsize>(contactCount * sizeof(ContactSnapshot)));
+
+    if(!stream) {
+        throw std::runtime_error{"Could not write the snapshot"};
+    }
+}
+
+void PhysicsWorld::SaveSnapshot(const std::filesystem::path& path) const {
+    std::ofstream stream{path, std::ios::binary};
+
+    if(!stream) {
+        throw std::runtime_error{"Could not open " + path.string()};
+    }
+
+    WriteSnapshot(stream);
+}
+
+template<typename T>
+void PhysicsWorld::RestoreBody(const BodySnapshot& body) {
+    auto& pool = std::get<colliderTypeIndex<T>>(pools);
+
+    auto poolIndex = pool.Add(RestoreCollider<T>(body), body.handleSlot);
+
+    AddBody(&pool[poolIndex], handles.GetHandle(body.handleSlot), poolIndex);
+
+    RestoreBodyState(static_cast<std::uint32_t>(bodies.Size() - 1), body);
+}
+
+void PhysicsWorld::RestoreSnapshot(std::span<const std::byte> data) {
+    if(data.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error{"The snapshot is too small"};
+    }
+
+    auto header = ReadRecord<SnapshotHeader>(data, 0, 0);
+
+    if(header.magic != snapshotMagic) {
+        throw std::runtime_error{"The data isn't a snapshot"};
+    }
+
+    if(header.version != snapshotVersion || header.headerSize != sizeof(SnapshotHeader) || header.bodySize != sizeof(BodySnapshot) || header.slotSize != sizeof(HandleSlotSnapshot) || header.contactSize != sizeof(ContactSnapshot)) {
+        throw std::runtime_error{"The snapshot's version isn't supported"};
+    }
+
+    // Written so they can't overflow
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t size) {
+        return offset <= data.size() && count <= (data.size() - offset) / size;
+    };
+
+    if(!fits(header.bodiesOffset, header.bodyCount, sizeof(BodySnapshot)) || !fits(header.slotsOffset, header.slotCount, sizeof(HandleSlotSnapshot)) ||
+       !fits(header.contactsOffset, header.contactCount, sizeof(ContactSnapshot))) {
+        throw std::runtime_error{"The snapshot is truncated"};
+    }
+
+    if(header.slotCount >= BodyHandle::invalidIndex || header.bodyCount > header.slotCount) {
+        throw std::runtime_error{"The snapshot has too many bodies"};
+    }
+
+    // Checks every record before the world is changed
+    std::array<std::size_t, colliderTypeCount> typeCounts{};
+
+    for(std::size_t i = 0; i < header.bodyCount; i++) {
+        auto body = ReadRecord<BodySnapshot>(data, header.bodiesOffset, i);
+
+        if(body.typeIndex >= colliderTypeCount || body.typeIndex == colliderTypeIndex<HeightfieldCollider> || body.handleSlot >= header.slotCount) {
+            throw std::runtime_error{"The snapshot has an invalid body"};
+        }
+
+        typeCounts[body.typeIndex]++;
+    }
+
+    std::vector<HandleTable::Slot> slots(header.slotCount);
+    std::size_t usedSlotCount = 0;
+
+    for(std::size_t i = 0; i < header.slotCount; i++) {
+        auto slot = ReadRecord<HandleSlotSnapshot>(data, header.slotsOffset, i);
+
+        slots[i] = {slot.generation, slot.index, slot.used != 0};
+
+        if(!slot.used) continue;
+
+        // Each body must have exactly one slot that refers to it
+        if(slot.index >= header.bodyCount || ReadRecord<BodySnapshot>(data, header.bodiesOffset, slot.index).handleSlot != i) {
+            throw std::runtime_error{"The snapshot has an invalid handle"};
+        }
+
+        usedSlotCount++;
+    }
+
+    if(usedSlotCount != header.bodyCount) {
+        throw std::runtime_error{"The snapshot has an invalid handle"};
+    }
+
+    // The free list must only visit free slots, and end, so creating bodies after restoring stays in bounds
+    std::size_t freeSlotCount = 0;
+
+    for(auto slot = header.firstFreeSlot; slot != BodyHandle::invalidIndex; slot = slots[slot].index) {
+        if(slot >= header.slotCount || slots[slot].used || ++freeSlotCount > header.slotCount - usedSlotCount) {
+            throw std::runtime_error{"The snapshot has an invalid free list"};
+        }
+    }
+
+    std::vector<TouchingPair> touchingPairs(header.contactCount);
+
+    for(std::size_t i = 0; i < header.contactCount; i++) {
+        auto contact = ReadRecord<ContactSnapshot>(data, header.contactsOffset, i);
+
+        // The tracker keeps the bodies of each pair in order
+        if(contact.body1Slot >= contact.body2Slot || contact.body2Slot >= header.slotCount || !slots[contact.body1Slot].used || !slots[contact.body2Slot].used) {
+            throw std::runtime_error{"The snapshot has an invalid contact"};
+        }
+
+        BodyHandle body1{contact.body1Slot, slots[contact.body1Slot].generation};
+        BodyHandle body2{contact.body2Slot, slots[contact.body2Slot].generation};
+
+        touchingPairs[i] = {body1, body2, contact.normal, contact.penetration, contact.impulse};
+    }
+
+    bodies.Clear();
+    bodies.Reserve(header.bodyCount);
+
+    // Reserving means the pools' colliders aren't moved while the bodies are added
+    [&]<typename... Types>(TypeList<Types...>) {
+        (std::get<colliderTypeIndex<Types>>(pools).Clear(), ...);
+        (std::get<colliderTypeIndex<Types>>(pools).Reserve(typeCounts[colliderTypeIndex<Types>]), ...);
+    }(ColliderTypes{});
+
+    poolIndices.assign(header.slotCount, BodyHandle::invalidIndex);
+    handles.Restore(slots, header.firstFreeSlot);
+
+    broadphase->Reset();
+    broadphaseRemap.clear();
+    broadphaseIndices.clear();
+    broadphaseBodyCount = 0;
+    bodiesRemoved = false;
+    // The old lists refer to bodies that no longer exist, and nothing in the broadphase needs remapping
+    dynamicBodies.clear();
+    dynamicIndices.clear();
+    staticBodies.clear();
+    bodyListsDirty = true;
+    staticTreeDirty = true;
+    queryTreeDirty = true;
+    // The saved frames are of the old bodies
+    rollback.Clear();
+
+    candidates.clear();
+    contacts.clear();
+    contactTracker.ClearEvents();
+    // Warm starts the first tick with the same impulses as the original world
+    contactTracker.Restore(touchingPairs);
+
+    for(std::size_t i = 0; i < header.bodyCount; i++) {
+        auto body = ReadRecord<BodySnapshot>(data, header.bodiesOffset, i);
+
+        // Calls RestoreBody for the body's collider type
+        [&]<typename... Types>(TypeList<Types...>) {
+            static_cast<void>(((body.typeIndex == colliderTypeIndex<Types> && (RestoreBody<Types>(body), true)) || ...));
+        }(ColliderTypes{});
+    }
+
+    currentTick = header.tick;
+    lastUpdate = header.lastUpdate;
+    droppedTime = header.droppedTime;
+    gravityVector = header.gravity;
+    tickRate = header.tickRate;
+    sleepVelocity = header.sleepVelocity;
+    sleepTime = header.sleepTime;
+    sleepingEnabled = header.sleepingEnabled;
+    solverSettings = {header.solverIterations, header.warmStarting != 0, header.correctionFactor, header.allowedPenetration};
+    interpolationAlpha = 0;
+
+    CountBodies();
+}
+
+void PhysicsWorld::LoadSnapshot(const std::filesystem::path& path) {
+    MappedFile file{path};
+
+    RestoreSnapshot(file.GetData());
+}
+
+}
@@ -0,0 +1,89 @@
+#include "Solver.hpp"
+
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+namespace Physics {
+    // Static bodies are shared between islands, so they must not be written to while islands are solved in parallel
+    static void ApplyImpulse(BodyStore& bodies, const Contact& contact, float impulse) noexcept {
+        auto inverseMass1 = bodies.inverseMasses[contact.index1];
+        auto inverseMass2 = bodies.inverseMasses[contact.index2];
+
+        if(inverseMass1 != 0) {
+            bodies.velocities[contact.index1] -= inverseMass1 * impulse * contact.normal;
+        }
+
+        if(inverseMass2 != 0) {
+            bodies.velocities[contact.index2] += inverseMass2 * impulse * contact.normal;
+        }
+    }
+
+    void ContactSolver::SetThreadCount(std::size_t threadCount) {
+        buffers.resize(threadCount);
+    }
+
+    void ContactSolver::Solve(BodyStore& bodies, std::span<Contact> contacts, const SolverSettings& settings, std::size_t threadIndex) {
+        auto& [targetVelocities, normalMasses] = buffers[threadIndex];
+
+        targetVelocities.resize(contacts.size());
+        normalMasses.resize(contacts.size());
+
+        for(std::size_t i = 0; i < contacts.size(); i++) {
+            auto& contact = contacts[i];
+
+            auto inverseMasses = bodies.inverseMasses[contact.index1] + bodies.inverseMasses[contact.index2];
+
+            normalMasses[i] = inverseMasses == 0 ? 0 : 1 / inverseMasses;
+
+            // Positive while the bodies move towards each other
+            auto velocity = glm::dot(bodies.velocities[contact.index1] - bodies.velocities[contact.index2], contact.normal);
+            auto restitution = std::min(bodies.restitutions[contact.index1], bodies.restitutions[contact.index2]);
+
+            // Bounces are calculated from the velocity before any impulse, so warm starting doesn't change them
+            targetVelocities[i] = -restitution * std::max(velocity, 0.0f);
+
+            if(settings.warmStarting) {
+                ApplyImpulse(bodies, contact, contact.impulse);
+            } else {
+                contact.impulse = 0;
+            }
+        }
+
+        for(std::size_t iteration = 0; iteration < settings.iterations; iteration++) {
+            for(std::size_t i = 0; i < contacts.size(); i++) {
+                auto& contact = contacts[i];
+
+                auto velocity = glm::dot(bodies.velocities[contact.index1] - bodies.velocities[contact.index2], contact.normal);
+
+                // Clamping the total instead of each impulse lets later iterations take back some of what earlier ones applied
+                auto impulse = std::max(contact.impulse + (velocity - targetVelocities[i]) * normalMasses[i], 0.0f);
+
+                ApplyImpulse(bodies, contact, impulse - contact.impulse);
+
+                contact.impulse = impulse;
+            }
+        }
+
+        if(settings.correctionFactor == 0) return;
+
+        // Moves the bodies directly instead of adding velocity, so correcting penetration doesn't make bodies bounce
+        for(auto& contact : contacts) {
+            auto depth = contact.penetration - settings.allowedPenetration;
+            auto inverseMass1 = bodies.inverseMasses[contact.index1];
+            auto inverseMass2 = bodies.inverseMasses[contact.index2];
+
+            if(depth <= 0 || inverseMass1 + inverseMass2 == 0) continue;
+
+            auto correction = depth * settings.correctionFactor / (inverseMass1 + inverseMass2) * contact.normal;
+
+            if(inverseMass1 != 0) {
+                bodies.positions[contact.index1] -= inverseMass1 * correction;
+            }
+
+            if(inverseMass2 != 0) {
+                bodies.positions[contact.index2] += inverseMass2 * correction;
+            }
+        }
+    }
+}
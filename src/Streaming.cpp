@@ -0,0 +1,495 @@
+#include "Streaming.hpp"
+
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace Physics {
+    std::size_t CellCoordHash::operator()(CellCoord cell) const noexcept {
+        auto key = static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) << 32 | static_cast<std::uint32_t>(cell.z);
+
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccd;
+        key ^= key >> 33;
+
+        return static_cast<std::size_t>(key);
+    }
+
+    // Parses the names GetCellPath gives cells
+    static std::optional<CellCoord> ParseCellName(std::string_view name) noexcept {
+        constexpr std::string_view prefix = "cell_";
+        constexpr std::string_view suffix = ".bin";
+
+        if(!name.starts_with(prefix) || !name.ends_with(suffix)) return {};
+
+        auto first = name.data() + prefix.size();
+        auto last = name.data() + name.size() - suffix.size();
+
+        CellCoord cell;
+
+        auto [xEnd, xError] = std::from_chars(first, last, cell.x);
+
+        if(xError != std::errc{} || xEnd == last || *xEnd != '_') return {};
+
+        auto [zEnd, zError] = std::from_chars(xEnd + 1, last, cell.z);
+
+        if(zError != std::errc{} || zEnd != last) return {};
+
+        return cell;
+    }
+
+    static bool IsSupportedCell(const CellHeader& header, std::uintmax_t fileSize) noexcept {
+        return header.magic == cellMagic && header.version == snapshotVersion && header.bodySize == sizeof(BodySnapshot) && (fileSize - sizeof(header)) % sizeof(BodySnapshot) == 0;
+    }
+
+    CellStreamer::CellStreamer(PhysicsWorld& world, const StreamingSettings& settings) : world{world}, settings{settings} {
+        if(!(settings.cellSize > 0) || !(settings.activationRadius >= 0) || !(settings.deactivationRadius >= settings.activationRadius)) {
+            throw std::invalid_argument{"The cell size must be positive, and the deactivation radius must be at least the activation radius"};
+        }
+
+        if(settings.maxCreatedPerUpdate == 0) {
+            throw std::invalid_argument{"Update must be able to create bodies"};
+        }
+
+        if(!settings.directory.empty()) {
+            std::filesystem::create_directories(settings.directory);
+
+            IndexStoredCells();
+        }
+
+        thread = std::jthread{[this](std::stop_token stopToken) {
+            Run(stopToken);
+        }};
+    }
+
+    CellStreamer::~CellStreamer() {
+        SubmitStores();
+
+        // The thread finishes the jobs that are left before stopping
+        thread.request_stop();
+        thread.join();
+
+        // Loading removed these bodies from storage, so the ones that weren't created yet are stored again instead of being lost
+        std::move(loaded.begin(), loaded.end(), std::back_inserter(creating));
+        loaded.clear();
+
+        for(auto& load : creating) {
+            if(load.createdCount == load.bodies.size()) continue;
+
+            try {
+                StoreCell(load.cell, std::span{load.bodies}.subspan(load.createdCount));
+            } catch(...) {
+                if(!exception) {
+                    exception = std::current_exception();
+                }
+            }
+        }
+
+        if(exception) {
+            try {
+                std::rethrow_exception(exception);
+            } catch(const std::exception& e) {
+                spdlog::error("Could not store a cell: {}", e.what());
+            } catch(...) {
+                spdlog::error("Could not store a cell");
+            }
+        }
+    }
+
+    void CellStreamer::Run(std::stop_token stopToken) {
+        std::unique_lock lock{mutex};
+
+        while(true) {
+            // Returns false once stopping with no jobs left
+            if(!jobAdded.wait(lock, stopToken, [&] { return !jobs.empty(); })) break;
+
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+
+            running = true;
+            lock.unlock();
+
+            std::exception_ptr jobException;
+            std::vector<BodySnapshot> bodies;
+
+            try {
+                if(job.type == JobType::Store) {
+                    StoreCell(job.cell, job.bodies);
+                } else {
+                    bodies = LoadCell(job.cell);
+                }
+            } catch(...) {
+                jobException = std::current_exception();
+            }
+
+            lock.lock();
+            running = false;
+
+            if(jobException && !exception) {
+                exception = jobException;
+            }
+
+            // A cell that couldn't be read is still finished loading, with no bodies, so it doesn't stay loading forever
+            if(job.type == JobType::Load) {
+                loaded.push_back({job.cell, std::move(bodies)});
+            }
+
+            jobsFinished.notify_all();
+        }
+    }
+
+    std::filesystem::path CellStreamer::GetCellPath(CellCoord cell) const {
+        return settings.directory / ("cell_" + std::to_string(cell.x) + "_" + std::to_string(cell.z) + ".bin");
+    }
+
+    void CellStreamer::StoreCell(CellCoord cell, std::span<const BodySnapshot> bodies) {
+        if(settings.directory.empty()) {
+            auto& stored = memoryCells[cell];
+            stored.insert(stored.end(), bodies.begin(), bodies.end());
+
+            return;
+        }
+
+        auto path = GetCellPath(cell);
+        bool exists = std::filesystem::exists(path);
+
+        // Stored bodies are appended, so bodies that moved into an inactive cell don't need it to be read first
+        std::ofstream stream{path, std::ios::binary | std::ios::app};
+
+        if(!stream) {
+            throw std::runtime_error{"Could not open " + path.string()};
+        }
+
+        if(!exists) {
+            CellHeader header{cellMagic, snapshotVersion, sizeof(BodySnapshot), 0};
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        stream.write(reinterpret_cast<const char*>(bodies.data()), static_cast<std::streamsize>(bodies.size_bytes()));
+
+        if(!stream) {
+            throw std::runtime_error{"Could not write " + path.string()};
+        }
+    }
+
+    void CellStreamer::IndexStoredCells() {
+        for(auto& entry : std::filesystem::directory_iterator{settings.directory}) {
+            auto cell = ParseCellName(entry.path().filename().string());
+
+            // Other files in the directory are left alone
+            if(!cell || !entry.is_regular_file()) continue;
+
+            auto path = entry.path();
+            auto size = entry.file_size();
+
+            CellHeader header;
+
+            std::ifstream stream{path, std::ios::binary};
+
+            if(!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || !IsSupportedCell(header, size)) {
+                throw std::runtime_error{path.string() + " isn't a supported cell"};
+            }
+
+            // A file without bodies isn't read, and bodies stored in the cell are appended to it
+            cells[*cell].storedCount = (size - sizeof(header)) / sizeof(BodySnapshot);
+        }
+    }
+
+    std::vector<BodySnapshot> CellStreamer::LoadCell(CellCoord cell) {
+        std::vector<BodySnapshot> bodies;
+
+        if(settings.directory.empty()) {
+            auto found = memoryCells.find(cell);
+
+            if(found != memoryCells.end()) {
+                bodies = std::move(found->second);
+                memoryCells.erase(found);
+            }
+
+            return bodies;
+        }
+
+        auto path = GetCellPath(cell);
+
+        {
+            MappedFile file{path};
+            auto data = file.GetData();
+
+            CellHeader header;
+
+            if(data.size() < sizeof(header)) {
+                throw std::runtime_error{path.string() + " isn't a cell"};
+            }
+
+            std::memcpy(&header, data.data(), sizeof(header));
+
+            if(!IsSupportedCell(header, data.size())) {
+                throw std::runtime_error{path.string() + " isn't a supported cell"};
+            }
+
+            bodies.resize((data.size() - sizeof(header)) / sizeof(BodySnapshot));
+
+            // The records may not be aligned
+            std::memcpy(bodies.data(), data.data() + sizeof(header), bodies.size() * sizeof(BodySnapshot));
+        }
+
+        // The bodies are in the world from now on, and are stored again when the cell is unloaded
+        std::filesystem::remove(path);
+
+        return bodies;
+    }
+
+    CellCoord CellStreamer::GetCell(glm::vec3 position) const noexcept {
+        return {static_cast<std::int32_t>(std::floor(position.x / settings.cellSize)), static_cast<std::int32_t>(std::floor(position.z / settings.cellSize))};
+    }
+
+    float CellStreamer::GetDistance(CellCoord cell, glm::vec3 point) const noexcept {
+        auto minX = static_cast<float>(cell.x) * settings.cellSize;
+        auto minZ = static_cast<float>(cell.z) * settings.cellSize;
+
+        auto dx = point.x - std::clamp(point.x, minX, minX + settings.cellSize);
+        auto dz = point.z - std::clamp(point.z, minZ, minZ + settings.cellSize);
+
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    template<typename T>
+    BodyHandle CellStreamer::AddCollider(const T& collider) {
+        auto coord = GetCell(collider.position);
+        auto& cell = cells[coord];
+
+        if(cell.state == CellState::Inactive) {
+            pendingStores[coord].push_back(SnapshotCollider(collider));
+            cell.storedCount++;
+
+            return {};
+        }
+
+        auto body = world.Create(collider);
+        cell.bodies.push_back(body);
+
+        return body;
+    }
+
+    BodyHandle CellStreamer::Add(const SphereCollider& collider) {
+        return AddCollider(collider);
+    }
+
+    BodyHandle CellStreamer::Add(const SimpleCubeCollider& collider) {
+        return AddCollider(collider);
+    }
+
+    void CellStreamer::Activate(CellCoord coord) {
+        auto& cell = cells[coord];
+
+        if(cell.state != CellState::Inactive) return;
+
+        residentCells.push_back(coord);
+
+        // Nothing to read
+        if(cell.storedCount == 0) {
+            cell.state = CellState::Active;
+            return;
+        }
+
+        cell.state = CellState::Loading;
+        cell.storedCount = 0;
+
+        {
+            std::scoped_lock lock{mutex};
+            jobs.push_back({JobType::Load, coord, {}});
+        }
+
+        jobAdded.notify_one();
+    }
+
+    void CellStreamer::Deactivate(CellCoord coord) {
+        auto& cell = cells[coord];
+
+        cell.state = CellState::Inactive;
+
+        auto resident = std::ranges::find(residentCells, coord);
+        *resident = residentCells.back();
+        residentCells.pop_back();
+
+        auto cellBodies = std::move(cell.bodies);
+        cell.bodies.clear();
+
+        for(auto body : cellBodies) {
+            // Bodies destroyed by the user aren't stored
+            if(!world.IsValid(body)) continue;
+
+            auto destination = GetCell(world.GetPosition(body));
+            auto& destinationCell = cells[destination];
+
+            // The body moved into a cell that is still in the world
+            if(destinationCell.state != CellState::Inactive) {
+                destinationCell.bodies.push_back(body);
+                continue;
+            }
+
+            pendingStores[destination].push_back(world.GetBodySnapshot(body));
+            destinationCell.storedCount++;
+
+            world.Destroy(body);
+        }
+
+        // Keeps the map from growing with every empty cell a focus point passes through
+        if(cell.storedCount == 0) {
+            cells.erase(coord);
+        }
+    }
+
+    void CellStreamer::SubmitStores() {
+        if(pendingStores.empty()) return;
+
+        {
+            std::scoped_lock lock{mutex};
+
+            for(auto& [cell, bodies] : pendingStores) {
+                jobs.push_back({JobType::Store, cell, std::move(bodies)});
+            }
+        }
+
+        pendingStores.clear();
+
+        jobAdded.notify_one();
+    }
+
+    void CellStreamer::CreateLoadedBodies() {
+        {
+            std::scoped_lock lock{mutex};
+
+            std::move(loaded.begin(), loaded.end(), std::back_inserter(creating));
+            loaded.clear();
+        }
+
+        auto budget = settings.maxCreatedPerUpdate;
+
+        while(!creating.empty() && budget > 0) {
+            auto& load = creating.front();
+            auto& cell = cells[load.cell];
+
+            auto count = std::min(budget, load.bodies.size() - load.createdCount);
+
+            for(std::size_t i = 0; i < count; i++) {
+                cell.bodies.push_back(world.Create(load.bodies[load.createdCount + i]));
+            }
+
+            load.createdCount += count;
+            budget -= count;
+
+            if(load.createdCount == load.bodies.size()) {
+                SPDLOG_DEBUG("Loaded cell ({}, {}) with {} bodies", load.cell.x, load.cell.z, load.bodies.size());
+
+                cell.state = CellState::Active;
+                creating.pop_front();
+            }
+        }
+    }
+
+    void CellStreamer::RethrowException() {
+        std::exception_ptr thrown;
+
+        {
+            std::scoped_lock lock{mutex};
+            thrown = std::exchange(exception, nullptr);
+        }
+
+        if(thrown) {
+            std::rethrow_exception(thrown);
+        }
+    }
+
+    void CellStreamer::Update(std::span<const glm::vec3> focusPoints) {
+        // Bodies added since the last update must be stored before their cells are loaded
+        SubmitStores();
+
+        CreateLoadedBodies();
+
+        auto reach = static_cast<std::int32_t>(std::ceil(settings.activationRadius / settings.cellSize));
+
+        for(auto point : focusPoints) {
+            auto center = GetCell(point);
+
+            for(auto x = center.x - reach; x <= center.x + reach; x++) {
+                for(auto z = center.z - reach; z <= center.z + reach; z++) {
+                    if(GetDistance({x, z}, point) <= settings.activationRadius) {
+                        Activate({x, z});
+                    }
+                }
+            }
+        }
+
+        // Loading cells are unloaded once they finish, so their bodies aren't created after being stored
+        unloading.clear();
+
+        for(auto coord : residentCells) {
+            if(cells[coord].state != CellState::Active) continue;
+
+            bool near = std::ranges::any_of(focusPoints, [&](glm::vec3 point) {
+                return GetDistance(coord, point) <= settings.deactivationRadius;
+            });
+
+            if(!near) {
+                unloading.push_back(coord);
+            }
+        }
+
+        // Unloading changes other cells, so the map can't be iterated at the same time
+        for(auto coord : unloading) {
+            Deactivate(coord);
+        }
+
+        SubmitStores();
+
+        RethrowException();
+    }
+
+    void CellStreamer::Flush() {
+        SubmitStores();
+
+        {
+            std::unique_lock lock{mutex};
+
+            jobsFinished.wait(lock, [&] { return jobs.empty() && !running; });
+        }
+
+        RethrowException();
+    }
+
+    CellState CellStreamer::GetState(CellCoord cell) const noexcept {
+        auto found = cells.find(cell);
+
+        return found == cells.end() ? CellState::Inactive : found->second.state;
+    }
+
+    std::size_t CellStreamer::GetActiveCellCount() const noexcept {
+        return static_cast<std::size_t>(std::ranges::count_if(residentCells, [&](CellCoord cell) {
+            return cells.at(cell).state == CellState::Active;
+        }));
+    }
+
+    std::size_t CellStreamer::GetActiveBodyCount() const noexcept {
+        std::size_t count = 0;
+
+        for(auto cell : residentCells) {
+            count += cells.at(cell).bodies.size();
+        }
+
+        return count;
+    }
+}
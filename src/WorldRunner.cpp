@@ -0,0 +1,53 @@
+#include "WorldRunner.hpp"
+
+#include <chrono>
+
+namespace Physics {
+    // Small worlds tick quickly, so each job runs a few of them
+    constexpr std::size_t worldGrainSize = 4;
+
+    WorldRunner::WorldRunner(std::size_t threadCount) {
+        if(threadCount != 1) {
+            ownedJobSystem = std::make_unique<JobSystem>(threadCount);
+            jobSystem = ownedJobSystem.get();
+        }
+    }
+
+    WorldRunner::WorldRunner(JobSystem* jobSystem) noexcept : jobSystem{jobSystem} {}
+
+    PhysicsWorld& WorldRunner::CreateWorld(std::size_t bodyCount) {
+        auto& world = *worlds.emplace_back(std::make_unique<PhysicsWorld>());
+
+        world.Reserve(bodyCount);
+
+        stepTimes.push_back(0);
+
+        return world;
+    }
+
+    void WorldRunner::DestroyWorld(std::size_t index) noexcept {
+        worlds[index] = std::move(worlds.back());
+        worlds.pop_back();
+
+        stepTimes[index] = stepTimes.back();
+        stepTimes.pop_back();
+    }
+
+    std::size_t WorldRunner::GetThreadCount() const noexcept {
+        return jobSystem ? jobSystem->GetThreadCount() : 1;
+    }
+
+    void WorldRunner::StepAll(std::size_t ticks) {
+        ParallelFor(jobSystem, worlds.size(), worldGrainSize, [&](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; i++) {
+                auto start = std::chrono::steady_clock::now();
+
+                for(std::size_t tick = 0; tick < ticks; tick++) {
+                    worlds[i]->Tick();
+                }
+
+                stepTimes[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        });
+    }
+}
@@ -1,11 +1,36 @@
 #include <Physics/Collision.hpp>
 #include <Physics/PhysicsWorld.hpp>
+#include <Physics/BatchCollisionTest.hpp>
+#include <Physics/JobSystem.hpp>
+#include <Physics/Island.hpp>
+#include <Physics/Profiling.hpp>
+#include <Physics/ContinuousCollision.hpp>
+#include <Physics/AsyncWorld.hpp>
+#include <Physics/WorldRunner.hpp>
+#include <Physics/Streaming.hpp>
+#include <Physics/Heightfield.hpp>
 
 #include <Physics/config.hpp>
 
 #include <glm/geometric.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <ranges>
+#include <vector>
+#include <memory>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <atomic>
 #include <spdlog/spdlog.h>
 
 #include <gtest/gtest.h>
@@ -134,3 +159,2169 @@ TEST_F(CollisionTestsFixture, SupportCollisionTest) {
     EXPECT_FALSE(sphere.SupportsCollisionWith(cube));
     EXPECT_TRUE(sphere.SupportsCollisionWith(sphere));
 }
+
+
+TEST_F(CollisionTestsFixture, BroadphaseTest) {
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> positionDist{-10, 10};
+    std::uniform_real_distribution<float> sizeDist{0.25f, 3};
+
+    std::vector<std::unique_ptr<Physics::Collider>> colliders;
+
+    colliders.push_back(std::make_unique<Physics::SimplePlaneCollider>(0.0f));
+
+    for(int i = 0; i < 200; i++) {
+        glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+        if(i % 2 == 0) {
+            colliders.push_back(std::make_unique<Physics::SimpleCubeCollider>(position, glm::vec3{sizeDist(rng), sizeDist(rng), sizeDist(rng)}, glm::vec3{}));
+        } else {
+            colliders.push_back(std::make_unique<Physics::SphereCollider>(position, sizeDist(rng), glm::vec3{}));
+        }
+    }
+
+    std::vector<Physics::AABB> bounds;
+
+    for(auto& collider : colliders) {
+        bounds.push_back(collider->CalculateAABB());
+    }
+
+    // Only keep the pairs that actually collide
+    auto collidingPairs = [&](Physics::Broadphase& broadphase) {
+        std::vector<Physics::IndexPair> pairs;
+
+        broadphase.CalculatePairs(bounds, pairs);
+
+        std::erase_if(pairs, [&](Physics::IndexPair pair) {
+            auto& collider1 = *colliders[pair.first];
+            auto& collider2 = *colliders[pair.second];
+
+            return !collider1.SupportsCollisionWith(collider2) || !collider1.CollidesWith(collider2);
+        });
+
+        return pairs;
+    };
+
+    Physics::BruteForceBroadphase bruteForce;
+    Physics::SweepAndPruneBroadphase sweepAndPrune;
+
+    auto expected = collidingPairs(bruteForce);
+
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(expected, collidingPairs(sweepAndPrune));
+
+    // Move everything and make sure the incremental sort still finds the same pairs
+    for(auto& collider : colliders) {
+        collider->position.x += positionDist(rng) / 4;
+    }
+
+    for(std::size_t i = 0; i < colliders.size(); i++) {
+        bounds[i] = colliders[i]->CalculateAABB();
+    }
+
+    EXPECT_EQ(collidingPairs(bruteForce), collidingPairs(sweepAndPrune));
+}
+
+TEST_F(CollisionTestsFixture, ContactsTest) {
+    Physics::SimplePlaneCollider plane{0};
+    plane.hasGravity = false;
+
+    Physics::SphereCollider sphere1{{0, 0.25f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider sphere2{{5, 0.25f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider sphere3{{10, 5, 0}, 1, {0, 0, 0}};
+
+    Physics::PhysicsWorld world;
+
+    world.AddPhysicsObject(&plane);
+    world.AddPhysicsObject(&sphere1);
+    world.AddPhysicsObject(&sphere2);
+    world.AddPhysicsObject(&sphere3);
+
+    world.Tick();
+
+    auto contacts = world.GetContacts();
+
+    ASSERT_EQ(contacts.size(), 2);
+
+    for(auto& contact : contacts) {
+        EXPECT_EQ(contact.collider1, &plane);
+        EXPECT_NE(contact.collider2, &sphere3);
+
+        // The normal points from the plane towards the sphere
+        EXPECT_EQ(contact.normal, (glm::vec3{0, 1, 0}));
+        EXPECT_GT(contact.penetration, 0);
+    }
+}
+
+TEST_F(CollisionTestsFixture, BodyStoreTest) {
+    Physics::SphereCollider falling{{0, 10, 0}, 1, {1, 0, 0}};
+    Physics::SimpleCubeCollider floating{{5, 10, 0}, 1, {0, 2, 0}};
+    floating.hasGravity = false;
+
+    // The same colliders, integrated directly
+    auto expectedFalling = falling;
+    auto expectedFloating = floating;
+    std::vector<Physics::Collider*> expected{&expectedFalling, &expectedFloating};
+
+    Physics::PhysicsWorld world;
+
+    auto fallingHandle = world.AddPhysicsObject(&falling);
+    auto floatingHandle = world.AddPhysicsObject(&floating);
+
+    EXPECT_EQ(world.GetBodyCount(), 2);
+
+    for(int i = 0; i < 60; i++) {
+        world.Tick();
+        Physics::ApplyVelocity(expected, Physics::earthGravityVector, 1 / 60.0f);
+    }
+
+    // Integrating the body store must give exactly the same result as integrating the colliders
+    EXPECT_EQ(world.GetPosition(fallingHandle), expectedFalling.position);
+    EXPECT_EQ(world.GetVelocity(fallingHandle), expectedFalling.velocity);
+    EXPECT_EQ(world.GetPosition(floatingHandle), expectedFloating.position);
+    EXPECT_EQ(world.GetVelocity(floatingHandle), expectedFloating.velocity);
+
+    // The colliders are updated after each tick
+    EXPECT_EQ(falling.position, expectedFalling.position);
+    EXPECT_EQ(floating.velocity, expectedFloating.velocity);
+
+    world.SetVelocity(floatingHandle, {});
+    EXPECT_EQ(floating.velocity, glm::vec3{});
+
+    auto position = world.GetPosition(floatingHandle);
+    world.Tick();
+    EXPECT_EQ(world.GetPosition(floatingHandle), position);
+}
+
+// Compares the bits, so 0 and -0 are different
+static bool Identical(float f1, float f2) {
+    return std::bit_cast<std::uint32_t>(f1) == std::bit_cast<std::uint32_t>(f2);
+}
+
+static bool Identical(const Physics::CollisionResult& result1, const Physics::CollisionResult& result2) {
+    return result1.collides == result2.collides &&
+           Identical(result1.normal.x, result2.normal.x) &&
+           Identical(result1.normal.y, result2.normal.y) &&
+           Identical(result1.normal.z, result2.normal.z) &&
+           Identical(result1.penetration, result2.penetration);
+}
+
+TEST_F(CollisionTestsFixture, BatchCollisionTest) {
+    std::mt19937 rng{5678};
+    std::uniform_real_distribution<float> positionDist{-3, 3};
+    std::uniform_real_distribution<float> sizeDist{0.25f, 3};
+    std::uniform_int_distribution<int> velocityDist{-1, 1};
+
+    // Not a multiple of 8, so the scalar kernels are used for the remainder
+    constexpr std::size_t count = 1003;
+
+    std::vector<Physics::SphereCollider> spheres;
+    std::vector<Physics::SimpleCubeCollider> cubes;
+    std::vector<Physics::SimplePlaneCollider> planes;
+
+    for(std::size_t i = 0; i < count * 2; i++) {
+        glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+        glm::vec3 velocity{0, velocityDist(rng), 0};
+
+        spheres.emplace_back(position, sizeDist(rng), velocity);
+        cubes.emplace_back(position, glm::vec3{sizeDist(rng), sizeDist(rng), sizeDist(rng)}, velocity);
+        planes.emplace_back(positionDist(rng));
+    }
+
+    // Some cubes in the same place, so the overlaps are equal on more than one axis
+    for(std::size_t i = 0; i < count; i += 10) {
+        cubes[i * 2 + 1] = cubes[i * 2];
+    }
+
+    Physics::SpherePairBatch sphereBatch;
+    Physics::CubePairBatch cubeBatch;
+    Physics::PlanePairBatch planeBatch;
+
+    sphereBatch.Resize(count);
+    cubeBatch.Resize(count);
+    planeBatch.Resize(count);
+
+    for(std::size_t i = 0; i < count; i++) {
+        auto& sphere1 = spheres[i * 2];
+        auto& sphere2 = spheres[i * 2 + 1];
+
+        sphereBatch.position1.Set(i, sphere1.position);
+        sphereBatch.size1[i] = sphere1.size.x;
+        sphereBatch.position2.Set(i, sphere2.position);
+        sphereBatch.size2[i] = sphere2.size.x;
+
+        auto& cube1 = cubes[i * 2];
+        auto& cube2 = cubes[i * 2 + 1];
+
+        cubeBatch.position1.Set(i, cube1.position);
+        cubeBatch.size1.Set(i, cube1.size);
+        cubeBatch.position2.Set(i, cube2.position);
+        cubeBatch.size2.Set(i, cube2.size);
+
+        // Alternate between cubes and spheres
+        const Physics::Collider& other = i % 2 ? static_cast<const Physics::Collider&>(cubes[i]) : spheres[i];
+
+        planeBatch.planeHeight[i] = planes[i].position.y;
+        planeBatch.height[i] = other.position.y;
+        planeBatch.size[i] = other.size.y;
+        planeBatch.velocity[i] = other.velocity.y;
+    }
+
+    auto supportedLevel = Physics::GetSupportedSimdLevel();
+
+    for(auto level : {Physics::SimdLevel::Scalar, Physics::SimdLevel::SSE2, Physics::SimdLevel::AVX2}) {
+        if(level > supportedLevel) continue;
+
+        Physics::SetSimdLevel(level);
+
+        Physics::BatchResults sphereResults;
+        Physics::BatchResults cubeResults;
+        Physics::BatchResults planeResults;
+
+        Physics::SpheresCollideBatch(sphereBatch, sphereResults);
+        Physics::CubesCollideBatch(cubeBatch, cubeResults);
+        Physics::PlanesCollideBatch(planeBatch, planeResults);
+
+        std::size_t collisions = 0;
+
+        for(std::size_t i = 0; i < count; i++) {
+            EXPECT_TRUE(Identical(sphereResults.Get(i), Physics::CollidesImpl{}(spheres[i * 2], spheres[i * 2 + 1])));
+            EXPECT_TRUE(Identical(cubeResults.Get(i), Physics::CollidesImpl{}(cubes[i * 2], cubes[i * 2 + 1])));
+
+            auto expected = i % 2 ? Physics::CollidesImpl{}(planes[i], cubes[i]) : Physics::CollidesImpl{}(planes[i], spheres[i]);
+
+            EXPECT_TRUE(Identical(planeResults.Get(i), expected));
+
+            collisions += sphereResults.collides[i] + cubeResults.collides[i] + planeResults.collides[i];
+        }
+
+        EXPECT_GT(collisions, 0);
+    }
+
+    Physics::SetSimdLevel(supportedLevel);
+}
+
+TEST_F(CollisionTestsFixture, NarrowphaseTest) {
+    std::mt19937 rng{91011};
+    std::uniform_real_distribution<float> positionDist{-5, 5};
+    std::uniform_real_distribution<float> sizeDist{0.25f, 3};
+    std::uniform_int_distribution<int> velocityDist{-1, 1};
+
+    std::vector<std::unique_ptr<Physics::Collider>> colliders;
+
+    colliders.push_back(std::make_unique<Physics::SimplePlaneCollider>(0.0f));
+
+    for(int i = 0; i < 300; i++) {
+        glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+        glm::vec3 velocity{0, velocityDist(rng), 0};
+
+        if(i % 2 == 0) {
+            colliders.push_back(std::make_unique<Physics::SimpleCubeCollider>(position, glm::vec3{sizeDist(rng), sizeDist(rng), sizeDist(rng)}, velocity));
+        } else {
+            colliders.push_back(std::make_unique<Physics::SphereCollider>(position, sizeDist(rng), velocity));
+        }
+    }
+
+    colliders.push_back(std::make_unique<Physics::SimplePlaneCollider>(1.0f));
+
+    Physics::BodyStore bodies;
+    std::vector<Physics::Collider*> colliderPointers;
+
+    for(auto& collider : colliders) {
+        bodies.Add(collider.get());
+        colliderPointers.push_back(collider.get());
+    }
+
+    std::vector<Physics::AABB> bounds;
+    bodies.CalculateBounds(bounds);
+
+    std::vector<Physics::IndexPair> pairs;
+    Physics::SweepAndPruneBroadphase{}.CalculatePairs(bounds, pairs);
+
+    std::vector<Physics::Contact> expected;
+    std::vector<Physics::Contact> actual;
+
+    Physics::CalculateContacts(colliderPointers, pairs, expected);
+    Physics::Narrowphase{}.CalculateContacts(bodies, pairs, actual);
+
+    ASSERT_EQ(expected.size(), actual.size());
+    EXPECT_FALSE(expected.empty());
+
+    for(std::size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].collider1, actual[i].collider1);
+        EXPECT_EQ(expected[i].collider2, actual[i].collider2);
+        EXPECT_TRUE(Identical(expected[i].normal.x, actual[i].normal.x));
+        EXPECT_TRUE(Identical(expected[i].normal.y, actual[i].normal.y));
+        EXPECT_TRUE(Identical(expected[i].normal.z, actual[i].normal.z));
+        EXPECT_TRUE(Identical(expected[i].penetration, actual[i].penetration));
+    }
+}
+
+TEST_F(CollisionTestsFixture, CollisionTableTest) {
+    static_assert(Physics::SupportsCollision<Physics::SimplePlaneCollider, Physics::SphereCollider>());
+    static_assert(Physics::SupportsCollision<Physics::SphereCollider, Physics::SimplePlaneCollider>());
+    static_assert(!Physics::SupportsCollision<Physics::SimplePlaneCollider, Physics::SimplePlaneCollider>());
+
+    Physics::SimpleCubeCollider cube{{0, 0, 0}, 1, {0, 0, 0}};
+    Physics::SphereCollider sphere{{0, 0, 0}, 1, {0, 0, 0}};
+    Physics::SimplePlaneCollider plane{0};
+
+    EXPECT_EQ(cube.GetTypeIndex(), Physics::colliderTypeIndex<Physics::SimpleCubeCollider>);
+    EXPECT_STREQ(sphere.GetColliderTypeName(), Physics::SphereCollider::colliderTypeName);
+
+    EXPECT_THROW(cube.CollidesWith(sphere), Physics::NotImplementedException);
+    EXPECT_THROW(plane.CollidesWith(plane), Physics::NotImplementedException);
+
+    // Copies are independent of the original
+    auto copy = sphere;
+    copy.position = {10, 0, 0};
+
+    EXPECT_TRUE(sphere.CollidesWith(sphere));
+    EXPECT_FALSE(copy.CollidesWith(sphere));
+}
+
+TEST_F(CollisionTestsFixture, JobSystemTest) {
+    Physics::JobSystem jobSystem{4};
+
+    EXPECT_EQ(jobSystem.GetThreadCount(), 4);
+
+    // Every index is visited exactly once
+    std::vector<int> visits(10000);
+
+    jobSystem.ParallelFor(visits.size(), 64, [&](std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+
+    EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), visits.size());
+
+    EXPECT_THROW(jobSystem.ParallelFor(100, 1, [](std::size_t begin, std::size_t) {
+        if(begin == 50) throw std::runtime_error{"Job failed"};
+    }), std::runtime_error);
+
+    // Runs the same scene with a different number of threads
+    auto simulate = [](std::size_t threadCount) {
+        std::mt19937 rng{1213};
+        std::uniform_real_distribution<float> positionDist{-40, 40};
+        std::uniform_real_distribution<float> sizeDist{0.25f, 2};
+
+        std::vector<std::unique_ptr<Physics::Collider>> colliders;
+
+        colliders.push_back(std::make_unique<Physics::SimplePlaneCollider>(-40.0f));
+
+        for(int i = 0; i < 10000; i++) {
+            glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+            if(i % 2 == 0) {
+                colliders.push_back(std::make_unique<Physics::SimpleCubeCollider>(position, sizeDist(rng), glm::vec3{}));
+            } else {
+                colliders.push_back(std::make_unique<Physics::SphereCollider>(position, sizeDist(rng), glm::vec3{}));
+            }
+        }
+
+        Physics::PhysicsWorld world;
+        world.SetThreadCount(threadCount);
+
+        for(auto& collider : colliders) {
+            world.AddPhysicsObject(collider.get());
+        }
+
+        std::size_t contactCount = 0;
+
+        for(int i = 0; i < 20; i++) {
+            world.Tick();
+            contactCount += world.GetContacts().size();
+        }
+
+        std::vector<glm::vec3> positions;
+
+        for(std::uint32_t i = 0; i < world.GetBodyCount(); i++) {
+            positions.push_back(world.GetPosition({i}));
+        }
+
+        return std::pair{positions, contactCount};
+    };
+
+    auto [expected, expectedContacts] = simulate(1);
+    auto [actual, actualContacts] = simulate(4);
+
+    EXPECT_GT(expectedContacts, 0);
+    EXPECT_EQ(expectedContacts, actualContacts);
+
+    ASSERT_EQ(expected.size(), actual.size());
+
+    for(std::size_t i = 0; i < expected.size(); i++) {
+        EXPECT_TRUE(Identical(expected[i].x, actual[i].x));
+        EXPECT_TRUE(Identical(expected[i].y, actual[i].y));
+        EXPECT_TRUE(Identical(expected[i].z, actual[i].z));
+    }
+
+    // Threads that aren't workers share index 0, so their jobs with index 0 must only run on the thread that called ParallelFor
+    Physics::JobSystem shared{4};
+    std::atomic<int> foreignJobs = 0;
+
+    auto callFrom = [&] {
+        auto caller = std::this_thread::get_id();
+
+        for(int i = 0; i < 50; i++) {
+            shared.ParallelFor(64, 1, [&](std::size_t, std::size_t) {
+                if(shared.GetThreadIndex() == 0 && std::this_thread::get_id() != caller) {
+                    foreignJobs++;
+                }
+            });
+        }
+    };
+
+    {
+        std::jthread first{callFrom};
+        std::jthread second{callFrom};
+    }
+
+    EXPECT_EQ(foreignJobs, 0);
+}
+
+TEST_F(CollisionTestsFixture, IslandTest) {
+    Physics::SimplePlaneCollider plane{0};
+
+    // Two piles resting on the plane, and a sphere touching nothing
+    Physics::SphereCollider pile1Bottom{{0, 0.4f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider pile1Top{{0, 1.3f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider pile2Bottom{{10, 0.4f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider pile2Top{{10, 1.3f, 0}, 1, {0, -1, 0}};
+    Physics::SphereCollider alone{{20, 5, 0}, 1, {0, 0, 0}};
+
+    Physics::PhysicsWorld world;
+
+    world.AddPhysicsObject(&plane);
+    world.AddPhysicsObject(&pile1Bottom);
+    world.AddPhysicsObject(&pile1Top);
+    world.AddPhysicsObject(&pile2Bottom);
+    world.AddPhysicsObject(&pile2Top);
+    world.AddPhysicsObject(&alone);
+
+    world.Tick();
+
+    // The plane is static, so it doesn't join the piles into one island
+    auto islands = world.GetIslands();
+
+    ASSERT_EQ(islands.size(), 3);
+
+    EXPECT_EQ(islands[0].bodyCount, 2);
+    EXPECT_EQ(islands[0].contactCount, 2);
+    EXPECT_EQ(islands[1].bodyCount, 2);
+    EXPECT_EQ(islands[1].contactCount, 2);
+    EXPECT_EQ(islands[2].bodyCount, 1);
+    EXPECT_EQ(islands[2].contactCount, 0);
+
+    EXPECT_EQ(plane.position, glm::vec3{});
+    EXPECT_EQ(plane.velocity, glm::vec3{});
+
+    // Resolving each island separately gives the same result as resolving every contact in order
+    std::mt19937 rng{1415};
+    std::uniform_real_distribution<float> positionDist{-8, 8};
+    std::uniform_real_distribution<float> velocityDist{-2, 2};
+
+    std::vector<std::unique_ptr<Physics::Collider>> colliders;
+
+    colliders.push_back(std::make_unique<Physics::SimplePlaneCollider>(-4.0f));
+
+    for(int i = 0; i < 500; i++) {
+        glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+        glm::vec3 velocity{velocityDist(rng), velocityDist(rng), velocityDist(rng)};
+
+        colliders.push_back(std::make_unique<Physics::SphereCollider>(position, 1.5f, velocity));
+    }
+
+    Physics::BodyStore expected;
+
+    for(auto& collider : colliders) {
+        expected.Add(collider.get());
+    }
+
+    std::vector<Physics::AABB> bounds;
+    expected.CalculateBounds(bounds);
+
+    std::vector<Physics::IndexPair> pairs;
+    Physics::SweepAndPruneBroadphase{}.CalculatePairs(bounds, pairs);
+
+    std::vector<Physics::Contact> contacts;
+    Physics::Narrowphase{}.CalculateContacts(expected, pairs, contacts);
+
+    auto actual = expected;
+
+    Physics::ResolveContacts(expected, contacts);
+
+    Physics::IslandBuilder builder;
+    builder.Build(actual, contacts);
+
+    std::size_t bodyCount = 0;
+    std::size_t contactCount = 0;
+
+    // Resolve them in reverse order to show the order doesn't matter
+    for(auto& island : std::views::reverse(builder.GetIslands())) {
+        Physics::ResolveContacts(actual, builder.GetContacts(island));
+
+        bodyCount += island.bodyCount;
+        contactCount += island.contactCount;
+    }
+
+    EXPECT_GT(builder.GetIslands().size(), 1);
+    EXPECT_LT(builder.GetIslands().size(), colliders.size() - 1);
+    EXPECT_EQ(bodyCount, colliders.size() - 1);
+    EXPECT_EQ(contactCount, contacts.size());
+
+    for(std::size_t i = 0; i < expected.Size(); i++) {
+        EXPECT_TRUE(Identical(expected.velocities[i].x, actual.velocities[i].x));
+        EXPECT_TRUE(Identical(expected.velocities[i].y, actual.velocities[i].y));
+        EXPECT_TRUE(Identical(expected.velocities[i].z, actual.velocities[i].z));
+    }
+}
+
+TEST_F(CollisionTestsFixture, SleepTest) {
+    Physics::SimplePlaneCollider plane{0};
+
+    Physics::SphereCollider resting{{0, 0.5f, 0}, 1, {}};
+    resting.restitution = 0;
+
+    Physics::SphereCollider falling{{0, 10, 0}, 1, {}};
+    falling.restitution = 0;
+
+    Physics::PhysicsWorld world;
+
+    world.AddPhysicsObject(&plane);
+    auto restingHandle = world.AddPhysicsObject(&resting);
+    auto fallingHandle = world.AddPhysicsObject(&falling);
+
+    world.SetSleepThreshold(0.05f, 0.5f);
+
+    // Stays awake until its speed has been below the threshold for long enough
+    for(int i = 0; i < 20; i++) {
+        world.Tick();
+    }
+
+    EXPECT_TRUE(world.IsAwake(restingHandle));
+
+    for(int i = 0; i < 20; i++) {
+        world.Tick();
+    }
+
+    EXPECT_FALSE(world.IsAwake(restingHandle));
+    EXPECT_TRUE(world.IsAwake(fallingHandle));
+    EXPECT_EQ(world.GetAwakeBodyCount(), 1);
+    EXPECT_EQ(world.GetSleepingBodyCount(), 1);
+
+    // Sleeping bodies don't move
+    auto position = world.GetPosition(restingHandle);
+
+    world.Tick();
+
+    EXPECT_EQ(world.GetPosition(restingHandle), position);
+    EXPECT_EQ(world.GetVelocity(restingHandle), glm::vec3{});
+
+    // Landing on the sleeping body wakes it
+    for(int i = 0; i < 120 && !world.IsAwake(restingHandle); i++) {
+        EXPECT_EQ(world.GetPosition(restingHandle), position);
+        world.Tick();
+    }
+
+    EXPECT_TRUE(world.IsAwake(restingHandle));
+    EXPECT_LT(world.GetPosition(fallingHandle).y, 2);
+
+    // Waking explicitly
+    world.SetSleepingEnabled(false);
+
+    EXPECT_TRUE(world.IsAwake(restingHandle));
+    EXPECT_TRUE(world.IsAwake(fallingHandle));
+
+    world.SetSleepingEnabled(true);
+
+    for(int i = 0; i < 600 && world.GetSleepingBodyCount() < 2; i++) {
+        world.Tick();
+    }
+
+    EXPECT_EQ(world.GetSleepingBodyCount(), 2);
+
+    world.Wake(fallingHandle);
+
+    EXPECT_TRUE(world.IsAwake(fallingHandle));
+    EXPECT_FALSE(world.IsAwake(restingHandle));
+}
+
+TEST_F(CollisionTestsFixture, ProfilingTest) {
+    Physics::SimplePlaneCollider plane{0};
+    Physics::SphereCollider sphere1{{0, 0.25f, 0}, 1, {}};
+    Physics::SphereCollider sphere2{{5, 10, 0}, 1, {}};
+
+    Physics::PhysicsWorld world;
+
+    world.AddPhysicsObject(&plane);
+    world.AddPhysicsObject(&sphere1);
+    world.AddPhysicsObject(&sphere2);
+
+    for(std::size_t i = 0; i < Physics::profileWindowSize + 10; i++) {
+        world.Tick();
+    }
+
+    auto& stats = world.GetStats();
+
+    if constexpr(!Physics::profilingEnabled) {
+        EXPECT_EQ(stats.tickCount, 0);
+        EXPECT_EQ(stats[Physics::ProfileTimer::Tick].max, 0);
+        return;
+    }
+
+    EXPECT_EQ(stats.tickCount, Physics::profileWindowSize);
+
+    EXPECT_EQ(stats[Physics::ProfileCounter::Bodies].last, 3);
+    EXPECT_EQ(stats[Physics::ProfileCounter::Bodies].average, 3);
+    EXPECT_EQ(stats[Physics::ProfileCounter::Contacts].last, world.GetContacts().size());
+    EXPECT_GE(stats[Physics::ProfileCounter::CandidatePairs].last, stats[Physics::ProfileCounter::NarrowphaseCalls].last);
+
+    for(auto& timer : stats.timers) {
+        EXPECT_GE(timer.min, 0);
+        EXPECT_LE(timer.min, timer.average);
+        EXPECT_LE(timer.average, timer.max);
+    }
+
+    // The whole tick includes every phase
+    EXPECT_GE(stats[Physics::ProfileTimer::Tick].last, stats[Physics::ProfileTimer::Narrowphase].last);
+
+    EXPECT_STREQ(Physics::GetName(Physics::ProfileCounter::CandidatePairs), "CandidatePairs");
+}
+
+TEST_F(CollisionTestsFixture, AccumulatorTest) {
+    double elapsedTime = 0;
+    double deltaTime = 0;
+    TimeManagerShim timeManager{elapsedTime, deltaTime};
+
+    Physics::SphereCollider sphere{{0, 10, 0}, 1, {6, 0, 0}};
+    sphere.hasGravity = false;
+
+    Physics::PhysicsWorld world;
+    world.timeManager = &timeManager;
+
+    auto handle = world.AddPhysicsObject(&sphere);
+
+    constexpr double tickLength = 1 / 60.0;
+
+    // Never runs ahead of the clock
+    elapsedTime = tickLength / 2;
+    EXPECT_EQ(world.TickUntil(), 0);
+    EXPECT_DOUBLE_EQ(world.GetInterpolationAlpha(), 0.5);
+
+    elapsedTime = tickLength * 1.25;
+    EXPECT_EQ(world.TickUntil(), 1);
+    EXPECT_NEAR(world.GetInterpolationAlpha(), 0.25, 1e-9);
+
+    // The sphere moves 0.1 each tick
+    EXPECT_FLOAT_EQ(world.GetPreviousPosition(handle).x, 0);
+    EXPECT_FLOAT_EQ(world.GetPosition(handle).x, 0.1f);
+    EXPECT_NEAR(world.GetInterpolatedPosition(handle).x, 0.025f, 1e-6f);
+
+    // A long frame only runs up to the limit, and the rest is dropped
+    world.SetMaxSubsteps(4);
+
+    elapsedTime = 10;
+    EXPECT_EQ(world.TickUntil(), 4);
+    EXPECT_GE(world.GetInterpolationAlpha(), 0);
+    EXPECT_LT(world.GetInterpolationAlpha(), 1);
+
+    elapsedTime += tickLength;
+    EXPECT_EQ(world.TickUntil(), 1);
+    EXPECT_NEAR(world.GetSimulationTime(), tickLength * 6, 1e-9);
+
+    // With Slow, the backlog is kept and caught up over the next calls
+    world.SetOverrunPolicy(Physics::OverrunPolicy::Slow);
+
+    elapsedTime += tickLength * 10;
+    EXPECT_EQ(world.TickUntil(), 4);
+    EXPECT_EQ(world.GetInterpolationAlpha(), 1);
+    EXPECT_EQ(world.TickUntil(), 4);
+    EXPECT_EQ(world.TickUntil(), 2);
+    EXPECT_LT(world.GetInterpolationAlpha(), 1);
+
+    // Teleporting doesn't interpolate from the old position
+    world.SetPosition(handle, {100, 0, 0});
+    EXPECT_EQ(world.GetInterpolatedPosition(handle), (glm::vec3{100, 0, 0}));
+
+    // Time is kept in double precision, so a long session still runs exactly one tick per frame
+    Physics::PhysicsWorld longWorld;
+    longWorld.timeManager = &timeManager;
+
+    elapsedTime = 0;
+
+    for(int i = 0; i < 60 * 60 * 10; i++) {
+        elapsedTime += tickLength;
+        ASSERT_EQ(longWorld.TickUntil(), 1);
+    }
+}
+
+TEST_F(CollisionTestsFixture, ContinuousCollisionTest) {
+    // A sphere of radius 1 falling 10 onto a plane 4 below it touches after 3
+    auto spherePlane = Physics::SweepSpherePlane({0, 4, 0}, {0, -10, 0}, 1, 0);
+    EXPECT_TRUE(spherePlane.hits);
+    EXPECT_FLOAT_EQ(spherePlane.time, 0.3f);
+    EXPECT_EQ(spherePlane.normal, (glm::vec3{0, 1, 0}));
+
+    EXPECT_FALSE(Physics::SweepSpherePlane({0, 4, 0}, {0, 10, 0}, 1, 0).hits);
+    EXPECT_FALSE(Physics::SweepSpherePlane({0, 4, 0}, {0, -2, 0}, 1, 0).hits);
+
+    // From below
+    auto spherePlaneBelow = Physics::SweepSpherePlane({0, -4, 0}, {0, 10, 0}, 1, 0);
+    EXPECT_TRUE(spherePlaneBelow.hits);
+    EXPECT_EQ(spherePlaneBelow.normal, (glm::vec3{0, -1, 0}));
+
+    // Two spheres approaching each other meet halfway
+    auto spheres = Physics::SweepSpheres({-5, 0, 0}, {10, 0, 0}, 1, {5, 0, 0}, {-10, 0, 0}, 1);
+    EXPECT_TRUE(spheres.hits);
+    EXPECT_FLOAT_EQ(spheres.time, 0.4f);
+    EXPECT_EQ(spheres.normal, (glm::vec3{1, 0, 0}));
+
+    EXPECT_FALSE(Physics::SweepSpheres({-5, 0, 0}, {10, 0, 0}, 1, {5, 3, 0}, {-10, 0, 0}, 1).hits);
+
+    Physics::AABB box1{{-1, -1, -1}, {1, 1, 1}};
+    Physics::AABB box2{{9, -1, -1}, {11, 1, 1}};
+
+    auto boxes = Physics::SweepAABBs(box1, {20, 0, 0}, box2, {});
+    EXPECT_TRUE(boxes.hits);
+    EXPECT_FLOAT_EQ(boxes.time, 0.4f);
+    EXPECT_EQ(boxes.normal, (glm::vec3{1, 0, 0}));
+
+    EXPECT_FALSE(Physics::SweepAABBs(box1, {20, 5, 0}, box2, {}).hits);
+
+    auto boxPlane = Physics::SweepAABBPlane({{-1, 4, -1}, {1, 6, 1}}, {0, -10, 0}, 0);
+    EXPECT_TRUE(boxPlane.hits);
+    EXPECT_FLOAT_EQ(boxPlane.time, 0.4f);
+
+    // A fast sphere passes through the plane at 30 ticks per second, unless continuous collision is enabled
+    auto fallThrough = [](bool continuous) {
+        Physics::SimplePlaneCollider plane{0};
+        Physics::SphereCollider sphere{{0, 2, 0}, 1, {0, -120, 0}};
+        sphere.continuousCollision = continuous;
+
+        Physics::PhysicsWorld world;
+        world.SetTickRate(30);
+
+        world.AddPhysicsObject(&plane);
+        auto handle = world.AddPhysicsObject(&sphere);
+
+        world.Tick();
+
+        return std::pair{world.GetPosition(handle), world.GetVelocity(handle)};
+    };
+
+    auto [discretePosition, discreteVelocity] = fallThrough(false);
+
+    EXPECT_LT(discretePosition.y, -1);
+    EXPECT_LT(discreteVelocity.y, 0);
+
+    auto [continuousPosition, continuousVelocity] = fallThrough(true);
+
+    // Stopped where it touched the plane, and bounced
+    EXPECT_NEAR(continuousPosition.y, 0.5f, 1e-4f);
+    EXPECT_GT(continuousVelocity.y, 0);
+}
+
+TEST_F(CollisionTestsFixture, HandlePoolTest) {
+    Physics::PhysicsWorld world;
+    Physics::PhysicsWorld bruteForceWorld;
+    bruteForceWorld.SetBroadphase(std::make_unique<Physics::BruteForceBroadphase>());
+
+    std::vector<Physics::BodyHandle> handles;
+    std::vector<Physics::BodyHandle> bruteForceHandles;
+
+    std::mt19937 rng{1415};
+    std::uniform_real_distribution<float> positionDist{-10, 10};
+
+    auto create = [&](int count) {
+        for(int i = 0; i < count; i++) {
+            glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+            handles.push_back(world.CreateSphere(position, 1));
+            bruteForceHandles.push_back(bruteForceWorld.CreateSphere(position, 1));
+        }
+    };
+
+    // Both worlds must find the same contacts, between the same bodies
+    auto tick = [&] {
+        world.Tick();
+        bruteForceWorld.Tick();
+
+        auto contacts = world.GetContacts();
+        auto bruteForceContacts = bruteForceWorld.GetContacts();
+
+        ASSERT_EQ(contacts.size(), bruteForceContacts.size());
+
+        for(std::size_t i = 0; i < contacts.size(); i++) {
+            EXPECT_EQ(contacts[i].index1, bruteForceContacts[i].index1);
+            EXPECT_EQ(contacts[i].index2, bruteForceContacts[i].index2);
+        }
+
+        // Each body's collider is updated through its pointer, so this fails if a pointer wasn't fixed after a move
+        for(auto handle : handles) {
+            EXPECT_EQ(world.GetCollider(handle).position, world.GetPosition(handle));
+        }
+    };
+
+    handles.push_back(world.CreatePlane(-10));
+    bruteForceHandles.push_back(bruteForceWorld.CreatePlane(-10));
+
+    create(200);
+    tick();
+
+    // Destroys every third body, including the plane
+    for(std::size_t i = handles.size(); i-- > 0;) {
+        if(i % 3 != 0) continue;
+
+        world.Destroy(handles[i]);
+        bruteForceWorld.Destroy(bruteForceHandles[i]);
+
+        handles.erase(handles.begin() + static_cast<std::ptrdiff_t>(i));
+        bruteForceHandles.erase(bruteForceHandles.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    EXPECT_EQ(world.GetBodyCount(), handles.size());
+    tick();
+
+    // Destroying and creating between ticks
+    for(int i = 0; i < 20; i++) {
+        world.Destroy(handles.back());
+        bruteForceWorld.Destroy(bruteForceHandles.back());
+
+        handles.pop_back();
+        bruteForceHandles.pop_back();
+    }
+
+    create(50);
+    EXPECT_EQ(world.GetBodyCount(), handles.size());
+
+    tick();
+    tick();
+
+    // A destroyed handle stays invalid after its slot is reused
+    auto stale = handles.front();
+    world.Destroy(stale);
+
+    EXPECT_FALSE(world.IsValid(stale));
+    EXPECT_THROW(world.Destroy(stale), std::invalid_argument);
+
+    auto reused = world.CreateCube({0, 0, 0}, glm::vec3{1});
+
+    EXPECT_EQ(reused.index, stale.index);
+    EXPECT_NE(reused.generation, stale.generation);
+    EXPECT_TRUE(world.IsValid(reused));
+    EXPECT_FALSE(world.IsValid(stale));
+
+    EXPECT_EQ(world.GetCollider(reused).position, (glm::vec3{0, 0, 0}));
+}
+
+TEST_F(CollisionTestsFixture, SnapshotTest) {
+    // A world with every collider type, static and sleeping bodies, continuous collision, and reused handle slots
+    auto createWorld = [](Physics::PhysicsWorld& world) {
+        std::mt19937 rng{1617};
+        std::uniform_real_distribution<float> positionDist{-10, 10};
+        std::uniform_real_distribution<float> massDist{0.5f, 4};
+
+        std::vector<Physics::BodyHandle> handles;
+
+        handles.push_back(world.CreatePlane(-10));
+
+        for(int i = 0; i < 300; i++) {
+            glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+            if(i % 2 == 0) {
+                Physics::SimpleCubeCollider cube{position, glm::vec3{1}, {}};
+                cube.mass = massDist(rng);
+                cube.restitution = 0.5f;
+
+                handles.push_back(world.Create(cube));
+            } else {
+                Physics::SphereCollider sphere{position, 0.5f, {0, -30, 0}};
+                sphere.mass = massDist(rng);
+                sphere.continuousCollision = i % 3 == 0;
+
+                handles.push_back(world.Create(sphere));
+            }
+        }
+
+        for(int i = 0; i < 30; i++) {
+            world.Tick();
+        }
+
+        for(std::size_t i = 1; i < handles.size(); i += 7) {
+            world.Destroy(handles[i]);
+        }
+
+        return handles;
+    };
+
+    Physics::PhysicsWorld world;
+    world.SetSleepThreshold(0.5f, 0.1f);
+
+    auto handles = createWorld(world);
+
+    std::stringstream stream;
+    world.WriteSnapshot(stream);
+
+    auto snapshot = stream.str();
+    std::span<const std::byte> data{reinterpret_cast<const std::byte*>(snapshot.data()), snapshot.size()};
+
+    auto headerContactCount = reinterpret_cast<const Physics::SnapshotHeader*>(snapshot.data())->contactCount;
+
+    EXPECT_EQ(data.size(), sizeof(Physics::SnapshotHeader) + world.GetBodyCount() * sizeof(Physics::BodySnapshot) + handles.size() * sizeof(Physics::HandleSlotSnapshot) +
+        headerContactCount * sizeof(Physics::ContactSnapshot));
+
+    // Restored over a world that already has bodies
+    Physics::PhysicsWorld restored;
+    restored.CreateSphere({0, 0, 0}, 1);
+    restored.RestoreSnapshot(data);
+
+    EXPECT_EQ(restored.GetBodyCount(), world.GetBodyCount());
+    EXPECT_EQ(restored.GetSimulationTime(), world.GetSimulationTime());
+    EXPECT_GT(restored.GetSleepingBodyCount(), 0);
+
+    for(int i = 0; i < 60; i++) {
+        world.Tick();
+        restored.Tick();
+
+        ASSERT_EQ(world.GetContacts().size(), restored.GetContacts().size());
+
+        for(auto handle : handles) {
+            ASSERT_EQ(world.IsValid(handle), restored.IsValid(handle));
+
+            if(!world.IsValid(handle)) continue;
+
+            auto position = world.GetPosition(handle);
+            auto restoredPosition = restored.GetPosition(handle);
+            auto velocity = world.GetVelocity(handle);
+            auto restoredVelocity = restored.GetVelocity(handle);
+
+            ASSERT_TRUE(Identical(position.x, restoredPosition.x) && Identical(position.y, restoredPosition.y) && Identical(position.z, restoredPosition.z));
+            ASSERT_TRUE(Identical(velocity.x, restoredVelocity.x) && Identical(velocity.y, restoredVelocity.y) && Identical(velocity.z, restoredVelocity.z));
+        }
+    }
+
+    // The same state gives the same bytes
+    std::stringstream stream1;
+    std::stringstream stream2;
+    world.WriteSnapshot(stream1);
+    restored.WriteSnapshot(stream2);
+
+    EXPECT_EQ(stream1.str(), stream2.str());
+
+    // Through a memory mapped file
+    auto path = std::filesystem::temp_directory_path() / "physics_snapshot_test.bin";
+    world.SaveSnapshot(path);
+
+    Physics::PhysicsWorld loaded;
+    loaded.LoadSnapshot(path);
+    std::filesystem::remove(path);
+
+    std::stringstream stream3;
+    loaded.WriteSnapshot(stream3);
+
+    EXPECT_EQ(stream1.str(), stream3.str());
+
+    // Invalid snapshots are rejected without changing the world
+    EXPECT_THROW(restored.RestoreSnapshot(data.first(data.size() - 1)), std::runtime_error);
+
+    auto corrupted = snapshot;
+    corrupted[0] = 'X';
+    EXPECT_THROW(restored.RestoreSnapshot({reinterpret_cast<const std::byte*>(corrupted.data()), corrupted.size()}), std::runtime_error);
+
+    // The free list must stay in bounds, and end
+    auto corruptHeader = [&](auto change) {
+        auto corruptedList = snapshot;
+        Physics::SnapshotHeader header;
+        std::memcpy(&header, corruptedList.data(), sizeof(header));
+
+        change(corruptedList, header);
+
+        std::memcpy(corruptedList.data(), &header, sizeof(header));
+
+        return corruptedList;
+    };
+
+    auto outOfRange = corruptHeader([](std::string&, Physics::SnapshotHeader& header) {
+        header.firstFreeSlot = static_cast<std::uint32_t>(header.slotCount);
+    });
+
+    auto cycle = corruptHeader([](std::string& bytes, Physics::SnapshotHeader& header) {
+        ASSERT_NE(header.firstFreeSlot, Physics::BodyHandle::invalidIndex);
+
+        // The first free slot points back at itself
+        auto offset = header.slotsOffset + header.firstFreeSlot * sizeof(Physics::HandleSlotSnapshot) + offsetof(Physics::HandleSlotSnapshot, index);
+        std::memcpy(bytes.data() + offset, &header.firstFreeSlot, sizeof(header.firstFreeSlot));
+    });
+
+    EXPECT_THROW(restored.RestoreSnapshot({reinterpret_cast<const std::byte*>(outOfRange.data()), outOfRange.size()}), std::runtime_error);
+    EXPECT_THROW(restored.RestoreSnapshot({reinterpret_cast<const std::byte*>(cycle.data()), cycle.size()}), std::runtime_error);
+
+    EXPECT_EQ(restored.GetBodyCount(), world.GetBodyCount());
+
+    // A resting pile has contacts that last between ticks, whose impulses warm start the solver
+    Physics::PhysicsWorld pile;
+    pile.CreatePlane(0);
+
+    std::vector<Physics::BodyHandle> pileHandles;
+
+    for(int i = 0; i < 200; i++) {
+        Physics::SphereCollider sphere{{(i % 10) * 0.9f, 0.5f + (i / 100) * 0.9f, ((i / 10) % 10) * 0.9f}, 1, {}};
+        sphere.restitution = 0;
+
+        pileHandles.push_back(pile.Create(sphere));
+    }
+
+    for(int i = 0; i < 30; i++) {
+        pile.Tick();
+    }
+
+    std::stringstream pileStream;
+    pile.WriteSnapshot(pileStream);
+
+    auto pileSnapshot = pileStream.str();
+
+    EXPECT_GT(reinterpret_cast<const Physics::SnapshotHeader*>(pileSnapshot.data())->contactCount, 0);
+
+    Physics::PhysicsWorld restoredPile;
+    restoredPile.RestoreSnapshot({reinterpret_cast<const std::byte*>(pileSnapshot.data()), pileSnapshot.size()});
+
+    for(int i = 0; i < 10; i++) {
+        pile.Tick();
+        restoredPile.Tick();
+
+        ASSERT_EQ(pile.GetContactEvents().size(), restoredPile.GetContactEvents().size());
+
+        for(std::size_t j = 0; j < pile.GetContactEvents().size(); j++) {
+            ASSERT_EQ(pile.GetContactEvents()[j].type, restoredPile.GetContactEvents()[j].type);
+        }
+
+        for(auto handle : pileHandles) {
+            auto position = pile.GetPosition(handle);
+            auto restoredPosition = restoredPile.GetPosition(handle);
+
+            ASSERT_TRUE(Identical(position.x, restoredPosition.x) && Identical(position.y, restoredPosition.y) && Identical(position.z, restoredPosition.z));
+        }
+    }
+
+    // Destroying a body straight after restoring over a world that has ticked
+    restored.RestoreSnapshot(data);
+    restored.Destroy(handles[2]);
+    restored.Tick();
+
+    EXPECT_EQ(restored.GetBodyCount(), world.GetBodyCount() - 1);
+
+    // Restoring an empty snapshot removes every body, including from the query tree
+    std::stringstream emptyStream;
+    Physics::PhysicsWorld{}.WriteSnapshot(emptyStream);
+
+    auto emptySnapshot = emptyStream.str();
+
+    ASSERT_TRUE(restored.Raycast({{0, 100, 0}, {0, -1, 0}}).body.IsValid());
+
+    restored.RestoreSnapshot({reinterpret_cast<const std::byte*>(emptySnapshot.data()), emptySnapshot.size()});
+
+    EXPECT_EQ(restored.GetBodyCount(), 0);
+    EXPECT_FALSE(restored.Raycast({{0, 100, 0}, {0, -1, 0}}).body.IsValid());
+
+    restored.Tick();
+}
+
+TEST_F(CollisionTestsFixture, RollbackTest) {
+    Physics::PhysicsWorld world;
+    world.SetRollbackLength(10);
+
+    std::mt19937 rng{1819};
+    std::uniform_real_distribution<float> positionDist{-10, 10};
+
+    std::vector<Physics::BodyHandle> handles;
+
+    world.CreatePlane(-10);
+
+    for(int i = 0; i < 200; i++) {
+        handles.push_back(world.CreateSphere({positionDist(rng), positionDist(rng), positionDist(rng)}, 1));
+    }
+
+    auto getPositions = [&] {
+        std::vector<glm::vec3> positions;
+
+        for(auto handle : handles) {
+            positions.push_back(world.GetPosition(handle));
+        }
+
+        return positions;
+    };
+
+    // The positions at the start of each tick
+    std::vector<std::vector<glm::vec3>> history;
+
+    for(int i = 0; i < 20; i++) {
+        history.push_back(getPositions());
+        world.Tick();
+    }
+
+    history.push_back(getPositions());
+
+    EXPECT_EQ(world.GetTick(), 20);
+
+    ASSERT_TRUE(world.Rewind(15));
+    EXPECT_EQ(world.GetTick(), 15);
+    EXPECT_EQ(getPositions(), history[15]);
+    EXPECT_EQ(world.GetCollider(handles[0]).position, history[15][0]);
+
+    // Running the same ticks again gives the same results
+    for(int i = 15; i < 20; i++) {
+        world.Tick();
+        EXPECT_EQ(getPositions(), history[i + 1]);
+    }
+
+    // Different input changes the results
+    ASSERT_TRUE(world.Rewind(12));
+    world.SetVelocity(handles[0], {0, 20, 0});
+
+    while(world.GetTick() < 20) {
+        world.Tick();
+    }
+
+    EXPECT_GT(world.GetPosition(handles[0]).y, history[20][0].y);
+    EXPECT_EQ(world.GetPosition(handles[1]), history[20][1]);
+
+    // Only the last 10 ticks are kept
+    EXPECT_FALSE(world.Rewind(5));
+    EXPECT_FALSE(world.Rewind(25));
+    EXPECT_TRUE(world.Rewind(10));
+
+    // Creating a body discards every frame
+    world.CreateSphere({0, 0, 0}, 1);
+    EXPECT_FALSE(world.Rewind(10));
+
+    // So does restoring a snapshot, even one without bodies
+    std::stringstream emptyStream;
+    Physics::PhysicsWorld{}.WriteSnapshot(emptyStream);
+
+    auto emptySnapshot = emptyStream.str();
+
+    world.Tick();
+    world.Tick();
+
+    auto savedTick = world.GetTick() - 1;
+
+    world.RestoreSnapshot({reinterpret_cast<const std::byte*>(emptySnapshot.data()), emptySnapshot.size()});
+
+    EXPECT_FALSE(world.Rewind(savedTick));
+    EXPECT_EQ(world.GetBodyCount(), 0);
+
+    // Rewinding past a static body being moved puts it back where the tree can find it
+    Physics::PhysicsWorld staticWorld;
+    staticWorld.SetRollbackLength(10);
+
+    Physics::SimpleCubeCollider ground{{0, 0, 0}, glm::vec3{4, 1, 4}, {}};
+    ground.isStatic = true;
+    auto groundBody = staticWorld.Create(ground);
+
+    Physics::SimpleCubeCollider box{{0, 2, 0}, glm::vec3{1}, {}};
+    box.restitution = 0;
+    auto boxBody = staticWorld.Create(box);
+
+    staticWorld.Tick();
+    staticWorld.SetPosition(groundBody, {100, 0, 0});
+    staticWorld.Tick();
+
+    ASSERT_TRUE(staticWorld.Rewind(0));
+    EXPECT_EQ(staticWorld.GetPosition(groundBody), (glm::vec3{0, 0, 0}));
+
+    for(int i = 0; i < 60; i++) {
+        staticWorld.Tick();
+    }
+
+    EXPECT_NEAR(staticWorld.GetPosition(boxBody).y, 1, 0.1f);
+}
+
+TEST_F(CollisionTestsFixture, QueryTest) {
+    Physics::PhysicsWorld world;
+
+    auto sphere = world.CreateSphere({0, 0, 0}, 2);
+
+    Physics::SimpleCubeCollider cubeCollider{{10, 0, 0}, glm::vec3{2}, {}};
+    cubeCollider.category = 2;
+    auto cube = world.Create(cubeCollider);
+
+    auto plane = world.CreatePlane(-5);
+
+    auto hit = world.Raycast({{-10, 0, 0}, {1, 0, 0}});
+    EXPECT_EQ(hit.body, sphere);
+    EXPECT_FLOAT_EQ(hit.distance, 9);
+    EXPECT_EQ(hit.point, (glm::vec3{-1, 0, 0}));
+    EXPECT_EQ(hit.normal, (glm::vec3{-1, 0, 0}));
+
+    hit = world.Raycast({{5, 0, 0}, {1, 0, 0}});
+    EXPECT_EQ(hit.body, cube);
+    EXPECT_FLOAT_EQ(hit.distance, 4);
+    EXPECT_EQ(hit.normal, (glm::vec3{-1, 0, 0}));
+
+    hit = world.Raycast({{20, 10, 20}, {0, -1, 0}});
+    EXPECT_EQ(hit.body, plane);
+    EXPECT_FLOAT_EQ(hit.distance, 15);
+    EXPECT_EQ(hit.normal, (glm::vec3{0, 1, 0}));
+
+    // Filtered by layer, too short, and starting inside a body
+    EXPECT_FALSE(world.Raycast({{5, 0, 0}, {1, 0, 0}, 100, 1}).body.IsValid());
+    EXPECT_FALSE(world.Raycast({{-10, 0, 0}, {1, 0, 0}, 5}).body.IsValid());
+    EXPECT_EQ(world.Raycast({{0, 0, 0}, {1, 0, 0}}).body, cube);
+
+    auto sphereHit = world.CastSphere({{-10, 0, 0}, 1, {1, 0, 0}});
+    EXPECT_EQ(sphereHit.body, sphere);
+    EXPECT_FLOAT_EQ(sphereHit.distance, 8);
+    EXPECT_EQ(sphereHit.point, (glm::vec3{-1, 0, 0}));
+
+    std::vector<Physics::Ray> rays = {{{-10, 0, 0}, {1, 0, 0}}, {{0, 10, 0}, {0, 1, 0}}};
+    std::vector<Physics::QueryHit> hits;
+    std::vector<std::size_t> offsets;
+
+    world.RaycastAll(rays, hits, offsets);
+
+    ASSERT_EQ(offsets, (std::vector<std::size_t>{0, 2, 2}));
+    EXPECT_EQ(hits[0].body, sphere);
+    EXPECT_EQ(hits[1].body, cube);
+
+    std::vector<Physics::SphereOverlap> spheres = {{{0, 0, 0}, 0.5f}, {{0, 0, 0}, 9.5f}, {{0, 0, 0}, 9.5f, 2}, {{0, -4.5f, 0}, 1}};
+    std::vector<Physics::BodyHandle> found;
+
+    world.Overlap(spheres, found, offsets);
+
+    EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 1, 4, 5, 6}));
+    EXPECT_EQ(found, (std::vector<Physics::BodyHandle>{sphere, sphere, cube, plane, cube, plane}));
+
+    std::vector<Physics::BoxOverlap> boxes = {{{{-1, -6, -1}, {1, -4, 1}}}, {{{8, -1, -1}, {9.5f, 1, 1}}}};
+
+    world.Overlap(boxes, found, offsets);
+
+    EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 1, 2}));
+    EXPECT_EQ(found, (std::vector<Physics::BodyHandle>{plane, cube}));
+
+    // Thousands of queries against thousands of spheres match testing every sphere
+    Physics::PhysicsWorld randomWorld;
+    randomWorld.SetThreadCount(4);
+
+    std::mt19937 rng{2021};
+    std::uniform_real_distribution<float> positionDist{-50, 50};
+    std::uniform_real_distribution<float> directionDist{-1, 1};
+
+    std::vector<std::pair<Physics::BodyHandle, glm::vec3>> bodies;
+
+    for(int i = 0; i < 2000; i++) {
+        glm::vec3 position{positionDist(rng), positionDist(rng), positionDist(rng)};
+
+        bodies.emplace_back(randomWorld.CreateSphere(position, 2), position);
+    }
+
+    rays.clear();
+
+    for(int i = 0; i < 2000; i++) {
+        glm::vec3 direction{directionDist(rng), directionDist(rng), directionDist(rng)};
+
+        rays.push_back({{positionDist(rng), positionDist(rng), positionDist(rng)}, glm::normalize(direction), 40});
+    }
+
+    hits.resize(rays.size());
+    randomWorld.Raycast(rays, hits);
+
+    for(std::size_t i = 0; i < rays.size(); i++) {
+        auto& ray = rays[i];
+
+        Physics::BodyHandle expected;
+        float expectedDistance = ray.maxDistance;
+
+        for(auto [body, position] : bodies) {
+            auto offset = ray.origin - position;
+            auto b = glm::dot(offset, ray.direction);
+            auto c = glm::dot(offset, offset) - 1;
+            auto discriminant = b * b - c;
+
+            if(c < 0 || b > 0 || discriminant < 0) continue;
+
+            auto distance = -b - std::sqrt(discriminant);
+
+            if(distance <= expectedDistance) {
+                expected = body;
+                expectedDistance = distance;
+            }
+        }
+
+        EXPECT_EQ(hits[i].body, expected);
+    }
+
+    spheres.clear();
+
+    for(int i = 0; i < 2000; i++) {
+        spheres.push_back({{positionDist(rng), positionDist(rng), positionDist(rng)}, 5});
+    }
+
+    randomWorld.Overlap(spheres, found, offsets);
+
+    for(std::size_t i = 0; i < spheres.size(); i++) {
+        std::vector<Physics::BodyHandle> expected;
+
+        for(auto [body, position] : bodies) {
+            auto offset = spheres[i].center - position;
+
+            if(glm::dot(offset, offset) < 6 * 6) {
+                expected.push_back(body);
+            }
+        }
+
+        EXPECT_EQ((std::vector<Physics::BodyHandle>{found.begin() + offsets[i], found.begin() + offsets[i + 1]}), expected);
+    }
+}
+
+TEST_F(CollisionTestsFixture, StaticBodiesTest) {
+    Physics::PhysicsWorld world;
+
+    // A floor of overlapping static cubes, with dynamic cubes falling onto it
+    std::vector<Physics::BodyHandle> floor;
+
+    for(int x = 0; x < 30; x++) {
+        for(int z = 0; z < 30; z++) {
+            Physics::SimpleCubeCollider cube{{x * 0.9f, 0, z * 0.9f}, glm::vec3{1}, {}};
+            cube.isStatic = true;
+
+            floor.push_back(world.Create(cube));
+        }
+    }
+
+    std::vector<Physics::BodyHandle> falling;
+
+    for(int i = 0; i < 10; i++) {
+        Physics::SimpleCubeCollider cube{{i * 2.5f, 3, i * 2.5f}, glm::vec3{1}, {}};
+        cube.restitution = 0;
+
+        falling.push_back(world.Create(cube));
+    }
+
+    // Falls next to the floor until a static cube is moved under it
+    Physics::SimpleCubeCollider lonelyCube{{100, 3, 100}, glm::vec3{1}, {}};
+    lonelyCube.restitution = 0;
+
+    auto lonely = world.Create(lonelyCube);
+
+    for(int i = 0; i < 120; i++) {
+        world.Tick();
+
+        for(auto body : falling) {
+            ASSERT_GT(world.GetPosition(body).y, 0.5f);
+        }
+
+        // Static cubes never move
+        ASSERT_EQ(world.GetPosition(floor[0]), (glm::vec3{0, 0, 0}));
+
+        // Pairs of static cubes are never tested
+        if constexpr(Physics::profilingEnabled) {
+            ASSERT_LT(world.GetStats()[Physics::ProfileCounter::CandidatePairs].last, 100);
+        }
+    }
+
+    EXPECT_LT(world.GetPosition(lonely).y, 0);
+
+    world.SetPosition(lonely, {100, 3, 100});
+    world.SetPosition(floor[1], {100, 0, 100});
+
+    for(int i = 0; i < 120; i++) {
+        world.Tick();
+    }
+
+    EXPECT_GT(world.GetPosition(lonely).y, 0.5f);
+
+    // Destroying the static cube under it lets it fall again
+    world.Destroy(floor[1]);
+    world.Wake(lonely);
+
+    for(int i = 0; i < 60; i++) {
+        world.Tick();
+    }
+
+    EXPECT_LT(world.GetPosition(lonely).y, 0);
+}
+
+TEST_F(CollisionTestsFixture, FilterTest) {
+    Physics::PhysicsWorld world;
+
+    auto plane = world.CreatePlane(0);
+
+    // Overlapping debris, which only collides with other layers
+    std::vector<Physics::BodyHandle> debris;
+
+    for(int i = 0; i < 10; i++) {
+        Physics::SphereCollider sphere{{i * 0.5f, 0.4f, 0}, 1, {}};
+        sphere.category = 2;
+        sphere.mask = ~2u;
+
+        debris.push_back(world.Create(sphere));
+    }
+
+    auto makeCube = [&](glm::vec3 position, std::uint32_t category, std::uint32_t mask, std::int32_t group) {
+        Physics::SimpleCubeCollider cube{position, glm::vec3{1}, {}};
+        cube.category = category;
+        cube.mask = mask;
+        cube.group = group;
+        cube.hasGravity = false;
+
+        return world.Create(cube);
+    };
+
+    // The same negative group never collides, even though the masks match
+    auto neverCube1 = makeCube({20, 5, 0}, 1, Physics::allLayers, -1);
+    auto neverCube2 = makeCube({20.5f, 5, 0}, 1, Physics::allLayers, -1);
+
+    // The same positive group always collides, even though the masks don't match
+    auto alwaysCube1 = makeCube({30, 5, 0}, 4, 0, 1);
+    auto alwaysCube2 = makeCube({30.5f, 5, 0}, 4, 0, 1);
+
+    // Only one of the masks matches
+    auto oneWayCube1 = makeCube({40, 5, 0}, 1, Physics::allLayers, 0);
+    auto oneWayCube2 = makeCube({40.5f, 5, 0}, 1, ~1u, 0);
+
+    world.Tick();
+
+    auto touches = [&](Physics::BodyHandle body1, Physics::BodyHandle body2) {
+        return std::ranges::any_of(world.GetContacts(), [&](const Physics::Contact& contact) {
+            auto& collider1 = world.GetCollider(body1);
+            auto& collider2 = world.GetCollider(body2);
+
+            return (contact.collider1 == &collider1 && contact.collider2 == &collider2) ||
+                   (contact.collider1 == &collider2 && contact.collider2 == &collider1);
+        });
+    };
+
+    for(std::size_t i = 0; i < debris.size(); i++) {
+        EXPECT_TRUE(touches(debris[i], plane));
+
+        for(std::size_t j = i + 1; j < debris.size(); j++) {
+            EXPECT_FALSE(touches(debris[i], debris[j]));
+        }
+    }
+
+    EXPECT_FALSE(touches(neverCube1, neverCube2));
+    EXPECT_TRUE(touches(alwaysCube1, alwaysCube2));
+    EXPECT_FALSE(touches(oneWayCube1, oneWayCube2));
+
+    if constexpr(Physics::profilingEnabled) {
+        auto& stats = world.GetStats();
+
+        // Each sphere of debris overlaps its neighbours, and two of the pairs of cubes are filtered
+        EXPECT_EQ(stats[Physics::ProfileCounter::FilteredPairs].last, 9 + 2);
+        EXPECT_EQ(stats[Physics::ProfileCounter::CandidatePairs].last - stats[Physics::ProfileCounter::FilteredPairs].last, stats[Physics::ProfileCounter::NarrowphaseCalls].last);
+    }
+}
+
+TEST_F(CollisionTestsFixture, ContactEventTest) {
+    Physics::PhysicsWorld world;
+    world.SetRollbackLength(4);
+
+    auto plane = world.CreatePlane(0);
+
+    Physics::SphereCollider resting{{0, 0.5f, 0}, 1, {}};
+    resting.restitution = 0;
+
+    auto sphere = world.Create(resting);
+
+    // Moves towards target, which it hits after a few ticks and then bounces off of
+    Physics::SphereCollider movingCollider{{10, 5, 0}, 1, {6, 0, 0}};
+    movingCollider.hasGravity = false;
+
+    Physics::SphereCollider targetCollider{{12, 5, 0}, 1, {}};
+    targetCollider.hasGravity = false;
+
+    auto moving = world.Create(movingCollider);
+    auto target = world.Create(targetCollider);
+
+    auto countEvents = [&](Physics::ContactEventType type, Physics::BodyHandle body1, Physics::BodyHandle body2) {
+        return std::ranges::count_if(world.GetContactEvents(), [&](const Physics::ContactEvent& event) {
+            // Pairs are always ordered by handle slot
+            return event.type == type && event.pair.body1 == std::min(body1, body2) && event.pair.body2 == std::max(body1, body2);
+        });
+    };
+
+    // Running a tick again after rewinding reports the same events, including Persist events for contacts from before the tick
+    auto checkRewind = [&] {
+        std::vector<Physics::ContactEvent> events{world.GetContactEvents().begin(), world.GetContactEvents().end()};
+
+        ASSERT_FALSE(events.empty());
+        ASSERT_TRUE(world.Rewind(world.GetTick() - 1));
+        EXPECT_TRUE(world.GetContactEvents().empty());
+
+        world.Tick();
+
+        ASSERT_EQ(world.GetContactEvents().size(), events.size());
+
+        for(std::size_t i = 0; i < events.size(); i++) {
+            EXPECT_EQ(world.GetContactEvents()[i].type, events[i].type);
+            EXPECT_EQ(world.GetContactEvents()[i].pair.body1, events[i].pair.body1);
+            EXPECT_EQ(world.GetContactEvents()[i].pair.body2, events[i].pair.body2);
+        }
+    };
+
+    std::ptrdiff_t restingBegins = 0;
+    std::ptrdiff_t restingEnds = 0;
+    std::ptrdiff_t movingBegins = 0;
+    std::ptrdiff_t movingEnds = 0;
+
+    for(int i = 0; i < 90; i++) {
+        world.Tick();
+
+        if(i == 5) {
+            checkRewind();
+        }
+
+        restingBegins += countEvents(Physics::ContactEventType::Begin, sphere, plane);
+        restingEnds += countEvents(Physics::ContactEventType::End, sphere, plane);
+        movingBegins += countEvents(Physics::ContactEventType::Begin, moving, target);
+        movingEnds += countEvents(Physics::ContactEventType::End, moving, target);
+
+        // A pair that is touching gets exactly one event per tick while it is tested
+        if(world.IsAwake(sphere)) {
+            EXPECT_EQ(countEvents(Physics::ContactEventType::Begin, sphere, plane) + countEvents(Physics::ContactEventType::Persist, sphere, plane), 1);
+        }
+    }
+
+    // Falling asleep doesn't end the contact
+    EXPECT_FALSE(world.IsAwake(sphere));
+    EXPECT_EQ(restingBegins, 1);
+    EXPECT_EQ(restingEnds, 0);
+
+    EXPECT_EQ(movingBegins, 1);
+    EXPECT_EQ(movingEnds, 1);
+
+    // Destroying a body ends its contacts during the next tick, with the old handle
+    world.Destroy(sphere);
+    world.Tick();
+
+    EXPECT_EQ(countEvents(Physics::ContactEventType::End, sphere, plane), 1);
+    EXPECT_EQ(world.GetContactEvents().size(), 1);
+}
+
+TEST_F(CollisionTestsFixture, SolverTest) {
+    auto simulateStack = [](const Physics::SolverSettings& settings) {
+        Physics::PhysicsWorld world;
+        world.SetSolverSettings(settings);
+        world.CreatePlane(0);
+
+        std::vector<Physics::BodyHandle> stack;
+
+        for(int y = 0; y < 5; y++) {
+            Physics::SimpleCubeCollider cube{{0, 0.5f + y, 0}, glm::vec3{1}, {}};
+            cube.restitution = 0;
+
+            stack.push_back(world.Create(cube));
+        }
+
+        for(int i = 0; i < 240; i++) {
+            world.Tick();
+        }
+
+        // How far the top of the stack sank
+        auto sink = 4.5f - world.GetPosition(stack.back()).y;
+
+        return std::pair{sink, world.GetSleepingBodyCount()};
+    };
+
+    // The defaults keep the stack standing until it falls asleep
+    auto [sink, sleepingCount] = simulateStack({});
+
+    EXPECT_GE(sink, 0);
+    EXPECT_LT(sink, 0.1f);
+    EXPECT_EQ(sleepingCount, 5);
+
+    // A single impulse per contact, without warm starting or correcting penetration, lets the stack sink into itself
+    Physics::SolverSettings oneShot;
+    oneShot.iterations = 1;
+    oneShot.warmStarting = false;
+    oneShot.correctionFactor = 0;
+
+    EXPECT_GT(simulateStack(oneShot).first, 1);
+
+    // Each contact's impulse is kept between ticks, and reported with its events
+    Physics::PhysicsWorld world;
+    world.CreatePlane(0);
+
+    Physics::SimpleCubeCollider cube{{0, 0.5f, 0}, glm::vec3{1}, {}};
+    cube.restitution = 0;
+    world.Create(cube);
+
+    for(int i = 0; i < 3; i++) {
+        world.Tick();
+    }
+
+    ASSERT_EQ(world.GetContacts().size(), 1);
+    ASSERT_EQ(world.GetContactEvents().size(), 1);
+
+    // Holding the cube up against one tick of gravity
+    auto expectedImpulse = Physics::earthGravity / world.GetTickRate();
+
+    EXPECT_NEAR(world.GetContacts()[0].impulse, expectedImpulse, expectedImpulse * 0.01f);
+    EXPECT_EQ(world.GetContactEvents()[0].pair.impulse, world.GetContacts()[0].impulse);
+
+    // Large spheres meeting head on stop each other, instead of passing through
+    Physics::PhysicsWorld spheresWorld;
+
+    Physics::SphereCollider left{{-5, 0, 0}, 4, {5, 0, 0}};
+    Physics::SphereCollider right{{5, 0, 0}, 4, {-5, 0, 0}};
+    left.restitution = 0;
+    right.restitution = 0;
+    left.hasGravity = false;
+    right.hasGravity = false;
+
+    auto leftBody = spheresWorld.Create(left);
+    auto rightBody = spheresWorld.Create(right);
+
+    for(int i = 0; i < 120; i++) {
+        spheresWorld.Tick();
+
+        for(auto& contact : spheresWorld.GetContacts()) {
+            ASSERT_NEAR(glm::length(contact.normal), 1, 1e-5f);
+        }
+    }
+
+    auto gap = spheresWorld.GetPosition(rightBody).x - spheresWorld.GetPosition(leftBody).x;
+
+    EXPECT_GT(gap, 3.8f);
+    EXPECT_LT(gap, 4.2f);
+}
+
+TEST_F(CollisionTestsFixture, AsyncWorldTest) {
+    Physics::PhysicsWorld world;
+    world.SetTickRate(120);
+    world.CreatePlane(0);
+
+    auto sphere = world.CreateSphere({0, 5, 0}, 1);
+
+    Physics::AsyncWorld async{world};
+
+    // Waits for the simulation thread to publish a snapshot that satisfies condition
+    auto waitFor = [&](auto condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+
+        while(!condition(async.GetSnapshot())) {
+            if(std::chrono::steady_clock::now() > deadline) return false;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        return true;
+    };
+
+    async.Start();
+    EXPECT_TRUE(async.IsRunning());
+
+    // The sphere falls while the test thread only reads snapshots
+    ASSERT_TRUE(waitFor([&](const Physics::AsyncSnapshot& snapshot) {
+        auto transform = snapshot.Find(sphere);
+
+        return transform && transform->position.y < 4.5f;
+    }));
+
+    auto request = async.Create(Physics::SphereCollider{{10, 5, 0}, 1, {}});
+    ASSERT_TRUE(request);
+
+    Physics::BodyHandle created;
+
+    ASSERT_TRUE(waitFor([&](const Physics::AsyncSnapshot& snapshot) {
+        for(auto& body : snapshot.createdBodies) {
+            if(body.request == *request) {
+                created = body.body;
+            }
+        }
+
+        return created.IsValid() && snapshot.Find(created);
+    }));
+
+    EXPECT_TRUE(async.ApplyImpulse(created, {0, 100, 0}));
+
+    ASSERT_TRUE(waitFor([&](const Physics::AsyncSnapshot& snapshot) {
+        return snapshot.Find(created)->position.y > 6;
+    }));
+
+    EXPECT_TRUE(async.Destroy(sphere));
+
+    ASSERT_TRUE(waitFor([&](const Physics::AsyncSnapshot& snapshot) {
+        return snapshot.Find(sphere) == nullptr;
+    }));
+
+    // Commands for destroyed bodies are ignored
+    EXPECT_TRUE(async.Destroy(sphere));
+
+    async.Stop();
+    EXPECT_FALSE(async.IsRunning());
+
+    // Once stopped, the world can be used directly again
+    EXPECT_FALSE(world.IsValid(sphere));
+    EXPECT_TRUE(world.IsValid(created));
+    EXPECT_EQ(world.GetBodyCount(), 2);
+    EXPECT_EQ(async.GetSnapshot().bodies.size(), 2);
+
+    // The queue rejects commands once it is full
+    Physics::AsyncWorld small{world, 4};
+
+    for(int i = 0; i < 4; i++) {
+        EXPECT_TRUE(small.SetVelocity(created, {}));
+    }
+
+    EXPECT_FALSE(small.SetVelocity(created, {}));
+}
+
+TEST_F(CollisionTestsFixture, WorldRunnerTest) {
+    constexpr std::size_t worldCount = 50;
+
+    auto populate = [](Physics::PhysicsWorld& world, std::size_t seed) {
+        world.CreatePlane(0);
+
+        for(std::size_t i = 0; i < 10; i++) {
+            world.CreateSphere({static_cast<float>(i % 3), static_cast<float>(1 + i + seed % 7), static_cast<float>(i / 3)}, 1);
+        }
+    };
+
+    Physics::WorldRunner runner{4};
+
+    for(std::size_t i = 0; i < worldCount; i++) {
+        populate(runner.CreateWorld(11), i);
+    }
+
+    EXPECT_EQ(runner.GetWorldCount(), worldCount);
+    EXPECT_EQ(runner.GetThreadCount(), 4);
+
+    runner.StepAll(30);
+
+    // Each world gives the same results as ticking it on its own
+    for(std::size_t i = 0; i < worldCount; i += 7) {
+        Physics::PhysicsWorld world;
+        populate(world, i);
+
+        for(int tick = 0; tick < 30; tick++) {
+            world.Tick();
+        }
+
+        auto& stepped = runner.GetWorld(i);
+
+        ASSERT_EQ(stepped.GetTick(), 30);
+
+        for(std::uint32_t slot = 0; slot < world.GetBodyCount(); slot++) {
+            Physics::BodyHandle body{slot, 0};
+
+            EXPECT_EQ(stepped.GetPosition(body), world.GetPosition(body));
+        }
+    }
+
+    ASSERT_EQ(runner.GetStepTimes().size(), worldCount);
+
+    for(auto time : runner.GetStepTimes()) {
+        EXPECT_GT(time, 0);
+    }
+
+    // The last world takes the destroyed world's place
+    auto last = &runner.GetWorld(worldCount - 1);
+    runner.DestroyWorld(0);
+
+    EXPECT_EQ(runner.GetWorldCount(), worldCount - 1);
+    EXPECT_EQ(&runner.GetWorld(0), last);
+    EXPECT_EQ(runner.GetStepTimes().size(), worldCount - 1);
+}
+
+TEST_F(CollisionTestsFixture, MultiRateTest) {
+    // A body stepping every 4 ticks lands where a body stepping every tick does, once their steps line up
+    {
+        Physics::PhysicsWorld world;
+
+        auto everyTick = world.CreateSphere({0, 0, 0}, 1, {1, 0, 0});
+        auto everyFourth = world.CreateSphere({10, 0, 0}, 1, {1, 0, 0});
+
+        world.SetTickLevel(everyFourth, 2);
+        EXPECT_EQ(world.GetTickLevel(everyFourth), 2);
+
+        for(int i = 0; i < 6; i++) {
+            world.Tick();
+        }
+
+        // Not moved since its step at the end of tick 4
+        EXPECT_NEAR(world.GetPosition(everyFourth).x, 10 + 4 / 60.0f, 0.0001f);
+
+        for(int i = 0; i < 2; i++) {
+            world.Tick();
+        }
+
+        EXPECT_EQ(world.GetSteppedBodyCount(), 2);
+
+        auto expected = world.GetPosition(everyTick) + glm::vec3{10, 0, 0};
+        auto position = world.GetPosition(everyFourth);
+
+        EXPECT_NEAR(position.x, expected.x, 0.0001f);
+        EXPECT_NEAR(position.y, expected.y, 0.0001f);
+        EXPECT_NEAR(world.GetVelocity(everyFourth).y, world.GetVelocity(everyTick).y, 0.0001f);
+    }
+
+    // A fast body hitting a slow one catches it up first, so the collision matches one where both step every tick
+    auto simulateCollision = [](std::uint8_t level) {
+        Physics::PhysicsWorld world;
+
+        Physics::SphereCollider moving{{0, 0, 0}, 1, {5, 0, 0}};
+        moving.hasGravity = false;
+
+        Physics::SphereCollider resting{{3, 0, 0}, 1, {}};
+        resting.hasGravity = false;
+
+        auto first = world.Create(moving);
+        auto second = world.Create(resting);
+
+        world.SetTickLevel(second, level);
+
+        for(int i = 0; i < 64; i++) {
+            world.Tick();
+        }
+
+        return std::pair{world.GetPosition(first), world.GetPosition(second)};
+    };
+
+    auto [expected1, expected2] = simulateCollision(0);
+    auto [position1, position2] = simulateCollision(3);
+
+    // The collision moved the second body
+    EXPECT_GT(expected2.x, 3.5f);
+
+    EXPECT_NEAR(position1.x, expected1.x, 0.01f);
+    EXPECT_NEAR(position2.x, expected2.x, 0.01f);
+
+    // Distant bodies step less often
+    Physics::PhysicsWorld world;
+    world.SetSleepingEnabled(false);
+
+    for(int i = 0; i < 100; i++) {
+        Physics::SphereCollider sphere{{i * 3.0f, 0, 0}, 1, {0, 0, 1}};
+        sphere.hasGravity = false;
+
+        world.Create(sphere);
+    }
+
+    world.SetTickLevelFunction([](Physics::BodyHandle, glm::vec3 position) -> std::uint8_t {
+        return position.x < 150 ? 0 : 3;
+    });
+
+    for(int i = 0; i < 9; i++) {
+        world.Tick();
+    }
+
+    EXPECT_EQ(world.GetTickLevel({0, 0}), 0);
+    EXPECT_EQ(world.GetTickLevel({99, 0}), 3);
+
+    // Only the near half stepped during the last tick
+    EXPECT_EQ(world.GetSteppedBodyCount(), 50);
+    EXPECT_EQ(world.GetAwakeBodyCount(), 100);
+
+    for(int i = 0; i < 7; i++) {
+        world.Tick();
+    }
+
+    // Every body has moved the same distance once their steps line up
+    EXPECT_NEAR(world.GetPosition({0, 0}).z, world.GetPosition({99, 0}).z, 0.0001f);
+}
+
+TEST_F(CollisionTestsFixture, StreamingTest) {
+    auto directory = std::filesystem::temp_directory_path() / "physics_streaming_test";
+    std::filesystem::remove_all(directory);
+
+    // In memory, then on disk
+    for(auto path : {std::filesystem::path{}, directory}) {
+        Physics::PhysicsWorld world;
+
+        Physics::StreamingSettings settings;
+        settings.cellSize = 10;
+        settings.activationRadius = 15;
+        settings.deactivationRadius = 25;
+        settings.maxCreatedPerUpdate = 8;
+        settings.directory = path;
+
+        Physics::CellStreamer streamer{world, settings};
+
+        // A row of static spheres, 1 per metre, 1km long
+        for(int i = 0; i < 1000; i++) {
+            Physics::SphereCollider sphere{{i + 0.5f, 0, 5}, 0.25f, {}};
+            sphere.isStatic = true;
+
+            EXPECT_FALSE(streamer.Add(sphere).IsValid());
+        }
+
+        auto updateAt = [&](glm::vec3 focus) {
+            // Loading a cell can take several updates, since each one only creates a few bodies
+            for(int i = 0; i < 10; i++) {
+                streamer.Update(std::span{&focus, 1});
+                streamer.Flush();
+            }
+        };
+
+        updateAt({0, 0, 5});
+
+        EXPECT_EQ(streamer.GetState(streamer.GetCell({5, 0, 5})), Physics::CellState::Active);
+        EXPECT_EQ(streamer.GetState(streamer.GetCell({500, 0, 5})), Physics::CellState::Inactive);
+
+        // The cells from -20 to 20m are loaded, but only the ones from 0 have bodies
+        EXPECT_EQ(world.GetBodyCount(), 20);
+        EXPECT_EQ(streamer.GetActiveBodyCount(), 20);
+
+        // Bodies added to an active cell are created straight away
+        auto added = streamer.Add(Physics::SphereCollider{{3, 10, 5}, 0.25f, {}});
+
+        EXPECT_TRUE(world.IsValid(added));
+
+        world.SetPosition(added, {12, 10, 5});
+
+        // Moving the focus unloads the cells behind it, so the world doesn't grow
+        for(float x = 0; x <= 500; x += 50) {
+            updateAt({x, 0, 5});
+
+            EXPECT_LE(world.GetBodyCount(), 61);
+        }
+
+        EXPECT_FALSE(world.IsValid(added));
+        EXPECT_EQ(streamer.GetState(streamer.GetCell({5, 0, 5})), Physics::CellState::Inactive);
+        EXPECT_EQ(world.GetBodyCount(), 40);
+
+        // Bodies are stored with the cell they moved into
+        updateAt({0, 0, 5});
+
+        ASSERT_EQ(world.GetBodyCount(), 21);
+
+        Physics::TransformSnapshot transforms;
+        world.CopyTransforms(transforms);
+
+        std::vector<float> positions;
+
+        for(auto& transform : transforms.bodies) {
+            positions.push_back(transform.position.x);
+        }
+
+        std::ranges::sort(positions);
+
+        EXPECT_EQ(positions[12], 12);
+
+        for(int i = 0; i < 20; i++) {
+            EXPECT_EQ(positions[i + (i >= 12)], i + 0.5f);
+        }
+    }
+
+    EXPECT_TRUE(std::filesystem::is_directory(directory));
+
+    std::filesystem::remove_all(directory);
+
+    // Destroying the streamer while a cell is loading stores the bodies that weren't created again
+    for(int updates : {1, 2}) {
+        Physics::PhysicsWorld world;
+
+        Physics::StreamingSettings settings;
+        settings.cellSize = 10;
+        settings.activationRadius = 5;
+        settings.deactivationRadius = 5;
+        settings.maxCreatedPerUpdate = 1;
+        settings.directory = directory;
+
+        {
+            Physics::CellStreamer streamer{world, settings};
+
+            for(int i = 0; i < 5; i++) {
+                streamer.Add(Physics::SphereCollider{{i + 0.5f, 0, 5}, 0.25f, {}});
+            }
+
+            glm::vec3 focus{5, 0, 5};
+
+            // The first update starts loading the cell, and the second creates one of its bodies
+            for(int i = 0; i < updates; i++) {
+                streamer.Update(std::span{&focus, 1});
+                streamer.Flush();
+            }
+        }
+
+        auto createdCount = static_cast<std::size_t>(updates - 1);
+
+        EXPECT_EQ(world.GetBodyCount(), createdCount);
+        EXPECT_EQ(std::filesystem::file_size(directory / "cell_0_0.bin"), sizeof(Physics::CellHeader) + (5 - createdCount) * sizeof(Physics::BodySnapshot));
+
+        // A streamer over the same directory loads the stored bodies, and doesn't store them twice when it unloads them again
+        {
+            Physics::PhysicsWorld reopenedWorld;
+            Physics::CellStreamer reopened{reopenedWorld, settings};
+
+            EXPECT_EQ(reopened.GetState({0, 0}), Physics::CellState::Inactive);
+
+            for(glm::vec3 focus : {glm::vec3{5, 0, 5}, glm::vec3{500, 0, 5}, glm::vec3{5, 0, 5}}) {
+                for(int i = 0; i < 10; i++) {
+                    reopened.Update(std::span{&focus, 1});
+                    reopened.Flush();
+                }
+            }
+
+            EXPECT_EQ(reopenedWorld.GetBodyCount(), 5 - createdCount);
+        }
+
+        std::filesystem::remove_all(directory);
+    }
+}
+
+TEST_F(CollisionTestsFixture, HeightfieldTest) {
+    // Neither size is a multiple of the tile size, so the last tiles are padded
+    constexpr std::uint32_t countX = 13;
+    constexpr std::uint32_t countZ = 11;
+
+    // A slope rising along x
+    std::vector<float> heights(countX * countZ);
+
+    for(std::uint32_t z = 0; z < countZ; z++) {
+        for(std::uint32_t x = 0; x < countX; x++) {
+            heights[z * countX + x] = x * 0.25f;
+        }
+    }
+
+    auto heightfield = std::make_shared<Physics::Heightfield>(countX, countZ, 1.0f, heights);
+
+    for(std::uint32_t z = 0; z < countZ; z++) {
+        for(std::uint32_t x = 0; x < countX; x++) {
+            EXPECT_EQ(heightfield->GetHeight(x, z), heights[z * countX + x]);
+        }
+    }
+
+    EXPECT_EQ(heightfield->GetSize(), (glm::vec3{12, 3, 10}));
+    EXPECT_FLOAT_EQ(heightfield->GetSurfaceHeight(2.5f, 3.75f), 0.625f);
+    EXPECT_FLOAT_EQ(heightfield->GetHighestPoint(4.5f, 0, 5.5f, 1), 1.375f);
+    EXPECT_EQ(heightfield->GetHighestPoint(20, 0, 21, 1), -std::numeric_limits<float>::infinity());
+
+    EXPECT_THROW((Physics::Heightfield{1, 4, 1.0f, std::vector<float>(4)}), std::invalid_argument);
+    EXPECT_THROW((Physics::Heightfield{2, 2, 1.0f, std::vector<float>(3)}), std::invalid_argument);
+
+    // Loaded heightfields read the file in place
+    auto path = std::filesystem::temp_directory_path() / "physics_heightfield_test.bin";
+    heightfield->Save(path);
+
+    {
+        Physics::Heightfield loaded{path};
+
+        EXPECT_EQ(loaded.GetCountX(), countX);
+        EXPECT_EQ(loaded.GetCountZ(), countZ);
+        EXPECT_EQ(loaded.GetMaxHeight(), 3);
+        EXPECT_EQ(loaded.GetHeight(12, 10), 3);
+        EXPECT_FLOAT_EQ(loaded.GetSurfaceHeight(7.25f, 9.5f), 1.8125f);
+    }
+
+    std::filesystem::resize_file(path, 40);
+    EXPECT_THROW(Physics::Heightfield{path}, std::runtime_error);
+
+    // Headers without heights, whose sizes would wrap around, and whose heights are the wrong way around
+    auto writeHeader = [&](Physics::HeightfieldHeader header, std::size_t heightCount) {
+        std::vector<float> heights(heightCount);
+
+        std::ofstream stream{path, std::ios::binary};
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(heights.data()), static_cast<std::streamsize>(heights.size() * sizeof(float)));
+    };
+
+    writeHeader({Physics::heightfieldMagic, Physics::heightfieldVersion, 0xFFFFFFFF, 0xFFFFFFFF, Physics::Heightfield::tileSize, 1, 0, 1}, 0);
+    EXPECT_THROW(Physics::Heightfield{path}, std::runtime_error);
+
+    // A 2 by 2 heightfield is stored as one tile
+    writeHeader({Physics::heightfieldMagic, Physics::heightfieldVersion, 2, 2, Physics::Heightfield::tileSize, 1, 1, 0}, Physics::Heightfield::tileSize * Physics::Heightfield::tileSize);
+    EXPECT_THROW(Physics::Heightfield{path}, std::runtime_error);
+
+    std::filesystem::remove(path);
+
+    Physics::HeightfieldCollider terrain{{-6, 0, -5}, heightfield};
+
+    EXPECT_TRUE(terrain.isStatic);
+    EXPECT_EQ(terrain.position, (glm::vec3{0, 1.5f, 0}));
+    EXPECT_EQ(terrain.GetOrigin(), (glm::vec3{-6, 0, -5}));
+    EXPECT_THROW((Physics::HeightfieldCollider{{}, nullptr}), std::invalid_argument);
+
+    EXPECT_TRUE(terrain.SupportsCollisionWith(Physics::SphereCollider{{}, 1, {}}));
+    EXPECT_TRUE(terrain.SupportsCollisionWith(CreateCube({}, 1)));
+    EXPECT_FALSE(terrain.SupportsCollisionWith(Physics::SimplePlaneCollider{0}));
+    EXPECT_FALSE(terrain.SupportsCollisionWith(terrain));
+
+    // The surface at x = 0 is at 1.5, so a sphere of radius 0.5 at 1.9 is 0.1 into the slope
+    Physics::SphereCollider sphere{{0, 1.9f, 0}, 1, {}};
+    auto sphereResult = terrain.CollidesWith(sphere);
+    auto slopeNormal = glm::normalize(glm::vec3{-0.25f, 1, 0});
+
+    ASSERT_TRUE(sphereResult.collides);
+    EXPECT_NEAR(sphereResult.penetration, 0.5f - 0.4f * slopeNormal.y, 1e-5f);
+    EXPECT_NEAR(glm::dot(sphereResult.normal, slopeNormal), 1, 1e-5f);
+
+    sphere.position.y = 2.1f;
+    EXPECT_FALSE(terrain.CollidesWith(sphere));
+
+    // Cubes are pushed up by the highest point of the surface under them
+    auto cubeResult = terrain.CollidesWith(CreateCube({0, 1.9f, 0}, 1));
+
+    ASSERT_TRUE(cubeResult.collides);
+    EXPECT_FLOAT_EQ(cubeResult.penetration, 0.225f);
+    EXPECT_EQ(cubeResult.normal, (glm::vec3{0, 1, 0}));
+    EXPECT_FALSE(terrain.CollidesWith(CreateCube({0, 2.2f, 0}, 1)));
+
+    // Bodies dropped on the terrain come to rest on it
+    Physics::PhysicsWorld world;
+    world.Create(terrain);
+
+    Physics::SimpleCubeCollider cube{{0, 4, 0}, glm::vec3{1}, {}};
+    cube.restitution = 0;
+    auto cubeBody = world.Create(cube);
+
+    Physics::SphereCollider ball{{3, 4, 3}, 1, {}};
+    ball.restitution = 0;
+    auto ballBody = world.Create(ball);
+
+    for(int i = 0; i < 120; i++) {
+        world.Tick();
+    }
+
+    EXPECT_NEAR(world.GetPosition(cubeBody).y, 2.125f, 0.05f);
+
+    // The sphere rolls down the slope, but stays on the surface
+    auto ballPosition = world.GetPosition(ballBody);
+    auto surface = heightfield->GetSurfaceHeight(ballPosition.x + 6, ballPosition.z + 5);
+
+    EXPECT_GT(ballPosition.y, surface);
+    EXPECT_LT(ballPosition.y, surface + 0.6f);
+
+    // Queries hit the surface instead of the bounds
+    Physics::PhysicsWorld queryWorld;
+    auto terrainBody = queryWorld.Create(terrain);
+
+    // The surface at x = -3.5 is at 0.625
+    auto down = queryWorld.Raycast({{-3.5f, 10, 0}, {0, -1, 0}});
+
+    EXPECT_EQ(down.body, terrainBody);
+    EXPECT_NEAR(down.distance, 9.375f, 1e-5f);
+    EXPECT_NEAR(glm::dot(down.normal, slopeNormal), 1, 1e-5f);
+
+    // Crosses several cells before meeting the slope at x = 2
+    auto slanted = queryWorld.Raycast({{-6, 10, 0}, glm::normalize(glm::vec3{1, -1, 0})});
+
+    EXPECT_EQ(slanted.body, terrainBody);
+    EXPECT_NEAR(slanted.point.x, 2, 1e-4f);
+    EXPECT_NEAR(slanted.point.y, 2, 1e-4f);
+
+    EXPECT_FALSE(queryWorld.Raycast({{-3.5f, 10, 0}, {0, -1, 0}, 9}).body.IsValid());
+    EXPECT_FALSE(queryWorld.Raycast({{0, 0, 0}, {0, 1, 0}}).body.IsValid());
+
+    auto sphereCast = queryWorld.CastSphere({{-3.5f, 10, 0}, 0.5f, {0, -1, 0}});
+
+    EXPECT_EQ(sphereCast.body, terrainBody);
+    EXPECT_NEAR(sphereCast.distance, 8.875f, 1e-5f);
+
+    std::vector<Physics::BodyHandle> found;
+    std::vector<std::size_t> offsets;
+
+    std::vector<Physics::SphereOverlap> spheres = {{{0, 1.9f, 0}, 0.5f}, {{0, 2.1f, 0}, 0.5f}};
+    queryWorld.Overlap(spheres, found, offsets);
+
+    EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 1, 1}));
+
+    // The surface under the boxes rises to 1.625
+    std::vector<Physics::BoxOverlap> boxes = {{{{-0.5f, 1.4f, -0.5f}, {0.5f, 2.4f, 0.5f}}}, {{{-0.5f, 1.7f, -0.5f}, {0.5f, 2.7f, 0.5f}}}};
+    queryWorld.Overlap(boxes, found, offsets);
+
+    EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 1, 1}));
+}